@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Converte o dump de 'capture dump' (ver src/capture.h) em CSV.
+
+Lê o texto do shell (um log salvo do terminal ou a porta serial), procura
+o bloco entre 'capture: begin' e 'capture: end', confere o CRC e grava
+uma linha por amostragem com o tempo relativo ao gatilho.
+
+Uso:
+    scripts/capture_rx.py terminal.log -o captura.csv
+    scripts/capture_rx.py --port /dev/ttyACM0 -o captura.csv
+"""
+
+import argparse
+import base64
+import re
+import struct
+import sys
+
+BEGIN = re.compile(r"capture: begin (.*)")
+END = re.compile(r"capture: end crc=([0-9a-fA-F]{4})")
+ANSI = re.compile(r"\x1b\[[0-9;]*[A-Za-z]")
+
+
+def crc16_ccitt_false(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def read_dump(lines):
+    """Devolve (metadados, bytes) do primeiro dump completo encontrado."""
+    meta = None
+    payload = []
+    for line in lines:
+        line = ANSI.sub("", line).strip()
+        if meta is None:
+            match = BEGIN.search(line)
+            if match:
+                meta = dict(field.split("=", 1) for field in match.group(1).split())
+            continue
+        match = END.search(line)
+        if match:
+            data = base64.b64decode("".join(payload))
+            if crc16_ccitt_false(data) != int(match.group(1), 16):
+                raise ValueError("CRC do dump não confere")
+            return meta, data
+        if line:
+            payload.append(line)
+    raise ValueError("dump incompleto ou não encontrado")
+
+
+def serial_lines(port):
+    import serial  # pyserial
+
+    with serial.Serial(port, 115200, timeout=5) as ser:
+        ser.write(b"capture dump\r\n")
+        while True:
+            line = ser.readline()
+            if not line:
+                return
+            yield line.decode("utf-8", "replace")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="arquivo com a saída do shell")
+    parser.add_argument("--port", help="envia 'capture dump' pela porta do shell e lê a resposta")
+    parser.add_argument("-o", "--output", help="arquivo CSV de saída (padrão: stdout)")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = serial_lines(args.port)
+    elif args.log:
+        lines = open(args.log, encoding="utf-8", errors="replace")
+    else:
+        parser.error("informe o arquivo de log ou --port")
+
+    try:
+        meta, data = read_dump(lines)
+    except ValueError as err:
+        sys.exit(str(err))
+
+    count = int(meta["amostras"])
+    pre = int(meta["pre"])
+    interval_us = int(meta["intervalo_us"])
+    samples = struct.unpack("<%dh" % (2 * count), data)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("indice,tempo_us,bruta,filtrada\n")
+    for i in range(count):
+        out.write("%d,%d,%d,%d\n" % (i - pre, (i - pre) * interval_us, samples[2 * i], samples[2 * i + 1]))
+
+    print("canal %s, %d amostras, gatilho %s" % (meta["canal"], count, meta["gatilho"]), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Decodificador/gravador do stream binário de telemetria (ver src/telemetry.h).
+
+Lê a segunda porta USB CDC ACM da placa (ou um arquivo gravado), valida o
+CRC de cada quadro, detecta quadros perdidos pelo número de sequência e
+grava as amostras em CSV.
+
+Uso:
+    scripts/telemetry_rx.py /dev/ttyACM1 -o captura.csv
+    scripts/telemetry_rx.py --raw-in gravacao.bin -o captura.csv
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+VERSION = 2  # 2: timestamp_us em 64 bits, sem voltas
+HEADER = struct.Struct("<BBIQIBB")  # versão, canal, seq, timestamp_us, descartados, n_raw, n_out
+
+
+def crc16_ccitt_false(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frames(stream, stats):
+    """Gera (canal, seq, timestamp_us, descartados, raw, out) a partir de um stream de bytes."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            del buf[:start]
+            if len(buf) < 2 + HEADER.size:
+                break
+            version, channel, seq, ts, dropped, n_raw, n_out = HEADER.unpack_from(buf, 2)
+            size = 2 + HEADER.size + 2 * (n_raw + n_out) + 2
+            if version != VERSION:
+                stats["bad"] += 1
+                del buf[:2]
+                continue
+            if len(buf) < size:
+                break
+            crc = struct.unpack_from("<H", buf, size - 2)[0]
+            if crc != crc16_ccitt_false(buf[2:size - 2]):
+                stats["bad"] += 1
+                del buf[:2]
+                continue
+            payload = struct.unpack_from("<%dh" % (n_raw + n_out), buf, 2 + HEADER.size)
+            del buf[:size]
+            yield channel, seq, ts, dropped, payload[:n_raw], payload[n_raw:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?", help="porta serial da telemetria (ex.: /dev/ttyACM1)")
+    parser.add_argument("--raw-in", help="lê de um arquivo binário em vez da porta")
+    parser.add_argument("--raw-out", help="grava também os bytes recebidos, sem decodificar")
+    parser.add_argument("-o", "--output", help="arquivo CSV de saída (padrão: stdout)")
+    args = parser.parse_args()
+
+    if args.raw_in:
+        stream = open(args.raw_in, "rb")
+    elif args.port:
+        import serial  # pyserial
+
+        stream = serial.Serial(args.port, timeout=1)
+        stream.dtr = True  # a placa só envia com DTR ativo
+    else:
+        parser.error("informe a porta ou --raw-in")
+
+    if args.raw_out:
+        raw_out = open(args.raw_out, "wb")
+        read = stream.read
+
+        class Tee:
+            def read(self, n):
+                data = read(n)
+                raw_out.write(data)
+                return data
+
+        stream = Tee()
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("seq,timestamp_us,canal,tipo,indice,valor\n")
+
+    stats = {"frames": 0, "bad": 0, "lost": 0, "dropped": 0}
+    last_seq = None
+    try:
+        for channel, seq, ts, dropped, raw, filtered in frames(stream, stats):
+            if last_seq is not None and seq != (last_seq + 1) & 0xFFFFFFFF:
+                stats["lost"] += (seq - last_seq - 1) & 0xFFFFFFFF
+            last_seq = seq
+            stats["frames"] += 1
+            stats["dropped"] = dropped
+            for i, v in enumerate(raw):
+                out.write("%d,%d,%d,raw,%d,%d\n" % (seq, ts, channel, i, v))
+            for i, v in enumerate(filtered):
+                out.write("%d,%d,%d,out,%d,%d\n" % (seq, ts, channel, i, v))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print("quadros: %(frames)d, com erro: %(bad)d, perdidos no USB: %(lost)d, "
+              "descartados na placa: %(dropped)d" % stats, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""Analisa o dump de 'trace dump' (ver src/trace.h).
+
+Lê o texto do shell (um log salvo do terminal ou a porta serial), confere o
+CRC e reconstrói a linha do tempo do escalonador. Imprime, por thread, o
+tempo de CPU, as ativações, as preempções e a latência pronta -> rodando;
+por interrupção, a contagem e a duração; e, para cada prazo perdido da
+filter_task, quem ocupou a CPU desde o fim do bloco anterior.
+
+Uso:
+    scripts/trace_rx.py terminal.log
+    scripts/trace_rx.py terminal.log --timeline linha.txt --chrome trace.json
+    scripts/trace_rx.py --port /dev/ttyACM0
+
+O arquivo de --chrome abre em https://ui.perfetto.dev ou chrome://tracing.
+"""
+
+import argparse
+import base64
+import json
+import re
+import struct
+import sys
+from collections import defaultdict
+
+BEGIN = re.compile(r"trace: begin (.*)")
+THREAD = re.compile(r"trace: thread ([0-9a-fA-F]{4}) (.*)")
+MARK = re.compile(r"trace: mark (\d+) (\S+)")
+END = re.compile(r"trace: end crc=([0-9a-fA-F]{4})")
+ANSI = re.compile(r"\x1b\[[0-9;]*[A-Za-z]")
+
+RECORD = struct.Struct("<IBBH")  # ciclos, evento, aux, id
+
+SWITCH_IN, SWITCH_OUT, READY, PEND, ISR_ENTER, ISR_EXIT, SEM_GIVE, MARK_EV = range(1, 9)
+EXCEPTIONS = {11: "SVCall", 14: "PendSV", 15: "SysTick"}
+
+
+def crc16_ccitt_false(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def read_dump(lines):
+    """Devolve (metadados, threads, marcas, bytes) do primeiro dump completo."""
+    meta = None
+    threads = {}
+    marks = {}
+    payload = []
+    for line in lines:
+        line = ANSI.sub("", line).strip()
+        if meta is None:
+            match = BEGIN.search(line)
+            if match:
+                meta = dict(field.split("=", 1) for field in match.group(1).split())
+            continue
+        match = THREAD.search(line)
+        if match:
+            threads[int(match.group(1), 16)] = match.group(2) or "tag_" + match.group(1)
+            continue
+        match = MARK.search(line)
+        if match:
+            marks[int(match.group(1))] = match.group(2)
+            continue
+        match = END.search(line)
+        if match:
+            data = base64.b64decode("".join(payload))
+            if crc16_ccitt_false(data) != int(match.group(1), 16):
+                raise ValueError("CRC do dump não confere")
+            return meta, threads, marks, data
+        if line:
+            payload.append(line)
+    raise ValueError("dump incompleto ou não encontrado")
+
+
+def serial_lines(port):
+    import serial  # pyserial
+
+    with serial.Serial(port, 115200, timeout=5) as ser:
+        ser.write(b"trace stop\r\ntrace dump\r\n")
+        while True:
+            line = ser.readline()
+            if not line:
+                return
+            yield line.decode("utf-8", "replace")
+
+
+def decode(data, cycles_hz):
+    """Registros como (tempo_us, evento, aux, id), com o contador de 32 bits desdobrado."""
+    records = []
+    elapsed = 0
+    last = None
+    for cycles, event, aux, ident in RECORD.iter_unpack(data):
+        if last is not None:
+            # Diferença com sinal: reservas concorrentes podem sair levemente fora de ordem.
+            delta = (cycles - last) & 0xFFFFFFFF
+            elapsed += delta - (1 << 32) if delta >= 0x80000000 else delta
+        last = cycles
+        records.append((elapsed * 1e6 / cycles_hz, event, aux, ident))
+    records.sort(key=lambda rec: rec[0])
+    return records
+
+
+def irq_name(exc):
+    if exc == 0:
+        return "isr"
+    if exc >= 16:
+        return "IRQ%d" % (exc - 16)
+    return EXCEPTIONS.get(exc, "exc%d" % exc)
+
+
+class Stats:
+    def __init__(self):
+        self.run_us = 0.0
+        self.activations = 0
+        self.preemptions = 0
+        self.latencies = []
+
+
+def analyze(records, threads, marks):
+    names = dict(threads)
+    name = lambda tag: names.get(tag, "tag_%04x" % tag)
+    stats = defaultdict(Stats)
+    isr_stats = defaultdict(list)
+    timeline = []
+    slices = []  # (thread, início, fim) para o Chrome trace
+    ready_at = {}
+    pended = set()
+    isr_stack = []
+    current = None
+    since = None
+    last_block_end = records[0][0] if records else 0.0
+    window = defaultdict(float)
+    last_window = None
+    misses = []
+
+    def account(now):
+        if current is not None and since is not None:
+            stats[current].run_us += now - since
+            window[current] += now - since
+            slices.append((current, since, now))
+
+    for t, event, aux, ident in records:
+        if event == SWITCH_IN:
+            account(t)
+            current, since = name(ident), t
+            stats[current].activations += 1
+            if ident in ready_at:
+                stats[current].latencies.append(t - ready_at.pop(ident))
+            pended.discard(ident)
+            text = "roda %s" % current
+        elif event == SWITCH_OUT:
+            account(t)
+            if ident not in pended:
+                stats[name(ident)].preemptions += 1
+                ready_at.setdefault(ident, t)  # preemptada continua pronta
+            current, since = None, None
+            text = "sai %s" % name(ident)
+        elif event == READY:
+            ready_at.setdefault(ident, t)
+            text = "pronta %s" % name(ident)
+        elif event == PEND:
+            pended.add(ident)
+            ready_at.pop(ident, None)
+            text = "bloqueia %s" % name(ident)
+        elif event == ISR_ENTER:
+            isr_stack.append((ident, t))
+            text = "entra %s" % irq_name(ident)
+        elif event == ISR_EXIT:
+            if isr_stack:
+                exc, start = isr_stack.pop()
+                isr_stats[irq_name(exc)].append(t - start)
+                window["[" + irq_name(exc) + "]"] += t - start
+            text = "sai %s" % irq_name(ident)
+        elif event == SEM_GIVE:
+            text = "sem_give %04x%s" % (ident, " (isr)" if aux else "")
+        elif event == MARK_EV:
+            mark = marks.get(ident, "mark%d" % ident)
+            text = "marca %s %d" % (mark, aux) if mark == "block_start" else "marca %s" % mark
+            if mark == "block_end":
+                # Fecha a janela do bloco; a marca de prazo perdido vem logo depois.
+                account(t)
+                since = t if current is not None else None
+                last_window = (last_block_end, t, dict(window))
+                last_block_end = t
+                window.clear()
+            elif mark == "deadline_miss" and last_window is not None:
+                misses.append(last_window)
+        else:
+            text = "evento %d" % event
+        timeline.append((t, text))
+
+    account(records[-1][0] if records else 0.0)
+    return stats, isr_stats, timeline, slices, misses
+
+
+def print_report(records, stats, isr_stats, misses, out):
+    span = records[-1][0] - records[0][0] if len(records) > 1 else 0.0
+    print("Janela: %.1f ms, %d registros" % (span / 1000.0, len(records)), file=out)
+    print("", file=out)
+    print("%-16s %10s %6s %8s %8s %10s %10s %10s" % (
+        "thread", "cpu_us", "cpu%", "ativ.", "preempt.", "lat_min", "lat_média", "lat_máx"), file=out)
+    for thread, st in sorted(stats.items(), key=lambda item: -item[1].run_us):
+        lat = st.latencies
+        print("%-16s %10.0f %6.1f %8d %8d %10s %10s %10s" % (
+            thread, st.run_us, 100.0 * st.run_us / span if span else 0.0, st.activations,
+            st.preemptions,
+            "%.1f" % min(lat) if lat else "-",
+            "%.1f" % (sum(lat) / len(lat)) if lat else "-",
+            "%.1f" % max(lat) if lat else "-"), file=out)
+    print("(latência em us, de pronta ou preemptada até voltar a rodar; tempo de CPU inclui ISRs)",
+          file=out)
+
+    if isr_stats:
+        print("", file=out)
+        print("%-10s %8s %10s %10s" % ("isr", "vezes", "total_us", "máx_us"), file=out)
+        for irq, durations in sorted(isr_stats.items(), key=lambda item: -sum(item[1])):
+            print("%-10s %8d %10.1f %10.1f" % (irq, len(durations), sum(durations), max(durations)),
+                  file=out)
+
+    for start, end, window in misses:
+        print("", file=out)
+        print("Prazo perdido no bloco terminado em %.1f us; CPU desde o fim do bloco anterior"
+              " (%.1f us):" % (end, end - start), file=out)
+        for who, us in sorted(window.items(), key=lambda item: -item[1]):
+            print("  %-18s %10.1f us" % (who, us), file=out)
+
+
+def write_chrome(path, slices, timeline):
+    events = []
+    for thread, start, end in slices:
+        events.append({"name": thread, "ph": "X", "ts": start, "dur": end - start,
+                       "pid": 0, "tid": thread})
+    for t, text in timeline:
+        if text.startswith(("marca", "sem_give", "entra")):
+            events.append({"name": text, "ph": "i", "ts": t, "pid": 0, "tid": "eventos", "s": "g"})
+    with open(path, "w") as out:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="arquivo com a saída do shell")
+    parser.add_argument("--port", help="envia 'trace stop' e 'trace dump' pela porta do shell")
+    parser.add_argument("--timeline", help="grava a linha do tempo em texto")
+    parser.add_argument("--chrome", help="grava o trace no formato JSON do Chrome/Perfetto")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = serial_lines(args.port)
+    elif args.log:
+        lines = open(args.log, encoding="utf-8", errors="replace")
+    else:
+        parser.error("informe o arquivo de log ou --port")
+
+    try:
+        meta, threads, marks, data = read_dump(lines)
+    except ValueError as err:
+        sys.exit(str(err))
+
+    records = decode(data, int(meta["ciclos_hz"]))
+    if not records:
+        sys.exit("dump sem registros")
+    if len(set(threads.values())) < len(threads):
+        print("aviso: tags de thread repetidas", file=sys.stderr)
+
+    stats, isr_stats, timeline, slices, misses = analyze(records, threads, marks)
+
+    if args.timeline:
+        with open(args.timeline, "w") as out:
+            for t, text in timeline:
+                out.write("%12.1f  %s\n" % (t, text))
+    if args.chrome:
+        write_chrome(args.chrome, slices, timeline)
+
+    print("modo %s, %s registros perdidos" % (meta["modo"], meta["perdidos"]), file=sys.stderr)
+    print_report(records, stats, isr_stats, misses, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
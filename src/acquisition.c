@@ -0,0 +1,550 @@
+#include "acquisition.h"
+#include "rtlog.h"
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#ifdef CONFIG_ADC_EMUL
+#include <zephyr/drivers/adc/adc_emul.h>
+#endif
+
+#if defined(CONFIG_ADC_EMUL) && defined(CONFIG_APP_SIGGEN)
+#include "siggen.h"
+#endif
+
+LOG_MODULE_REGISTER(acquisition, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+/* Backend por hardware: TIM8 TRGO dispara o ADC e o DMA circular grava as
+ * amostragens (dmas/dma-names = "adc" em zephyr,user, STM32F4). */
+#if defined(CONFIG_APP_ACQ_HW_TRIGGER) && DT_DMAS_HAS_NAME(ZEPHYR_USER_NODE, adc)
+#define HAS_ACQ_DMA 1
+#else
+#define HAS_ACQ_DMA 0
+#endif
+
+#if HAS_ACQ_DMA
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/dma/dma_stm32.h>
+#include <stm32_ll_adc.h>
+#include <stm32_ll_bus.h>
+#include <stm32_ll_tim.h>
+#endif
+
+#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
+    ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+
+static const struct adc_dt_spec adc_channels[] = {
+    DT_FOREACH_PROP_ELEM(ZEPHYR_USER_NODE, io_channels,
+                         DT_SPEC_AND_COMMA)};
+
+BUILD_ASSERT(ARRAY_SIZE(adc_channels) == ACQ_NUM_CHANNELS);
+
+uint8_t acq_channel_pos[ACQ_NUM_CHANNELS];
+
+static struct acq_block blocks[ACQ_NUM_BLOCKS];
+
+/* Filas de ponteiros para blocos livres e blocos prontos para processamento.
+ * A fila de prontos é alimentada pelo callback do ADC ou do DMA (contexto
+ * de ISR). */
+K_MSGQ_DEFINE(free_blocks, sizeof(struct acq_block *), ACQ_NUM_BLOCKS, 4);
+K_MSGQ_DEFINE(ready_blocks, sizeof(struct acq_block *), ACQ_NUM_BLOCKS, 4);
+
+static struct adc_sequence sequence;
+static atomic_t overruns;
+static atomic_t lent_blocks;
+static uint32_t next_seq;
+static volatile uint32_t interval_us;
+
+#if HAS_ACQ_DMA
+
+#define ACQ_ADC ((ADC_TypeDef *)DT_REG_ADDR(DT_IO_CHANNELS_CTLR_BY_IDX(ZEPHYR_USER_NODE, 0)))
+#define ACQ_TIMER TIM8
+#define ACQ_HW_FINE_MAX_US 65536U // maior período em ticks de 1 us (ARR de 16 bits)
+#define ACQ_DMA_STREAM DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, adc, channel)
+#define ACQ_DMA_SLOT DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, adc, slot)
+#define ACQ_DMA_CONFIG DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, adc, channel_config)
+
+static const struct device *const dma_dev =
+    DEVICE_DT_GET(DT_DMAS_CTLR_BY_NAME(ZEPHYR_USER_NODE, adc));
+
+/* Posições do sequenciador regular e comprimento da varredura por número de canais. */
+static const uint32_t seq_ranks[] = {
+    LL_ADC_REG_RANK_1, LL_ADC_REG_RANK_2, LL_ADC_REG_RANK_3, LL_ADC_REG_RANK_4,
+    LL_ADC_REG_RANK_5, LL_ADC_REG_RANK_6, LL_ADC_REG_RANK_7, LL_ADC_REG_RANK_8,
+};
+static const uint32_t seq_lengths[] = {
+    LL_ADC_REG_SEQ_SCAN_DISABLE,        LL_ADC_REG_SEQ_SCAN_ENABLE_2RANKS,
+    LL_ADC_REG_SEQ_SCAN_ENABLE_3RANKS,  LL_ADC_REG_SEQ_SCAN_ENABLE_4RANKS,
+    LL_ADC_REG_SEQ_SCAN_ENABLE_5RANKS,  LL_ADC_REG_SEQ_SCAN_ENABLE_6RANKS,
+    LL_ADC_REG_SEQ_SCAN_ENABLE_7RANKS,  LL_ADC_REG_SEQ_SCAN_ENABLE_8RANKS,
+};
+
+BUILD_ASSERT(ACQ_NUM_CHANNELS <= ARRAY_SIZE(seq_ranks), "too many io-channels for the scan");
+
+/* Duas metades de um bloco: o DMA grava uma enquanto o callback copia a outra. */
+static uint16_t dma_buf[2][ACQ_BLOCK_LEN * ACQ_NUM_CHANNELS] __aligned(4);
+static uint32_t timer_hz;          // clock do TIM8
+static uint32_t timer_interval_us; // período programado no TIM8 (usado nas interrupções)
+
+/* Programa o período do TIM8: ticks de 1 us até ACQ_HW_FINE_MAX_US e de
+ * 100 us acima (contador de 16 bits). PSC e ARR têm pré-carga: o período
+ * novo começa no próximo evento de atualização, que é a primeira
+ * amostragem do bloco seguinte. */
+static void timer_set_interval(uint32_t period_us)
+{
+    const uint32_t tick_us = period_us <= ACQ_HW_FINE_MAX_US ? 1U : 100U;
+
+    LL_TIM_SetPrescaler(ACQ_TIMER, timer_hz / (1000000U / tick_us) - 1U);
+    LL_TIM_SetAutoReload(ACQ_TIMER, period_us / tick_us - 1U);
+    timer_interval_us = period_us;
+}
+
+/* Meia transferência (DMA_STATUS_BLOCK) ou transferência completa: a metade
+ * correspondente tem um bloco completo, copiado para um bloco livre
+ * enquanto o DMA grava a outra. A conversão nunca para; sem bloco livre o
+ * bloco é perdido e contado. Contexto de ISR. */
+static void dma_block_done(const struct device *dev, void *user_data, uint32_t channel,
+                           int status)
+{
+    struct acq_block *block;
+    const uint32_t seq = next_seq++; // par na primeira metade, ímpar na segunda
+
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+    ARG_UNUSED(channel);
+
+    if (status < 0)
+    {
+        RTLOG_ERR("ADC DMA error (%d)", status);
+        return;
+    }
+
+    if (k_msgq_get(&free_blocks, &block, K_NO_WAIT) != 0)
+    {
+        atomic_inc(&overruns);
+    }
+    else
+    {
+        memcpy(block->samples, dma_buf[status == DMA_STATUS_BLOCK ? 0 : 1],
+               sizeof(block->samples));
+        block->seq = seq;
+        block->timestamp = k_cycle_get_32();
+        block->interval_us = timer_interval_us;
+        (void)k_msgq_put(&ready_blocks, &block, K_NO_WAIT);
+    }
+
+    if (interval_us != timer_interval_us)
+    {
+        timer_set_interval(interval_us);
+    }
+}
+
+/* Sequência regular com os canais em ordem crescente de id (a mesma
+ * ordem de acq_channel_pos), disparada pela borda de subida do TRGO do
+ * TIM8, com um pedido de DMA por conversão. */
+static int hw_init(void)
+{
+    ADC_TypeDef *const adc = ACQ_ADC;
+    size_t rank = 0U;
+
+    if (!device_is_ready(dma_dev))
+    {
+        RTLOG_ERR("ADC DMA not ready");
+        return -ENODEV;
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++)
+    {
+        if (adc_channels[i].resolution != 12U)
+        {
+            RTLOG_ERR("Channel #%d: the hardware trigger needs 12 bits", (int)i);
+            return -ENOTSUP;
+        }
+    }
+
+    LL_ADC_Disable(adc);
+    LL_ADC_SetResolution(adc, LL_ADC_RESOLUTION_12B);
+    LL_ADC_SetDataAlignment(adc, LL_ADC_DATA_ALIGN_RIGHT);
+    LL_ADC_SetSequencersScanMode(adc, ACQ_NUM_CHANNELS > 1 ? LL_ADC_SEQ_SCAN_ENABLE
+                                                           : LL_ADC_SEQ_SCAN_DISABLE);
+    LL_ADC_REG_SetSequencerLength(adc, seq_lengths[ACQ_NUM_CHANNELS - 1]);
+
+    for (uint32_t id = 0U; id < 32U; id++)
+    {
+        if (sequence.channels & BIT(id))
+        {
+            LL_ADC_REG_SetSequencerRanks(adc, seq_ranks[rank++],
+                                         __LL_ADC_DECIMAL_NB_TO_CHANNEL(id));
+        }
+    }
+
+    LL_ADC_REG_SetContinuousMode(adc, LL_ADC_REG_CONV_SINGLE);
+    LL_ADC_REG_SetFlagEndOfConversion(adc, LL_ADC_REG_FLAG_EOC_SEQUENCE_CONV);
+    LL_ADC_REG_SetDMATransfer(adc, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+    LL_ADC_REG_SetTriggerSource(adc, LL_ADC_REG_TRIG_EXT_TIM8_TRGO);
+    LL_ADC_Enable(adc);
+    k_busy_wait(10); // tSTAB do ADC
+
+    return 0;
+}
+
+static int hw_start(uint32_t period_us)
+{
+    const struct device *const clk = DEVICE_DT_GET(STM32_CLOCK_CONTROL_NODE);
+    struct stm32_pclken pclken = {
+        .bus = STM32_CLOCK_BUS_APB2,
+        .enr = LL_APB2_GRP1_PERIPH_TIM8,
+    };
+    uint32_t bus_hz = 0U;
+    int err;
+
+    (void)clock_control_on(clk, (clock_control_subsys_t)&pclken);
+    (void)clock_control_get_rate(clk, (clock_control_subsys_t)&pclken, &bus_hz);
+
+    /* Com prescaler de APB2 diferente de 1 o clock dos timers é o dobro. */
+    timer_hz = STM32_APB2_PRESCALER > 1 ? 2U * bus_hz : bus_hz;
+
+    /* O evento de atualização que carrega PSC e ARR não pode sair no
+     * TRGO: o ADC e o DAC (pipeline.h) contariam uma amostragem a mais. */
+    LL_TIM_DisableCounter(ACQ_TIMER);
+    LL_TIM_SetTriggerOutput(ACQ_TIMER, LL_TIM_TRGO_ENABLE);
+    LL_TIM_EnableARRPreload(ACQ_TIMER);
+    timer_set_interval(period_us);
+    LL_TIM_GenerateEvent_UPDATE(ACQ_TIMER);
+    LL_TIM_SetTriggerOutput(ACQ_TIMER, LL_TIM_TRGO_UPDATE);
+
+    struct dma_block_config block = {
+        .source_address = LL_ADC_DMA_GetRegAddr(ACQ_ADC, LL_ADC_DMA_REG_REGULAR_DATA),
+        .dest_address = (uint32_t)dma_buf,
+        .block_size = sizeof(dma_buf),
+        .source_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+        .dest_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+        .source_reload_en = 1,
+        .dest_reload_en = 1,
+    };
+    struct dma_config dma_cfg = {
+        .dma_slot = ACQ_DMA_SLOT,
+        .channel_direction = PERIPHERAL_TO_MEMORY,
+        .channel_priority = STM32_DMA_CONFIG_PRIORITY(ACQ_DMA_CONFIG),
+        .source_data_size = sizeof(dma_buf[0][0]),
+        .dest_data_size = sizeof(dma_buf[0][0]),
+        .source_burst_length = 1,
+        .dest_burst_length = 1,
+        .cyclic = 1,
+        .block_count = 1,
+        .head_block = &block,
+        .dma_callback = dma_block_done,
+    };
+
+    err = dma_config(dma_dev, ACQ_DMA_STREAM, &dma_cfg);
+    if (err == 0)
+    {
+        err = dma_start(dma_dev, ACQ_DMA_STREAM);
+    }
+    if (err < 0)
+    {
+        RTLOG_ERR("Could not start ADC DMA (%d)", err);
+        return err;
+    }
+
+    LL_ADC_REG_StartConversionExtTrig(ACQ_ADC, LL_ADC_REG_TRIG_EXT_RISING);
+    LL_TIM_EnableCounter(ACQ_TIMER);
+
+    return 0;
+}
+
+/* O DMA circular não para entre blocos: não há conversão a reiniciar. */
+static inline void start_next_block(void)
+{
+}
+
+#else /* !HAS_ACQ_DMA */
+
+static struct adc_sequence_options sequence_options;
+static struct k_poll_signal sequence_signal;
+static atomic_t converting;
+static bool running;
+
+/* Chamado pelo driver ao final de cada amostragem, em contexto de interrupção. */
+static enum adc_action sampling_done(const struct device *dev,
+                                     const struct adc_sequence *seq,
+                                     uint16_t sampling_index)
+{
+    ARG_UNUSED(dev);
+
+    if (sampling_index == ACQ_BLOCK_LEN - 1)
+    {
+        struct acq_block *block = seq->options->user_data;
+
+        block->timestamp = k_cycle_get_32();
+        (void)k_msgq_put(&ready_blocks, &block, K_NO_WAIT);
+        atomic_clear(&converting);
+    }
+
+    return ADC_ACTION_CONTINUE;
+}
+
+/* Inicia a conversão do próximo bloco se o ADC estiver parado e houver
+ * buffer livre. Chamada pelas threads que recebem e devolvem blocos: o
+ * driver só aceita uma nova leitura depois de terminar a anterior, então
+ * o ADC fica parado do fim de um bloco até a próxima chamada. */
+static void start_next_block(void)
+{
+    struct acq_block *block;
+    int err;
+
+    if (!running || !atomic_cas(&converting, 0, 1))
+    {
+        return;
+    }
+
+    if (k_msgq_get(&free_blocks, &block, K_NO_WAIT) != 0)
+    {
+        /* Todos os buffers ainda estão com o consumidor. A aquisição
+         * recomeça quando algum deles for devolvido. */
+        atomic_inc(&overruns);
+        atomic_clear(&converting);
+        return;
+    }
+
+    block->seq = next_seq++;
+    sequence.buffer = block->samples;
+    sequence_options.user_data = block;
+    sequence_options.interval_us = interval_us;
+    block->interval_us = interval_us;
+
+    err = adc_read_async(adc_channels[0].dev, &sequence, &sequence_signal);
+    if (err < 0)
+    {
+        RTLOG_ERR("Could not start block (%d)", err);
+        (void)k_msgq_put(&free_blocks, &block, K_NO_WAIT);
+        atomic_clear(&converting);
+    }
+}
+
+#endif /* HAS_ACQ_DMA */
+
+#ifdef CONFIG_ADC_EMUL
+/* Sinal de teste para o emulador do ADC (native_sim): onda triangular em mV.
+ * Com o gerador de sinais ligado, o canal 0 lê a saída do gerador. */
+static int emul_triangle(const struct device *dev, unsigned int chan,
+                         void *data, uint32_t *result)
+{
+    static uint32_t phase[ACQ_NUM_CHANNELS];
+    size_t i = (size_t)(uintptr_t)data;
+
+    ARG_UNUSED(dev);
+    ARG_UNUSED(chan);
+
+#ifdef CONFIG_APP_SIGGEN
+    if (i == 0U && siggen_current().wave != SIGGEN_OFF)
+    {
+        uint32_t code = siggen_emul_code(k_cycle_get_32());
+
+        *result = code * 3300U / (SIGGEN_MAX_CODE + 1U); // mesma escala da triangular
+        return 0;
+    }
+#endif
+
+    phase[i] = (phase[i] + 16U * (i + 1U)) % 6600U;
+    *result = phase[i] < 3300U ? phase[i] : 6600U - phase[i];
+
+    return 0;
+}
+#endif /* CONFIG_ADC_EMUL */
+
+int acq_init(void)
+{
+    int err;
+
+    (void)adc_sequence_init_dt(&adc_channels[0], &sequence);
+    sequence.channels = 0;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++)
+    {
+        if (!adc_is_ready_dt(&adc_channels[i]))
+        {
+            RTLOG_ERR("ADC controller of channel #%d not ready", (int)i);
+            return -ENODEV;
+        }
+
+        if (adc_channels[i].dev != adc_channels[0].dev)
+        {
+            RTLOG_ERR("All io-channels must belong to the same ADC");
+            return -ENOTSUP;
+        }
+
+        err = adc_channel_setup_dt(&adc_channels[i]);
+        if (err < 0)
+        {
+            RTLOG_ERR("Could not setup channel #%d (%d)", (int)i, err);
+            return err;
+        }
+
+        sequence.channels |= BIT(adc_channels[i].channel_id);
+
+#ifdef CONFIG_ADC_EMUL
+        (void)adc_emul_value_func_set(adc_channels[i].dev, adc_channels[i].channel_id,
+                                      emul_triangle, (void *)(uintptr_t)i);
+#endif
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++)
+    {
+        uint32_t lower = sequence.channels & (BIT(adc_channels[i].channel_id) - 1U);
+
+        acq_channel_pos[i] = (uint8_t)POPCOUNT(lower);
+    }
+
+#if HAS_ACQ_DMA
+    err = hw_init();
+    if (err < 0)
+    {
+        return err;
+    }
+#else
+    sequence.buffer_size = sizeof(blocks[0].samples);
+    sequence_options.callback = sampling_done;
+    sequence_options.extra_samplings = ACQ_BLOCK_LEN - 1;
+    sequence.options = &sequence_options;
+    k_poll_signal_init(&sequence_signal);
+#endif
+
+    for (size_t i = 0U; i < ARRAY_SIZE(blocks); i++)
+    {
+        struct acq_block *block = &blocks[i];
+
+        (void)k_msgq_put(&free_blocks, &block, K_NO_WAIT);
+    }
+
+    return 0;
+}
+
+int acq_start(uint32_t period_us)
+{
+    interval_us = acq_interval_snap(period_us);
+#if HAS_ACQ_DMA
+    return hw_start(interval_us);
+#else
+    running = true;
+    start_next_block();
+
+    return atomic_get(&converting) ? 0 : -EIO;
+#endif
+}
+
+void acq_set_interval(uint32_t period_us)
+{
+    interval_us = acq_interval_snap(period_us);
+}
+
+uint32_t acq_interval_snap(uint32_t period_us)
+{
+#if HAS_ACQ_DMA
+    if (period_us > ACQ_HW_FINE_MAX_US)
+    {
+        return (period_us + 50U) / 100U * 100U;
+    }
+    return MAX(period_us, 1U);
+#else
+    return k_ticks_to_us_ceil32(MAX(k_us_to_ticks_ceil32(period_us), 1U));
+#endif
+}
+
+uint32_t acq_min_interval_us(void)
+{
+#if HAS_ACQ_DMA
+    return 1U;
+#else
+    return k_ticks_to_us_ceil32(1U);
+#endif
+}
+
+uint32_t acq_get_interval(void)
+{
+    return interval_us;
+}
+
+int acq_get_block(struct acq_block **block, k_timeout_t timeout)
+{
+    int err = k_msgq_get(&ready_blocks, block, timeout);
+
+    if (err == 0)
+    {
+        atomic_set(&(*block)->refs, 1);
+    }
+
+    /* Com o temporizador do driver, reinicia o ADC no buffer livre antes
+     * de processar o bloco recebido. */
+    start_next_block();
+
+    return err;
+}
+
+bool acq_block_lend(struct acq_block *block)
+{
+    if (atomic_inc(&lent_blocks) >= ACQ_MAX_LENT)
+    {
+        atomic_dec(&lent_blocks);
+        return false;
+    }
+
+    /* A referência de quem chama impede que o bloco volte ao pool antes
+     * de 'lent' ser marcado. */
+    block->lent = true;
+    acq_block_ref(block);
+
+    return true;
+}
+
+void acq_release_block(struct acq_block *block)
+{
+    if (atomic_dec(&block->refs) != 1)
+    {
+        return;
+    }
+
+    if (block->lent)
+    {
+        block->lent = false;
+        atomic_dec(&lent_blocks);
+    }
+
+    (void)k_msgq_put(&free_blocks, &block, K_NO_WAIT);
+    start_next_block();
+}
+
+uint32_t acq_flush_ready(void)
+{
+    struct acq_block *block;
+    uint32_t count = 0U;
+
+    while (k_msgq_get(&ready_blocks, &block, K_NO_WAIT) == 0)
+    {
+        (void)k_msgq_put(&free_blocks, &block, K_NO_WAIT);
+        count++;
+    }
+
+    if (count > 0U)
+    {
+        start_next_block();
+    }
+
+    return count;
+}
+
+uint32_t acq_overruns(void)
+{
+    return (uint32_t)atomic_get(&overruns);
+}
+
+const struct adc_dt_spec *acq_channel(size_t channel)
+{
+    return &adc_channels[channel];
+}
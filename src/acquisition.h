@@ -0,0 +1,118 @@
+/*
+ * Aquisição do ADC em blocos.
+ *
+ * Cada bloco tem ACQ_BLOCK_LEN amostragens com todos os canais de
+ * io-channels intercalados. A tarefa consumidora acorda uma vez por bloco
+ * em vez de uma vez por amostra.
+ *
+ * Com CONFIG_APP_ACQ_HW_TRIGGER (STM32F4, dmas "adc" em zephyr,user) o
+ * TRGO do TIM8 dispara cada amostragem e o DMA circular grava dois blocos
+ * alternados; a cada metade completa o callback do DMA copia o bloco para
+ * um buffer livre. A aquisição é contínua: não há pausa entre blocos, o
+ * período é exato em us até 65536 us (em múltiplos de 100 us acima) e um
+ * bloco sem buffer livre é perdido e contado em acq_overruns(), sem parar
+ * o ADC. O mesmo TRGO dispara o DAC (pipeline.h).
+ *
+ * Sem essa opção (native_sim e o emulador do ADC) o ADC é cadenciado pelo
+ * k_timer do driver (adc_sequence_options.interval_us): o período é
+ * arredondado para cima ao tick do kernel, e cada bloco é uma leitura
+ * assíncrona iniciada pela thread que recebe ou devolve blocos, então há
+ * uma pausa entre o fim de um bloco e o início do seguinte.
+ *
+ * Um bloco entregue pode ser emprestado por referência a estágios de
+ * análise de menor prioridade (acq_block_lend(), acq_block_ref()); ele só
+ * volta a receber conversões quando todas as referências forem devolvidas.
+ * Até ACQ_MAX_LENT blocos podem estar emprestados sem tirar do ADC o buffer
+ * duplo. O bloco também leva as amostras de saída de cada pipeline, para
+ * que os consumidores não precisem de cópias (ver block_bus.h).
+ */
+
+#ifndef ACQUISITION_H_
+#define ACQUISITION_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/sys/atomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ACQ_NUM_CHANNELS DT_PROP_LEN(DT_PATH(zephyr_user), io_channels)
+#define ACQ_BLOCK_LEN 32 // amostragens (de todos os canais) por bloco
+#define ACQ_MAX_LENT 4 // blocos emprestados a estágios de análise ao mesmo tempo
+#define ACQ_NUM_BLOCKS (2 + ACQ_MAX_LENT) // buffer duplo + emprestados
+
+struct acq_block
+{
+    uint32_t seq;       // número de sequência (com o TIM8, avança também nos blocos perdidos)
+    uint32_t timestamp; // k_cycle_get_32() na última amostragem do bloco
+    uint32_t interval_us; // período de amostragem usado no bloco
+    atomic_t refs;        // referências ainda não devolvidas com acq_release_block()
+    bool lent;            // conta em ACQ_MAX_LENT até a última referência voltar
+    uint16_t samples[ACQ_BLOCK_LEN * ACQ_NUM_CHANNELS];
+    uint8_t n_out[ACQ_NUM_CHANNELS]; // amostras de saída de cada pipeline no bloco
+    int32_t out[ACQ_NUM_CHANNELS][ACQ_BLOCK_LEN]; // saída filtrada e decimada
+};
+
+/* Configura os canais do ADC. Deve ser chamada antes de acq_start(). */
+int acq_init(void);
+
+/* Inicia a aquisição contínua com o período de amostragem em microssegundos. */
+int acq_start(uint32_t interval_us);
+
+/* Altera o período de amostragem. Aplicado na próxima fronteira de bloco,
+ * já ajustado por acq_interval_snap(). */
+void acq_set_interval(uint32_t interval_us);
+
+/* Período que a aquisição realmente produz para 'interval_us': o próprio
+ * valor com o TIM8 (o múltiplo de 100 us mais próximo acima de 65536 us);
+ * com o temporizador do driver, o múltiplo do tick do kernel logo acima,
+ * porque K_USEC arredonda para cima. */
+uint32_t acq_interval_snap(uint32_t interval_us);
+
+/* Resolução da cadência da aquisição em us, que é também o menor período:
+ * 1 us com o TIM8, um tick do kernel com o temporizador do driver. */
+uint32_t acq_min_interval_us(void);
+
+uint32_t acq_get_interval(void);
+
+/* Espera o próximo bloco completo. O bloco deve ser devolvido com acq_release_block(). */
+int acq_get_block(struct acq_block **block, k_timeout_t timeout);
+
+/* Devolve uma referência ao bloco. Pode ser chamada de qualquer thread; o
+ * bloco volta para a aquisição quando a última referência é devolvida. */
+void acq_release_block(struct acq_block *block);
+
+/* Empresta o bloco a um estágio de análise: acrescenta uma referência se
+ * houver menos de ACQ_MAX_LENT blocos emprestados. Chamada pela tarefa que
+ * recebeu o bloco de acq_get_block(), antes de devolver a própria
+ * referência. Retorna false se o limite foi atingido. */
+bool acq_block_lend(struct acq_block *block);
+
+/* Acrescenta uma referência a um bloco recebido de acq_get_block() ou
+ * emprestado com acq_block_lend(). */
+static inline void acq_block_ref(struct acq_block *block)
+{
+    (void)atomic_inc(&block->refs);
+}
+
+/* Devolve à aquisição os blocos completos ainda não processados. Retorna
+ * quantos foram descartados. */
+uint32_t acq_flush_ready(void);
+
+/* Número de blocos perdidos por falta de buffer livre. */
+uint32_t acq_overruns(void);
+
+const struct adc_dt_spec *acq_channel(size_t channel);
+
+/* Posição de cada canal de io-channels dentro de uma amostragem. O ADC
+ * grava os canais da sequência em ordem crescente de id. */
+extern uint8_t acq_channel_pos[ACQ_NUM_CHANNELS];
+
+/* Amostra bruta do canal 'channel' (índice em io-channels) na amostragem 'n' do bloco. */
+static inline uint16_t acq_sample(const struct acq_block *block, size_t n, size_t channel)
+{
+    return block->samples[n * ACQ_NUM_CHANNELS + acq_channel_pos[channel]];
+}
+
+#endif /* ACQUISITION_H_ */
@@ -0,0 +1,314 @@
+/*
+ * Fonte e destino de replay para native_sim (CONFIG_APP_REPLAY).
+ *
+ * Implementa a mesma interface de acquisition.h lendo as amostras de um
+ * arquivo, sem esperar o período de amostragem, e grava as escritas no DAC
+ * em outro arquivo. O pipeline (pipeline.c, filter.c) é o mesmo do hardware.
+ * Com uma saída de referência (CONFIG_APP_REPLAY_EXPECTED), a saída é
+ * comparada com ela no fim do arquivo.
+ */
+
+#include "acquisition.h"
+#include "replay.h"
+
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <posix_board_if.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
+    ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+
+/* Usados apenas para a conversão em mV feita pelo shell. */
+static const struct adc_dt_spec adc_channels[] = {
+    DT_FOREACH_PROP_ELEM(DT_PATH(zephyr_user), io_channels,
+                         DT_SPEC_AND_COMMA)};
+
+uint8_t acq_channel_pos[ACQ_NUM_CHANNELS];
+
+static struct acq_block blocks[ACQ_NUM_BLOCKS];
+static FILE *input;
+static FILE *output;
+static const char *output_path;
+static uint32_t next_seq;
+static uint32_t interval_us;
+static uint64_t samples_read;
+static atomic_t lent_blocks;
+static struct timespec start_time;
+
+static const char *path_or_default(const char *env, const char *fallback)
+{
+    const char *path = getenv(env);
+
+    return path != NULL ? path : fallback;
+}
+
+int acq_init(void)
+{
+    const char *in_path = path_or_default("REPLAY_IN", CONFIG_APP_REPLAY_INPUT);
+    const char *out_path = path_or_default("REPLAY_OUT", CONFIG_APP_REPLAY_OUTPUT);
+
+    output_path = out_path;
+
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        acq_channel_pos[i] = (uint8_t)i; // colunas do arquivo na ordem de io-channels
+    }
+
+    input = fopen(in_path, "r");
+    if (input == NULL)
+    {
+        printk("Could not open replay input %s\n", in_path);
+        return -ENOENT;
+    }
+
+    output = fopen(out_path, "w");
+    if (output == NULL)
+    {
+        printk("Could not open replay output %s\n", out_path);
+        fclose(input);
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int acq_start(uint32_t period_us)
+{
+    interval_us = period_us;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    return 0;
+}
+
+void acq_set_interval(uint32_t period_us)
+{
+    interval_us = period_us;
+}
+
+uint32_t acq_get_interval(void)
+{
+    return interval_us;
+}
+
+/* O replay não espera o período: qualquer valor é exato. */
+uint32_t acq_interval_snap(uint32_t period_us)
+{
+    return MAX(period_us, 1U);
+}
+
+uint32_t acq_min_interval_us(void)
+{
+    return 1U;
+}
+
+/* Lê uma amostragem (um valor por canal). Retorna false no fim do arquivo. */
+static bool read_sampling(uint16_t *values)
+{
+    char line[128];
+
+    while (fgets(line, sizeof(line), input) != NULL)
+    {
+        char *p = line;
+
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+        {
+            continue;
+        }
+
+        for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+        {
+            char *end;
+            long value = strtol(p, &end, 0);
+
+            values[i] = end != p ? (uint16_t)CLAMP(value, 0, UINT16_MAX) : 0U;
+            p = end;
+            while (*p == ',' || *p == ' ' || *p == '\t')
+            {
+                p++;
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/* Compara a saída gravada com a de referência. Retorna 0 se forem iguais. */
+static int check_expected(const char *expected_path)
+{
+    FILE *got = fopen(output_path, "r");
+    FILE *expected = fopen(expected_path, "r");
+    char got_line[64];
+    char expected_line[64];
+    int ret = 0;
+
+    if (got == NULL || expected == NULL)
+    {
+        printk("Replay: não foi possível abrir %s\n", got == NULL ? output_path : expected_path);
+        ret = -ENOENT;
+        goto out;
+    }
+
+    for (uint32_t line = 1U;; line++)
+    {
+        const char *g = fgets(got_line, sizeof(got_line), got);
+        const char *e = fgets(expected_line, sizeof(expected_line), expected);
+
+        if (g == NULL && e == NULL)
+        {
+            break;
+        }
+
+        if (g == NULL || e == NULL || strcmp(got_line, expected_line) != 0)
+        {
+            printk("Replay: saída difere de %s na linha %u\n", expected_path, line);
+            ret = -EIO;
+            break;
+        }
+    }
+
+out:
+    if (got != NULL)
+    {
+        fclose(got);
+    }
+    if (expected != NULL)
+    {
+        fclose(expected);
+    }
+
+    return ret;
+}
+
+/* Fim do arquivo: imprime a vazão medida no host e encerra o executável. */
+static void replay_finish(void)
+{
+    const char *expected_path = path_or_default("REPLAY_EXPECTED", CONFIG_APP_REPLAY_EXPECTED);
+    int ret = 0;
+
+    struct timespec end_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    fclose(input);
+    fclose(output);
+
+    double elapsed = (double)(end_time.tv_sec - start_time.tv_sec) +
+                     (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+    printk("Replay: %llu amostras em %u blocos, %.3f s, %.0f amostras/s\n",
+           (unsigned long long)samples_read, next_seq, elapsed,
+           elapsed > 0.0 ? (double)samples_read / elapsed : 0.0);
+
+    if (expected_path[0] != '\0')
+    {
+        ret = check_expected(expected_path);
+        if (ret == 0)
+        {
+            printk("Replay: saída confere com %s\n", expected_path);
+        }
+    }
+
+    posix_exit(ret == 0 ? 0 : 1);
+}
+
+/* O pipeline devolve o bloco antes de pedir o próximo, então no máximo
+ * ACQ_MAX_LENT blocos estão emprestados e sempre há um livre. Um bloco
+ * cuja última referência acabou de voltar só fica livre depois de sair da
+ * conta de emprestados. */
+static struct acq_block *free_block(void)
+{
+    for (size_t i = 0U; i < ARRAY_SIZE(blocks); i++)
+    {
+        if (atomic_get(&blocks[i].refs) == 0 && !blocks[i].lent)
+        {
+            return &blocks[i];
+        }
+    }
+
+    return NULL;
+}
+
+int acq_get_block(struct acq_block **out, k_timeout_t timeout)
+{
+    struct acq_block *block = free_block();
+
+    ARG_UNUSED(timeout);
+
+    if (block == NULL)
+    {
+        return -EAGAIN;
+    }
+
+    /* Um bloco incompleto no fim do arquivo é descartado para manter o
+     * tamanho de bloco do hardware. */
+    for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+    {
+        if (!read_sampling(&block->samples[n * ACQ_NUM_CHANNELS]))
+        {
+            replay_finish();
+            return -ENODATA;
+        }
+    }
+
+    samples_read += ACQ_BLOCK_LEN * ACQ_NUM_CHANNELS;
+    block->seq = next_seq++;
+    block->interval_us = interval_us;
+    block->timestamp = k_cycle_get_32();
+    atomic_set(&block->refs, 1);
+    *out = block;
+
+    return 0;
+}
+
+bool acq_block_lend(struct acq_block *block)
+{
+    if (atomic_inc(&lent_blocks) >= ACQ_MAX_LENT)
+    {
+        atomic_dec(&lent_blocks);
+        return false;
+    }
+
+    block->lent = true;
+    acq_block_ref(block);
+
+    return true;
+}
+
+void acq_release_block(struct acq_block *block)
+{
+    if (atomic_dec(&block->refs) != 1)
+    {
+        return;
+    }
+
+    if (block->lent)
+    {
+        block->lent = false;
+        atomic_dec(&lent_blocks);
+    }
+}
+
+uint32_t acq_flush_ready(void)
+{
+    return 0U;
+}
+
+uint32_t acq_overruns(void)
+{
+    return 0U;
+}
+
+const struct adc_dt_spec *acq_channel(size_t channel)
+{
+    return &adc_channels[channel];
+}
+
+void replay_dac_write(uint8_t dac_channel, uint32_t value)
+{
+    fprintf(output, "%u %u\n", dac_channel, value);
+}
@@ -0,0 +1,169 @@
+#include "block_bus.h"
+#include "edf.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#define BUS_STACK_SIZE 768
+#ifdef CONFIG_APP_EDF
+#define BUS_PRIORITY (EDF_PRIORITY + 1) // logo abaixo das tarefas de tempo real
+#else
+#define BUS_PRIORITY (CONFIG_APP_FILTER_PRIORITY + 1)
+#endif
+
+/* Blocos publicados ainda não despachados. Cada bloco emprestado entra uma
+ * única vez, então a fila nunca enche. */
+K_MSGQ_DEFINE(bus_blocks, sizeof(struct acq_block *), ACQ_MAX_LENT, 4);
+
+static struct block_subscriber *subscribers[BLOCK_BUS_MAX_SUBSCRIBERS];
+static atomic_t num_subscribers;
+static atomic_t published;
+static atomic_t dropped;
+
+static struct k_spinlock snapshot_lock;
+static struct block_bus_snapshot snapshot; // protegido por snapshot_lock
+static bool snapshot_valid;
+
+int block_bus_subscribe(struct block_subscriber *sub)
+{
+    static struct k_spinlock lock;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    atomic_val_t n = atomic_get(&num_subscribers);
+
+    if (n >= BLOCK_BUS_MAX_SUBSCRIBERS)
+    {
+        k_spin_unlock(&lock, key);
+        return -ENOMEM;
+    }
+
+    /* O despachante só lê posições abaixo de num_subscribers. */
+    subscribers[n] = sub;
+    atomic_set(&num_subscribers, n + 1);
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+void block_bus_set_active(struct block_subscriber *sub, bool active)
+{
+    atomic_set(&sub->active, active ? 1 : 0);
+}
+
+void block_bus_publish(struct acq_block *block)
+{
+    if (!acq_block_lend(block))
+    {
+        atomic_inc(&dropped);
+        return;
+    }
+
+    (void)k_msgq_put(&bus_blocks, &block, K_NO_WAIT); // cabe: fila de ACQ_MAX_LENT
+}
+
+bool block_bus_snapshot(struct block_bus_snapshot *snap)
+{
+    k_spinlock_key_t key = k_spin_lock(&snapshot_lock);
+    bool valid = snapshot_valid;
+
+    *snap = snapshot;
+    k_spin_unlock(&snapshot_lock, key);
+
+    return valid;
+}
+
+uint32_t block_bus_dropped(void)
+{
+    return (uint32_t)atomic_get(&dropped);
+}
+
+static void update_snapshot(const struct acq_block *block)
+{
+    k_spinlock_key_t key = k_spin_lock(&snapshot_lock);
+
+    snapshot.seq = block->seq;
+    snapshot.timestamp = block->timestamp;
+    snapshot.interval_us = block->interval_us;
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        uint16_t raw = acq_sample(block, ACQ_BLOCK_LEN - 1, i);
+
+        snapshot.last_in[i] = acq_channel(i)->channel_cfg.differential ?
+                              (int32_t)((int16_t)raw) : (int32_t)raw;
+        if (block->n_out[i] > 0U)
+        {
+            snapshot.last_out[i] = block->out[i][block->n_out[i] - 1U];
+        }
+    }
+    snapshot_valid = true;
+    k_spin_unlock(&snapshot_lock, key);
+}
+
+static void bus_task(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    while (1)
+    {
+        struct acq_block *block;
+
+        (void)k_msgq_get(&bus_blocks, &block, K_FOREVER);
+        atomic_inc(&published);
+        update_snapshot(block);
+
+        atomic_val_t n = atomic_get(&num_subscribers);
+
+        for (atomic_val_t i = 0; i < n; i++)
+        {
+            struct block_subscriber *sub = subscribers[i];
+
+            if (!atomic_get(&sub->active))
+            {
+                continue;
+            }
+
+            acq_block_ref(block);
+            if (k_msgq_put(sub->queue, &block, K_NO_WAIT) != 0)
+            {
+                acq_release_block(block);
+                atomic_inc(&sub->dropped);
+                continue;
+            }
+            atomic_inc(&sub->delivered);
+        }
+
+        /* Devolve a referência do empréstimo; os assinantes têm as suas. */
+        acq_release_block(block);
+    }
+}
+
+K_THREAD_DEFINE(bus_tid, BUS_STACK_SIZE, bus_task, NULL, NULL, NULL, BUS_PRIORITY, 0, 0);
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_bus(const struct shell *shell, size_t argc, char **argv)
+{
+    atomic_val_t n = atomic_get(&num_subscribers);
+
+    shell_print(shell, "Blocos publicados: %u, não publicados (sem bloco livre): %u",
+                (uint32_t)atomic_get(&published), block_bus_dropped());
+    shell_print(shell, "%-14s %-8s %10s %10s %6s", "Assinante", "Estado", "Entregues",
+                "Perdidos", "Fila");
+
+    for (atomic_val_t i = 0; i < n; i++)
+    {
+        struct block_subscriber *sub = subscribers[i];
+
+        shell_print(shell, "%-14s %-8s %10u %10u %3u/%-2u", sub->name,
+                    atomic_get(&sub->active) ? "ativo" : "inativo",
+                    (uint32_t)atomic_get(&sub->delivered), (uint32_t)atomic_get(&sub->dropped),
+                    k_msgq_num_used_get(sub->queue), sub->queue->max_msgs);
+    }
+
+    return 0;
+}
+
+SHELL_CMD_REGISTER(bus, NULL, "Assinantes dos blocos de amostras e descartes", cmd_bus);
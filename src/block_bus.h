@@ -0,0 +1,84 @@
+/*
+ * Publicação e assinatura de blocos de amostras entre estágios.
+ *
+ * A tarefa de tempo real publica cada bloco processado uma única vez
+ * (block_bus_publish()): empresta o bloco (acq_block_lend()) e coloca o
+ * ponteiro na fila do despachante, sem cópia e com custo que não depende
+ * do número de assinantes. A thread do despachante, logo abaixo da tarefa
+ * de tempo real, atualiza o retrato usado pelo shell e entrega uma
+ * referência do bloco na fila de cada assinante ativo. Cada assinante roda
+ * na própria thread e prioridade, lê as amostras brutas e as saídas dos
+ * pipelines direto do bloco e o devolve com acq_release_block(). O bloco
+ * volta para a aquisição quando a última referência é devolvida.
+ *
+ * Se o limite de ACQ_MAX_LENT blocos emprestados foi atingido o bloco não
+ * é publicado (descarte do barramento); se a fila de um assinante está
+ * cheia só ele perde o bloco (descarte do assinante).
+ */
+
+#ifndef BLOCK_BUS_H_
+#define BLOCK_BUS_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "acquisition.h"
+
+#define BLOCK_BUS_MAX_SUBSCRIBERS 6
+
+struct block_subscriber
+{
+    const char *name;
+    struct k_msgq *queue; // ponteiros para blocos, uma referência cada
+    atomic_t active;      // só assinantes ativos recebem blocos
+    atomic_t delivered;
+    atomic_t dropped;     // blocos perdidos com a fila cheia
+};
+
+/* Define um assinante com fila de 'depth' blocos. */
+#define BLOCK_SUBSCRIBER_DEFINE(_name, _depth)                                  \
+    K_MSGQ_DEFINE(_name##_queue, sizeof(struct acq_block *), _depth, 4);        \
+    struct block_subscriber _name = {                                           \
+        .name = #_name,                                                         \
+        .queue = &_name##_queue,                                                \
+    }
+
+/* Último bloco publicado, para consulta pelo shell. */
+struct block_bus_snapshot
+{
+    uint32_t seq;
+    uint32_t timestamp;
+    uint32_t interval_us;
+    int32_t last_in[ACQ_NUM_CHANNELS];  // última amostra bruta de cada canal
+    int32_t last_out[ACQ_NUM_CHANNELS]; // última saída de cada pipeline
+};
+
+/* Registra um assinante, inicialmente inativo. Retorna -ENOMEM se já há
+ * BLOCK_BUS_MAX_SUBSCRIBERS. */
+int block_bus_subscribe(struct block_subscriber *sub);
+
+/* Liga ou desliga a entrega de blocos. Blocos já na fila continuam lá e
+ * devem ser consumidos normalmente. */
+void block_bus_set_active(struct block_subscriber *sub, bool active);
+
+/* Publica um bloco. Chamada só pela tarefa de tempo real, antes de
+ * devolver a própria referência; não bloqueia. */
+void block_bus_publish(struct acq_block *block);
+
+/* Espera o próximo bloco do assinante. O bloco deve ser devolvido com
+ * acq_release_block(). */
+static inline int block_bus_get(struct block_subscriber *sub, struct acq_block **block,
+                                k_timeout_t timeout)
+{
+    return k_msgq_get(sub->queue, block, timeout);
+}
+
+/* Copia o retrato do último bloco publicado. Retorna false se nenhum bloco
+ * foi publicado ainda. */
+bool block_bus_snapshot(struct block_bus_snapshot *snap);
+
+/* Blocos não publicados por falta de bloco livre para emprestar. */
+uint32_t block_bus_dropped(void);
+
+#endif /* BLOCK_BUS_H_ */
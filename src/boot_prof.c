@@ -0,0 +1,141 @@
+#include "boot_prof.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#ifdef CONFIG_HWINFO
+#include <zephyr/drivers/hwinfo.h>
+#endif
+
+atomic_t boot_stages_done;
+
+static uint32_t stage_cycles[BOOT_STAGE_COUNT];
+static uint32_t reset_cause;
+static int reset_cause_err = -ENOTSUP;
+
+static const char *const stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_KERNEL] = "kernel",
+    [BOOT_STAGE_DRIVERS] = "drivers",
+    [BOOT_STAGE_MAIN] = "main",
+    [BOOT_STAGE_PIPELINE_READY] = "pipeline",
+    [BOOT_STAGE_ACQ_STARTED] = "aquisição",
+    [BOOT_STAGE_FIRST_BLOCK] = "primeiro bloco",
+    [BOOT_STAGE_FIRST_DAC] = "primeira saída DAC",
+    [BOOT_STAGE_USB_ENABLED] = "USB",
+    [BOOT_STAGE_SERVICES] = "serviços",
+};
+
+void boot_mark_stage(enum boot_stage stage)
+{
+    const uint32_t now = k_cycle_get_32();
+
+    if (!atomic_test_and_set_bit(&boot_stages_done, stage))
+    {
+        stage_cycles[stage] = now;
+    }
+}
+
+static int boot_kernel_up(void)
+{
+    boot_mark(BOOT_STAGE_KERNEL);
+
+#ifdef CONFIG_HWINFO
+    /* A causa fica registrada no hardware até ser limpa; só este boot a lê. */
+    reset_cause_err = hwinfo_get_reset_cause(&reset_cause);
+    if (reset_cause_err == 0)
+    {
+        (void)hwinfo_clear_reset_cause();
+    }
+#endif
+
+    return 0;
+}
+
+static int boot_drivers_done(void)
+{
+    boot_mark(BOOT_STAGE_DRIVERS);
+    return 0;
+}
+
+SYS_INIT(boot_kernel_up, POST_KERNEL, 0);
+SYS_INIT(boot_drivers_done, APPLICATION, 99);
+
+/* --- COMANDOS DO SHELL --- */
+
+#ifdef CONFIG_HWINFO
+static const struct
+{
+    uint32_t flag;
+    const char *name;
+} reset_names[] = {
+    {RESET_PIN, "pino"},           {RESET_SOFTWARE, "software"},
+    {RESET_BROWNOUT, "brown-out"}, {RESET_POR, "power-on"},
+    {RESET_WATCHDOG, "watchdog"},  {RESET_DEBUG, "debug"},
+    {RESET_SECURITY, "segurança"}, {RESET_LOW_POWER_WAKE, "saída de baixo consumo"},
+    {RESET_CPU_LOCKUP, "lockup"},  {RESET_PARITY, "paridade"},
+    {RESET_PLL, "PLL"},            {RESET_CLOCK, "clock"},
+    {RESET_HARDWARE, "hardware"},  {RESET_USER, "usuário"},
+    {RESET_TEMPERATURE, "temperatura"},
+};
+#endif
+
+static void print_reset_cause(const struct shell *shell)
+{
+#ifdef CONFIG_HWINFO
+    char buf[96];
+    size_t len = 0U;
+
+    if (reset_cause_err != 0)
+    {
+        shell_print(shell, "Causa do reset: indisponível (%d)", reset_cause_err);
+        return;
+    }
+
+    buf[0] = '\0';
+    for (size_t i = 0U; i < ARRAY_SIZE(reset_names); i++)
+    {
+        if ((reset_cause & reset_names[i].flag) != 0U && len < sizeof(buf))
+        {
+            len += snprintk(buf + len, sizeof(buf) - len, "%s%s", len > 0U ? ", " : "",
+                            reset_names[i].name);
+        }
+    }
+    shell_print(shell, "Causa do reset: %s (0x%08x)", len > 0U ? buf : "desconhecida",
+                reset_cause);
+#else
+    shell_print(shell, "Causa do reset: sem CONFIG_HWINFO");
+#endif
+}
+
+static int cmd_boot(const struct shell *shell, size_t argc, char **argv)
+{
+    uint32_t prev_us = 0U;
+
+    shell_print(shell, "Partida %s", IS_ENABLED(CONFIG_APP_FAST_START) ?
+                "rápida: pipeline antes de USB, shell e LEDs" : "sequencial");
+    print_reset_cause(shell);
+    shell_print(shell, "");
+    shell_print(shell, "Etapa                | Desde o reset | Delta");
+    shell_print(shell, "---------------------|---------------|-----------");
+
+    for (size_t i = 0U; i < BOOT_STAGE_COUNT; i++)
+    {
+        if (!atomic_test_bit(&boot_stages_done, i))
+        {
+            shell_print(shell, "%-20s | %13s |", stage_names[i], "-");
+            continue;
+        }
+
+        uint32_t us = (uint32_t)k_cyc_to_us_floor64(stage_cycles[i]);
+
+        shell_print(shell, "%-20s | %10u us | %+8d us", stage_names[i], us,
+                    (int32_t)(us - prev_us));
+        prev_us = us;
+    }
+
+    return 0;
+}
+
+SHELL_CMD_REGISTER(boot, NULL, "Etapas da inicialização e causa do reset", cmd_boot);
@@ -0,0 +1,50 @@
+/*
+ * Perfil de inicialização: instantes de cada etapa desde o reset até a
+ * primeira amostra no DAC.
+ *
+ * Os instantes são k_cycle_get_32() no momento em que cada etapa é
+ * alcançada pela primeira vez. O contador de ciclos começa com o timer do
+ * sistema, logo depois da configuração dos clocks, e serve como medida do
+ * tempo desde o reset. boot_mark() só grava uma vez por etapa: depois da
+ * primeira chamada custa a leitura de um bit, então pode ficar no caminho
+ * de tempo real (primeiro bloco, primeira escrita no DAC).
+ *
+ * O comando 'boot' mostra as etapas, a causa do último reset (hwinfo) e se
+ * o modo de partida rápida (CONFIG_APP_FAST_START) está ativo.
+ */
+
+#ifndef BOOT_PROF_H_
+#define BOOT_PROF_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <stdint.h>
+
+enum boot_stage
+{
+    BOOT_STAGE_KERNEL,         // kernel pronto (início de POST_KERNEL)
+    BOOT_STAGE_DRIVERS,        // fim da inicialização de drivers e subsistemas
+    BOOT_STAGE_MAIN,           // entrada de main()
+    BOOT_STAGE_PIPELINE_READY, // pipelines e taxa configurados
+    BOOT_STAGE_ACQ_STARTED,    // ADC convertendo o primeiro bloco
+    BOOT_STAGE_FIRST_BLOCK,    // primeiro bloco processado
+    BOOT_STAGE_FIRST_DAC,      // primeira amostra escrita no DAC
+    BOOT_STAGE_USB_ENABLED,    // pilha USB habilitada (console e shell)
+    BOOT_STAGE_SERVICES,       // LEDs, botão e amostradores prontos
+    BOOT_STAGE_COUNT,
+};
+
+extern atomic_t boot_stages_done;
+
+void boot_mark_stage(enum boot_stage stage);
+
+/* Registra o primeiro instante em que 'stage' foi alcançada. */
+static inline void boot_mark(enum boot_stage stage)
+{
+    if (!atomic_test_bit(&boot_stages_done, stage))
+    {
+        boot_mark_stage(stage);
+    }
+}
+
+#endif /* BOOT_PROF_H_ */
@@ -0,0 +1,283 @@
+#include "button.h"
+#include "rt_stats.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(button, LOG_LEVEL_INF);
+
+#define SW0_NODE DT_ALIAS(sw0)
+#define BUTTON_STACK_SIZE 768
+
+struct button_event
+{
+    uint32_t edge_cyc; // k_cycle_get_32() na entrada do ISR
+    bool synthetic;    // gerado por 'button inject'
+};
+
+struct button_stats
+{
+    uint32_t events;
+    uint32_t presses;   // toques aceitos pelo debounce
+    uint32_t bounces;   // bordas descartadas pelo debounce
+    uint32_t synthetic;
+    uint32_t min_latency_cyc;
+    uint32_t max_latency_cyc;
+    uint64_t sum_latency_cyc;
+    uint32_t hist[BUTTON_HIST_BUCKETS];
+};
+
+static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(SW0_NODE, gpios, {0});
+static struct gpio_callback button_cb_data;
+static button_handler_t press_handler;
+
+K_MSGQ_DEFINE(button_events, sizeof(struct button_event), BUTTON_QUEUE_LEN, 4);
+
+static struct k_spinlock stats_lock;
+static struct button_stats stats; // escrita pela thread do botão, lida pelo shell
+static atomic_t queue_overflows;
+static atomic_t max_isr_cyc;
+
+static struct k_timer inject_timer;
+static atomic_t inject_left;
+
+/* Parte comum aos ISRs do botão e do gerador de eventos: só o instante e a fila. */
+static inline void signal_edge(bool synthetic)
+{
+    const uint32_t entry = k_cycle_get_32();
+    const struct button_event evt = {.edge_cyc = entry, .synthetic = synthetic};
+
+    if (k_msgq_put(&button_events, &evt, K_NO_WAIT) != 0)
+    {
+        atomic_inc(&queue_overflows);
+    }
+
+    const atomic_val_t duration = (atomic_val_t)(k_cycle_get_32() - entry);
+    atomic_val_t max = atomic_get(&max_isr_cyc);
+
+    while (duration > max && !atomic_cas(&max_isr_cyc, max, duration))
+    {
+        max = atomic_get(&max_isr_cyc);
+    }
+}
+
+static void button_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    signal_edge(false);
+}
+
+static void inject_expiry(struct k_timer *timer)
+{
+    signal_edge(true);
+
+    if (atomic_dec(&inject_left) <= 1)
+    {
+        k_timer_stop(timer);
+    }
+}
+
+static void record_latency(uint32_t latency_cyc, bool synthetic)
+{
+    uint32_t latency_us = k_cyc_to_us_floor32(latency_cyc);
+    size_t bucket = MIN((size_t)LOG2(latency_us + 1U), BUTTON_HIST_BUCKETS - 1U);
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    stats.events++;
+    stats.synthetic += synthetic ? 1U : 0U;
+    stats.min_latency_cyc = MIN(stats.min_latency_cyc, latency_cyc);
+    stats.max_latency_cyc = MAX(stats.max_latency_cyc, latency_cyc);
+    stats.sum_latency_cyc += latency_cyc;
+    stats.hist[bucket]++;
+    k_spin_unlock(&stats_lock, key);
+}
+
+static void reset_stats(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    memset(&stats, 0, sizeof(stats));
+    stats.min_latency_cyc = UINT32_MAX;
+    k_spin_unlock(&stats_lock, key);
+
+    atomic_clear(&queue_overflows);
+    atomic_clear(&max_isr_cyc);
+}
+
+static void button_task(void *arg1, void *arg2, void *arg3)
+{
+    const uint32_t debounce_cyc = k_ms_to_cyc_ceil32(BUTTON_DEBOUNCE_MS);
+    uint32_t last_press_cyc = 0U;
+    bool pressed_once = false;
+
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    reset_stats();
+
+    while (1)
+    {
+        struct button_event evt;
+
+        (void)k_msgq_get(&button_events, &evt, K_FOREVER);
+        record_latency(k_cycle_get_32() - evt.edge_cyc, evt.synthetic);
+
+        if (evt.synthetic)
+        {
+            continue;
+        }
+
+        /* Debounce: a primeira borda vale; as seguintes dentro da janela são repique. */
+        if (pressed_once && evt.edge_cyc - last_press_cyc < debounce_cyc)
+        {
+            k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+            stats.bounces++;
+            k_spin_unlock(&stats_lock, key);
+            continue;
+        }
+        pressed_once = true;
+        last_press_cyc = evt.edge_cyc;
+
+        k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+        stats.presses++;
+        k_spin_unlock(&stats_lock, key);
+
+        if (press_handler != NULL)
+        {
+            press_handler();
+        }
+    }
+}
+
+K_THREAD_DEFINE(button_tid, BUTTON_STACK_SIZE, button_task, NULL, NULL, NULL,
+                BUTTON_PRIORITY, 0, 0);
+
+int button_init(button_handler_t handler)
+{
+    int ret;
+
+    press_handler = handler;
+    k_timer_init(&inject_timer, inject_expiry, NULL);
+
+    if (button.port == NULL || !gpio_is_ready_dt(&button))
+    {
+        LOG_ERR("Button device not ready");
+        return -ENODEV;
+    }
+
+    ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
+    if (ret != 0)
+    {
+        LOG_ERR("Error %d: failed to configure %s pin %d",
+                ret, button.port->name, button.pin);
+        return ret;
+    }
+
+    ret = gpio_pin_interrupt_configure_dt(&button, GPIO_INT_EDGE_TO_ACTIVE);
+    if (ret != 0)
+    {
+        LOG_ERR("Error %d: failed to configure interrupt on %s pin %d",
+                ret, button.port->name, button.pin);
+        return ret;
+    }
+
+    gpio_init_callback(&button_cb_data, button_isr, BIT(button.pin));
+    gpio_add_callback(button.port, &button_cb_data);
+    LOG_INF("Set up button at %s pin %d", button.port->name, button.pin);
+
+    return 0;
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_button_latency(const struct shell *shell, size_t argc, char **argv)
+{
+    struct button_stats st;
+    struct rt_stats rt;
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    st = stats;
+    k_spin_unlock(&stats_lock, key);
+    rt_stats_snapshot(&rt);
+
+    shell_print(shell, "Eventos: %u (%u sintéticos), toques: %u, repiques: %u, fila cheia: %u",
+                st.events, st.synthetic, st.presses, st.bounces,
+                (uint32_t)atomic_get(&queue_overflows));
+    shell_print(shell, "Duração máxima do ISR: %u ciclos (%u us)",
+                (uint32_t)atomic_get(&max_isr_cyc),
+                k_cyc_to_us_ceil32((uint32_t)atomic_get(&max_isr_cyc)));
+
+    if (st.events == 0U)
+    {
+        shell_print(shell, "Nenhum evento registrado.");
+        return 0;
+    }
+
+    shell_print(shell, "Latência ISR -> thread: mín %u us, média %u us, máx %u us",
+                k_cyc_to_us_floor32(st.min_latency_cyc),
+                (uint32_t)k_cyc_to_us_floor64(st.sum_latency_cyc / st.events),
+                k_cyc_to_us_ceil32(st.max_latency_cyc));
+
+    for (size_t b = 0U; b < BUTTON_HIST_BUCKETS; b++)
+    {
+        if (st.hist[b] == 0U)
+        {
+            continue;
+        }
+        shell_print(shell, "  %6u - %6u us: %u", (1U << b) - 1U, (1U << (b + 1U)) - 2U,
+                    st.hist[b]);
+    }
+
+    shell_print(shell, "filter_task: jitter máx %u us, latência máx %u us, %u prazos perdidos",
+                k_cyc_to_us_ceil32(rt.max_jitter_cyc), k_cyc_to_us_ceil32(rt.max_latency_cyc),
+                rt.deadline_misses);
+
+    return 0;
+}
+
+static int cmd_button_inject(const struct shell *shell, size_t argc, char **argv)
+{
+    int count = atoi(argv[1]);
+    int period_us = argc > 2 ? atoi(argv[2]) : 1000;
+
+    if (count <= 0 || period_us <= 0)
+    {
+        shell_print(shell, "Uso: button inject <eventos> [periodo_us]");
+        return -EINVAL;
+    }
+
+    atomic_set(&inject_left, count);
+    k_timer_start(&inject_timer, K_USEC(period_us), K_USEC(period_us));
+    shell_print(shell, "Gerando %d eventos a cada %d us.", count, period_us);
+    return 0;
+}
+
+static int cmd_button_reset(const struct shell *shell, size_t argc, char **argv)
+{
+    reset_stats();
+    rt_stats_reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_button,
+    SHELL_CMD(latency, NULL, "Histograma da latência ISR -> thread", cmd_button_latency),
+    SHELL_CMD_ARG(inject, NULL, "Eventos sintéticos: inject <eventos> [periodo_us]",
+                  cmd_button_inject, 2, 1),
+    SHELL_CMD(reset, NULL, "Zera as medidas do botão e do rt_stats", cmd_button_reset),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(button, &sub_button, "Latência da interrupção do botão", cmd_button_latency);
@@ -0,0 +1,32 @@
+/*
+ * Botão do usuário com tratamento adiado e medida de latência.
+ *
+ * A interrupção do botão apenas lê k_cycle_get_32() e coloca o instante
+ * da borda numa fila. Uma thread (BUTTON_PRIORITY) faz o debounce e chama
+ * o tratador da aplicação em contexto de thread, então o ISR não mexe em
+ * GPIO nem em estado compartilhado com as tarefas.
+ *
+ * Para cada evento a thread registra a latência ISR -> thread num
+ * histograma; o ISR registra a própria duração. O comando 'button inject'
+ * gera eventos sintéticos a partir de um k_timer (também em contexto de
+ * interrupção) pelo mesmo caminho, para medir a latência e o efeito das
+ * interrupções no jitter da filter_task (rt_stats) sem pressionar o botão.
+ */
+
+#ifndef BUTTON_H_
+#define BUTTON_H_
+
+#include <stdint.h>
+
+#define BUTTON_PRIORITY 6      // abaixo das tarefas de tempo real
+#define BUTTON_DEBOUNCE_MS 30  // bordas dentro da janela após um toque são ignoradas
+#define BUTTON_QUEUE_LEN 8
+#define BUTTON_HIST_BUCKETS 16 // bucket k: latência em [2^k - 1, 2^(k+1) - 1) us
+
+/* Chamado em contexto de thread a cada toque aceito pelo debounce. */
+typedef void (*button_handler_t)(void);
+
+/* Configura o pino sw0 e a interrupção. */
+int button_init(button_handler_t handler);
+
+#endif /* BUTTON_H_ */
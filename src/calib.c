@@ -0,0 +1,537 @@
+#include "calib.h"
+#include "block_bus.h"
+
+#ifdef CONFIG_APP_SIGGEN
+#include "siggen.h"
+#endif
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(calib, LOG_LEVEL_INF);
+
+#define CALIB_NONE 0xFFU
+#define CALIB_LOW_CODE 205    // 5% da escala do DAC
+#define CALIB_HIGH_CODE 3890  // 95% da escala do DAC
+#define CALIB_SETTLE_MS 50    // espera o DAC e o ADC assentarem em cada nível
+#define CALIB_AVG_SAMPLES 256 // amostras somadas por ponto
+#define CALIB_BLOCK_TIMEOUT_MS 500
+#define CALIB_APPLY_TIMEOUT_MS 1000
+#define CALIB_MAX_ERROR_DIV 8 // erro acima de 1/8 da escala: canal não ligado ao gerador
+
+BUILD_ASSERT(ACQ_NUM_CHANNELS < CALIB_NONE, "too many channels for the calibration tables");
+
+struct calib_info
+{
+    uint8_t n_points; // 0: identidade
+    struct calib_point points[CALIB_MAX_POINTS];
+};
+
+/* Uma tabela por canal mais uma livre, onde a próxima é montada. */
+static uint16_t tables[ACQ_NUM_CHANNELS + 1][CALIB_LUT_LEN];
+static struct calib_info infos[ACQ_NUM_CHANNELS + 1];
+static atomic_t active[ACQ_NUM_CHANNELS]; // tabela em uso por canal
+static uint8_t spare = ACQ_NUM_CHANNELS; // tabela livre
+static atomic_t pending = ATOMIC_INIT(CALIB_NONE); // canal cuja tabela nova está em 'spare'
+
+/* Serializa quem monta tabelas (shell e calibração no boot). */
+static K_MUTEX_DEFINE(calib_lock);
+
+static int32_t max_code(size_t channel)
+{
+    return (1 << acq_channel(channel)->resolution) - 1;
+}
+
+static int32_t div_round(int32_t num, int32_t den)
+{
+    return (num >= 0 ? num + den / 2 : num - den / 2) / den;
+}
+
+/* Interpolação linear entre pontos consecutivos; antes do primeiro e depois
+ * do último o trecho da ponta é estendido. */
+static void build_table(uint16_t *table, const struct calib_point *points, size_t n,
+                        int32_t top)
+{
+    size_t seg = 0U;
+
+    for (int32_t raw = 0; raw < (int32_t)CALIB_LUT_LEN; raw++)
+    {
+        int32_t y;
+
+        if (n == 0U)
+        {
+            y = raw;
+        }
+        else if (n == 1U)
+        {
+            y = raw + points[0].ideal - points[0].measured;
+        }
+        else
+        {
+            while (seg + 2U < n && raw >= points[seg + 1U].measured)
+            {
+                seg++;
+            }
+
+            const int32_t x0 = points[seg].measured;
+            const int32_t x1 = points[seg + 1U].measured;
+            const int32_t y0 = points[seg].ideal;
+            const int32_t y1 = points[seg + 1U].ideal;
+
+            y = y0 + div_round((raw - x0) * (y1 - y0), x1 - x0);
+        }
+
+        table[raw] = (uint16_t)CLAMP(y, 0, top);
+    }
+}
+
+int calib_init(void)
+{
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        if (acq_channel(i)->resolution > CALIB_MAX_BITS)
+        {
+            LOG_ERR("ADC channel %u has %u bits, calibration table covers %u", (uint32_t)i,
+                    acq_channel(i)->resolution, CALIB_MAX_BITS);
+            return -ENOTSUP;
+        }
+
+        build_table(tables[i], NULL, 0U, max_code(i));
+        infos[i].n_points = 0U;
+        atomic_set(&active[i], (atomic_val_t)i);
+    }
+
+    spare = ACQ_NUM_CHANNELS;
+    atomic_set(&pending, CALIB_NONE);
+
+    return 0;
+}
+
+static int stage(size_t channel, const struct calib_point *points, size_t n)
+{
+    int err = 0;
+
+    k_mutex_lock(&calib_lock, K_FOREVER);
+
+    /* A tabela livre não é lida pela tarefa de tempo real enquanto
+     * 'pending' estiver vazio. */
+    if (atomic_get(&pending) != CALIB_NONE)
+    {
+        err = -EBUSY;
+    }
+    else
+    {
+        build_table(tables[spare], points, n, max_code(channel));
+        infos[spare].n_points = (uint8_t)n;
+        memcpy(infos[spare].points, points, n * sizeof(points[0]));
+        atomic_set(&pending, (atomic_val_t)channel);
+    }
+
+    k_mutex_unlock(&calib_lock);
+
+    return err;
+}
+
+int calib_load(size_t channel, const struct calib_point *points, size_t n)
+{
+    if (channel >= ACQ_NUM_CHANNELS || n == 0U || n > CALIB_MAX_POINTS)
+    {
+        return -EINVAL;
+    }
+    if (acq_channel(channel)->channel_cfg.differential)
+    {
+        return -ENOTSUP;
+    }
+    for (size_t i = 1U; i < n; i++)
+    {
+        if (points[i].measured <= points[i - 1U].measured)
+        {
+            return -EINVAL;
+        }
+    }
+
+    return stage(channel, points, n);
+}
+
+int calib_reset(size_t channel)
+{
+    if (channel >= ACQ_NUM_CHANNELS)
+    {
+        return -EINVAL;
+    }
+
+    return stage(channel, NULL, 0U);
+}
+
+bool calib_sync(size_t channel)
+{
+    if (atomic_get(&pending) != (atomic_val_t)channel)
+    {
+        return false;
+    }
+
+    const uint8_t old = (uint8_t)atomic_get(&active[channel]);
+
+    atomic_set(&active[channel], spare);
+    spare = old;
+    atomic_set(&pending, CALIB_NONE);
+
+    return true;
+}
+
+const uint16_t *calib_table(size_t channel)
+{
+    return tables[atomic_get(&active[channel])];
+}
+
+/* Espera a tarefa de tempo real trocar a tabela. */
+static int wait_applied(void)
+{
+    const int64_t end = k_uptime_get() + CALIB_APPLY_TIMEOUT_MS;
+
+    while (atomic_get(&pending) != CALIB_NONE)
+    {
+        if (k_uptime_get() >= end)
+        {
+            return -ETIMEDOUT;
+        }
+        k_sleep(K_MSEC(10));
+    }
+
+    return 0;
+}
+
+/* --- CALIBRAÇÃO PELA MALHA DAC -> ADC --- */
+
+#ifdef CONFIG_APP_SIGGEN
+
+BLOCK_SUBSCRIBER_DEFINE(calib_sub, 4);
+
+static void drain(void)
+{
+    struct acq_block *block;
+
+    while (block_bus_get(&calib_sub, &block, K_NO_WAIT) == 0)
+    {
+        acq_release_block(block);
+    }
+}
+
+/* Média do código bruto do canal com o gerador parado em 'code'. */
+static int measure(size_t channel, uint16_t code, uint16_t *mean)
+{
+    const struct siggen_config dc = {.wave = SIGGEN_DC, .offset = code};
+    struct acq_block *block;
+    uint32_t sum = 0U;
+    uint32_t count = 0U;
+    int err = siggen_start(&dc);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    block_bus_set_active(&calib_sub, false);
+    k_sleep(K_MSEC(CALIB_SETTLE_MS));
+    drain();
+    block_bus_set_active(&calib_sub, true);
+
+    while (count < CALIB_AVG_SAMPLES)
+    {
+        if (block_bus_get(&calib_sub, &block, K_MSEC(CALIB_BLOCK_TIMEOUT_MS)) != 0)
+        {
+            err = -ETIMEDOUT;
+            break;
+        }
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+        {
+            sum += acq_sample(block, n, channel);
+        }
+        count += ACQ_BLOCK_LEN;
+        acq_release_block(block);
+    }
+
+    block_bus_set_active(&calib_sub, false);
+    drain();
+
+    if (err == 0)
+    {
+        *mean = (uint16_t)((sum + count / 2U) / count);
+    }
+
+    return err;
+}
+
+static int measure_points(size_t channel, struct calib_point *points, size_t n)
+{
+    const int32_t top = max_code(channel);
+
+    for (size_t i = 0U; i < n; i++)
+    {
+        const uint16_t code = n == 1U ? (SIGGEN_MAX_CODE + 1U) / 2U :
+                              CALIB_LOW_CODE + (CALIB_HIGH_CODE - CALIB_LOW_CODE) * i / (n - 1U);
+        int err = measure(channel, code, &points[i].measured);
+
+        if (err < 0)
+        {
+            return err;
+        }
+
+        /* Código do DAC na escala do ADC (mesma referência de tensão). */
+        points[i].ideal = (uint16_t)div_round((int32_t)code * top, SIGGEN_MAX_CODE);
+
+        if (abs((int32_t)points[i].measured - points[i].ideal) > top / CALIB_MAX_ERROR_DIV)
+        {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+int calib_run(size_t channel, size_t n_points)
+{
+    static bool subscribed;
+    struct calib_point points[CALIB_MAX_POINTS];
+    int err;
+
+    if (channel >= ACQ_NUM_CHANNELS || n_points == 0U || n_points > CALIB_MAX_POINTS)
+    {
+        return -EINVAL;
+    }
+    if (acq_channel(channel)->channel_cfg.differential)
+    {
+        return -ENOTSUP;
+    }
+
+    k_mutex_lock(&calib_lock, K_FOREVER);
+
+    if (!subscribed)
+    {
+        err = block_bus_subscribe(&calib_sub);
+        if (err < 0)
+        {
+            k_mutex_unlock(&calib_lock);
+            return err;
+        }
+        subscribed = true;
+    }
+
+    const struct siggen_config saved = siggen_current();
+
+    err = measure_points(channel, points, n_points);
+
+    if (saved.wave == SIGGEN_OFF)
+    {
+        siggen_stop();
+    }
+    else
+    {
+        (void)siggen_start(&saved);
+    }
+
+    k_mutex_unlock(&calib_lock);
+
+    if (err == 0)
+    {
+        err = calib_load(channel, points, n_points);
+    }
+    if (err == 0)
+    {
+        err = wait_applied();
+    }
+
+    return err;
+}
+
+#else
+
+int calib_run(size_t channel, size_t n_points)
+{
+    ARG_UNUSED(channel);
+    ARG_UNUSED(n_points);
+    return -ENOTSUP;
+}
+
+#endif /* CONFIG_APP_SIGGEN */
+
+/* --- COMANDOS DO SHELL --- */
+
+static int parse_channel(const struct shell *shell, size_t argc, char **argv, size_t *channel)
+{
+    *channel = 0U;
+    if (argc > 1)
+    {
+        char *end;
+        unsigned long value = strtoul(argv[1], &end, 10);
+
+        if (*end != '\0' || value >= ACQ_NUM_CHANNELS)
+        {
+            shell_print(shell, "Canal inválido (0 a %d).", ACQ_NUM_CHANNELS - 1);
+            return -EINVAL;
+        }
+        *channel = value;
+    }
+
+    return 0;
+}
+
+/* Offset do trecho inicial em raw = 0, antes da saturação da tabela: com a
+ * leitura abaixo do ideal o table[0] fica preso em 0 e esconderia o sinal. */
+static int32_t info_offset(const struct calib_info *info)
+{
+    const struct calib_point *p = info->points;
+
+    if (info->n_points == 0U)
+    {
+        return 0;
+    }
+    if (info->n_points == 1U)
+    {
+        return (int32_t)p[0].ideal - p[0].measured;
+    }
+
+    /* Mesma extrapolação do build_table, avaliada em raw = 0. */
+    return p[0].ideal + div_round(-(int32_t)p[0].measured * (p[1].ideal - p[0].ideal),
+                                  p[1].measured - p[0].measured);
+}
+
+static void print_channel(const struct shell *shell, size_t channel,
+                          const struct block_bus_snapshot *snap)
+{
+    const struct calib_info *info = &infos[atomic_get(&active[channel])];
+    const uint16_t *table = calib_table(channel);
+    const int32_t top = max_code(channel);
+    int32_t worst = 0;
+
+    if (acq_channel(channel)->channel_cfg.differential)
+    {
+        shell_print(shell, "Canal %u: diferencial, sem correção", (uint32_t)channel);
+        return;
+    }
+
+    for (int32_t raw = 0; raw <= top; raw++)
+    {
+        worst = MAX(worst, abs((int32_t)table[raw] - raw));
+    }
+
+    /* Ganho entre as pontas da faixa calibrada, em milésimos. */
+    const int32_t lo = info->n_points > 1U ? info->points[0].measured : 0;
+    const int32_t hi = info->n_points > 1U ? info->points[info->n_points - 1U].measured : top;
+    const int32_t gain_permille = div_round(((int32_t)table[hi] - table[lo]) * 1000, hi - lo);
+
+    shell_print(shell, "Canal %u: %s, offset %+d códigos, ganho %d.%03d, correção máxima %d",
+                (uint32_t)channel, info->n_points == 0U ? "identidade" : "calibrado",
+                info_offset(info), gain_permille / 1000, gain_permille % 1000, worst);
+    for (uint8_t i = 0U; i < info->n_points; i++)
+    {
+        shell_print(shell, "  ponto %u: medido %u -> %u", i, info->points[i].measured,
+                    info->points[i].ideal);
+    }
+
+    if (snap != NULL)
+    {
+        /* Conversão para mV só aqui, fora da tarefa de tempo real. */
+        const int32_t raw = snap->last_in[channel];
+        int32_t mv = calib_apply(table, (uint16_t)raw);
+
+        if (adc_raw_to_millivolts_dt(acq_channel(channel), &mv) < 0)
+        {
+            mv = 0;
+        }
+        shell_print(shell, "  última amostra: bruta %d, corrigida %u (%d mV)", raw,
+                    calib_apply(table, (uint16_t)raw), mv);
+    }
+}
+
+static int cmd_calib_show(const struct shell *shell, size_t argc, char **argv)
+{
+    struct block_bus_snapshot snap;
+    const bool have_snap = block_bus_snapshot(&snap);
+
+    k_mutex_lock(&calib_lock, K_FOREVER);
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        print_channel(shell, i, have_snap ? &snap : NULL);
+    }
+    k_mutex_unlock(&calib_lock);
+
+    return 0;
+}
+
+static int cmd_calib_run(const struct shell *shell, size_t argc, char **argv)
+{
+    size_t channel;
+    size_t n_points = CONFIG_APP_CALIB_POINTS;
+
+    if (parse_channel(shell, argc, argv, &channel) < 0)
+    {
+        return -EINVAL;
+    }
+    if (argc > 2)
+    {
+        n_points = (size_t)atoi(argv[2]);
+    }
+
+    shell_print(shell, "Calibrando o canal %u com %u pontos do gerador...", (uint32_t)channel,
+                (uint32_t)n_points);
+
+    int err = calib_run(channel, n_points);
+
+    switch (err)
+    {
+    case 0:
+        print_channel(shell, channel, NULL);
+        break;
+    case -EINVAL:
+        shell_print(shell, "Pontos: 1 a %d; as médias precisam crescer com o nível do DAC.",
+                    CALIB_MAX_POINTS);
+        break;
+    case -EIO:
+        shell_print(shell, "Canal não acompanha o gerador (na placa, ligue PA5 -> PA1).");
+        break;
+    case -ENOTSUP:
+        shell_print(shell, "Sem gerador de sinais ou canal diferencial.");
+        break;
+    default:
+        shell_print(shell, "Calibração falhou (%d).", err);
+        break;
+    }
+
+    return err;
+}
+
+static int cmd_calib_reset(const struct shell *shell, size_t argc, char **argv)
+{
+    size_t channel;
+    int err;
+
+    if (parse_channel(shell, argc, argv, &channel) < 0)
+    {
+        return -EINVAL;
+    }
+
+    err = calib_reset(channel);
+    if (err == 0)
+    {
+        err = wait_applied();
+    }
+    shell_print(shell, err == 0 ? "Canal %u sem correção." : "Falha ao limpar o canal %u.",
+                (uint32_t)channel);
+
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_calib,
+    SHELL_CMD(show, NULL, "Tabelas em uso e última amostra em mV", cmd_calib_show),
+    SHELL_CMD_ARG(run, NULL, "Calibra pelo gerador: run [canal] [pontos]", cmd_calib_run, 1, 2),
+    SHELL_CMD_ARG(reset, NULL, "Volta à tabela identidade: reset [canal]", cmd_calib_reset, 1, 1),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(calib, &sub_calib, "Calibração da entrada do ADC", cmd_calib_show);
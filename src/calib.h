@@ -0,0 +1,69 @@
+/*
+ * Calibração da entrada do ADC por tabela.
+ *
+ * Cada canal de io-channels tem uma tabela de CALIB_LUT_LEN entradas que
+ * leva o código bruto ao código corrigido (offset, ganho e, com mais de
+ * dois pontos, não linearidade, por interpolação linear entre os pontos).
+ * No caminho do bloco a correção é uma única leitura indexada
+ * (calib_apply()); os filtros, o DAC e as amostras filtradas da telemetria
+ * trabalham com códigos corrigidos. As amostras brutas da telemetria e da
+ * captura continuam sem correção, para diagnosticar a própria calibração.
+ * A conversão para milivolts só é feita quando o shell pede.
+ *
+ * As tabelas começam como identidade. 'calib run' liga o gerador de sinais
+ * (siggen.h) em níveis DC e mede a média do canal ligado a ele, como em
+ * 'bench sweep'; o código ideal de cada ponto é o do DAC na resolução do
+ * ADC. Uma tabela nova é montada numa tabela livre e trocada pela tarefa
+ * de tempo real na fronteira de bloco (calib_sync()), como os bancos do
+ * filtro. Canais diferenciais não são corrigidos.
+ */
+
+#ifndef CALIB_H_
+#define CALIB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "acquisition.h"
+
+#define CALIB_MAX_BITS 12 // resolução máxima do ADC coberta pela tabela
+#define CALIB_LUT_LEN (1U << CALIB_MAX_BITS)
+#define CALIB_MAX_POINTS 9
+
+struct calib_point
+{
+    uint16_t measured; // média do código bruto
+    uint16_t ideal;    // código esperado
+};
+
+/* Tabelas identidade para todos os canais. Chamada por pipeline_init(). */
+int calib_init(void);
+
+/* Monta a tabela do canal a partir de 'n' pontos (1: só offset; 2: offset
+ * e ganho; mais: por trechos) e a deixa pendente até o próximo bloco.
+ * Os pontos devem ter 'measured' crescente. Retorna -EBUSY se outra tabela
+ * ainda não foi aplicada. */
+int calib_load(size_t channel, const struct calib_point *points, size_t n);
+
+/* Volta o canal para a tabela identidade. */
+int calib_reset(size_t channel);
+
+/* Aplica a tabela pendente do canal. Chamada pela tarefa de tempo real
+ * entre blocos. */
+bool calib_sync(size_t channel);
+
+/* Tabela em uso pelo canal. */
+const uint16_t *calib_table(size_t channel);
+
+/* Código corrigido de uma amostra bruta. */
+static inline uint16_t calib_apply(const uint16_t *table, uint16_t raw)
+{
+    return table[raw & (CALIB_LUT_LEN - 1U)];
+}
+
+/* Mede 'n_points' níveis do gerador no canal e carrega a tabela. Bloqueia
+ * por 50 ms mais 256 amostragens por ponto (0,3 s a 1 kHz). Retorna -EIO se
+ * o canal não acompanha o gerador e -ENOTSUP sem gerador de sinais. */
+int calib_run(size_t channel, size_t n_points);
+
+#endif /* CALIB_H_ */
@@ -0,0 +1,271 @@
+#include "capture.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/base64.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPTURE_MASK (CAPTURE_RING_LEN - 1U)
+#define CAPTURE_DUMP_CHUNK 192 // amostragens por linha do dump (1024 caracteres base64)
+
+BUILD_ASSERT((CAPTURE_RING_LEN & CAPTURE_MASK) == 0, "CAPTURE_RING_LEN must be a power of 2");
+
+enum capture_state
+{
+    CAPTURE_IDLE,
+    CAPTURE_ARMED,     // gravando e procurando o gatilho
+    CAPTURE_TRIGGERED, // gravando as amostras pós-gatilho
+    CAPTURE_DONE,      // congelada até o próximo arm
+};
+
+/* Bruta nos 16 bits baixos e filtrada nos altos. */
+static uint32_t ring[CAPTURE_RING_LEN];
+
+static atomic_t state;
+static atomic_t button_pressed_flag;
+
+/* Configuração: escrita pelo shell só com a captura parada. */
+static uint8_t capture_channel;
+static uint16_t capture_len = CAPTURE_DEFAULT_LEN;
+static uint16_t capture_pre = CAPTURE_DEFAULT_PRE;
+static enum capture_trigger trigger = CAPTURE_TRIGGER_RISE;
+static int32_t trigger_level = 2048;
+
+/* Índices absolutos (em amostragens) dentro do stream gravado. */
+static uint32_t head;
+static uint32_t armed_at;
+static uint32_t trigger_at;
+static uint32_t interval_us;
+static int32_t last_raw; // amostra anterior ao bloco, para detectar bordas
+static int32_t last_out; // repetida nos blocos sem saída filtrada (sobreamostragem > bloco)
+
+static const char *const trigger_names[] = {"level", "rise", "fall", "button", "now"};
+static const char *const state_names[] = {"parada", "armada", "disparada", "congelada"};
+
+/* Posição do gatilho no bloco que acabou de ser gravado, ou -1. */
+static int find_trigger(const struct acq_block *block, size_t channel)
+{
+    int32_t prev = last_raw;
+
+    switch (trigger)
+    {
+    case CAPTURE_TRIGGER_NOW:
+        return 0;
+    case CAPTURE_TRIGGER_BUTTON:
+        return atomic_cas(&button_pressed_flag, 1, 0) ? 0 : -1;
+    default:
+        break;
+    }
+
+    for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+    {
+        int32_t raw = acq_sample(block, n, channel);
+        bool hit = (trigger == CAPTURE_TRIGGER_LEVEL && raw >= trigger_level) ||
+                   (trigger == CAPTURE_TRIGGER_RISE && prev < trigger_level && raw >= trigger_level) ||
+                   (trigger == CAPTURE_TRIGGER_FALL && prev > trigger_level && raw <= trigger_level);
+
+        if (hit)
+        {
+            return (int)n;
+        }
+        prev = raw;
+    }
+
+    return -1;
+}
+
+void capture_block(size_t channel, const struct acq_block *block, const int32_t *out,
+                   size_t n_out)
+{
+    atomic_val_t current = atomic_get(&state);
+
+    if (channel != capture_channel || current == CAPTURE_IDLE || current == CAPTURE_DONE)
+    {
+        return;
+    }
+
+    uint32_t pos = head;
+
+    if (n_out == ACQ_BLOCK_LEN)
+    {
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+        {
+            ring[(pos + n) & CAPTURE_MASK] = acq_sample(block, n, channel) |
+                                             ((uint32_t)(uint16_t)out[n] << 16);
+        }
+    }
+    else
+    {
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+        {
+            int32_t y = n_out > 0U ? out[n * n_out / ACQ_BLOCK_LEN] : last_out;
+
+            ring[(pos + n) & CAPTURE_MASK] = acq_sample(block, n, channel) |
+                                             ((uint32_t)(uint16_t)y << 16);
+        }
+    }
+    head = pos + ACQ_BLOCK_LEN;
+    if (n_out > 0U)
+    {
+        last_out = out[n_out - 1U];
+    }
+
+    if (current == CAPTURE_ARMED && pos - armed_at >= capture_pre)
+    {
+        int n = find_trigger(block, channel);
+
+        if (n >= 0)
+        {
+            trigger_at = pos + (uint32_t)n;
+            interval_us = block->interval_us;
+            current = CAPTURE_TRIGGERED;
+            atomic_set(&state, CAPTURE_TRIGGERED);
+        }
+    }
+
+    if (current == CAPTURE_TRIGGERED && head - trigger_at >= (uint32_t)(capture_len - capture_pre))
+    {
+        atomic_set(&state, CAPTURE_DONE);
+    }
+
+    last_raw = acq_sample(block, ACQ_BLOCK_LEN - 1U, channel);
+}
+
+void capture_button(void)
+{
+    if (atomic_get(&state) == CAPTURE_ARMED && trigger == CAPTURE_TRIGGER_BUTTON)
+    {
+        atomic_set(&button_pressed_flag, 1);
+    }
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_capture_status(const struct shell *shell, size_t argc, char **argv)
+{
+    shell_print(shell, "Captura: %s", state_names[atomic_get(&state)]);
+    shell_print(shell, "Canal %u, %u amostras (%u pré-gatilho), gatilho %s nível %d",
+                capture_channel, capture_len, capture_pre, trigger_names[trigger], trigger_level);
+    return 0;
+}
+
+static int cmd_capture_config(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = atoi(argv[1]);
+    int len = atoi(argv[2]);
+    int pre = argc > 3 ? atoi(argv[3]) : len / 4;
+
+    if (atomic_get(&state) == CAPTURE_ARMED || atomic_get(&state) == CAPTURE_TRIGGERED)
+    {
+        shell_print(shell, "Pare a captura antes ('capture stop').");
+        return -EBUSY;
+    }
+
+    if (channel < 0 || channel >= ACQ_NUM_CHANNELS || len < 1 || len > CAPTURE_MAX_LEN ||
+        pre < 0 || pre >= len)
+    {
+        shell_print(shell, "Uso: config <canal 0..%d> <amostras 1..%d> [pré < amostras]",
+                    ACQ_NUM_CHANNELS - 1, CAPTURE_MAX_LEN);
+        return -EINVAL;
+    }
+
+    capture_channel = (uint8_t)channel;
+    capture_len = (uint16_t)len;
+    capture_pre = (uint16_t)pre;
+    return 0;
+}
+
+static int cmd_capture_arm(const struct shell *shell, size_t argc, char **argv)
+{
+    size_t type;
+
+    for (type = 0U; type < ARRAY_SIZE(trigger_names); type++)
+    {
+        if (strcmp(argv[1], trigger_names[type]) == 0)
+        {
+            break;
+        }
+    }
+
+    if (type == ARRAY_SIZE(trigger_names))
+    {
+        shell_print(shell, "Gatilho inválido. Use level, rise, fall, button ou now.");
+        return -EINVAL;
+    }
+
+    /* A tarefa de tempo real só lê a configuração com a captura armada. */
+    atomic_set(&state, CAPTURE_IDLE);
+    trigger = (enum capture_trigger)type;
+    if (argc > 2)
+    {
+        trigger_level = atoi(argv[2]);
+    }
+    atomic_clear(&button_pressed_flag);
+    armed_at = head;
+    atomic_set(&state, CAPTURE_ARMED);
+
+    shell_print(shell, "Captura armada (gatilho %s, nível %d).", trigger_names[trigger],
+                trigger_level);
+    return 0;
+}
+
+static int cmd_capture_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    atomic_set(&state, CAPTURE_IDLE);
+    return 0;
+}
+
+static int cmd_capture_dump(const struct shell *shell, size_t argc, char **argv)
+{
+    static uint8_t chunk[CAPTURE_DUMP_CHUNK * 4];
+    static uint8_t line[sizeof(chunk) / 3U * 4U + 1U];
+    uint16_t crc = 0xFFFF;
+
+    if (atomic_get(&state) != CAPTURE_DONE)
+    {
+        shell_print(shell, "Nenhuma captura congelada (estado: %s).", state_names[atomic_get(&state)]);
+        return -EAGAIN;
+    }
+
+    /* Com a captura congelada a tarefa de tempo real não escreve no buffer. */
+    uint32_t start = trigger_at - capture_pre;
+
+    shell_print(shell, "capture: begin canal=%u amostras=%u pre=%u intervalo_us=%u gatilho=%s",
+                capture_channel, capture_len, capture_pre, interval_us, trigger_names[trigger]);
+
+    for (uint32_t done = 0U; done < capture_len;)
+    {
+        uint32_t count = MIN(capture_len - done, CAPTURE_DUMP_CHUNK);
+        size_t olen;
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            sys_put_le32(ring[(start + done + i) & CAPTURE_MASK], &chunk[4U * i]);
+        }
+
+        crc = crc16_itu_t(crc, chunk, 4U * count);
+        (void)base64_encode(line, sizeof(line), &olen, chunk, 4U * count);
+        shell_print(shell, "%s", (char *)line);
+        done += count;
+    }
+
+    shell_print(shell, "capture: end crc=%04x", crc);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_capture,
+    SHELL_CMD(status, NULL, "Estado e configuração da captura", cmd_capture_status),
+    SHELL_CMD_ARG(config, NULL, "Configura: config <canal> <amostras> [pré-gatilho]",
+                  cmd_capture_config, 3, 1),
+    SHELL_CMD_ARG(arm, NULL, "Arma: arm <level|rise|fall|button|now> [nível]", cmd_capture_arm, 2, 1),
+    SHELL_CMD(stop, NULL, "Para a captura", cmd_capture_stop),
+    SHELL_CMD(dump, NULL, "Envia a captura congelada em base64", cmd_capture_dump),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(capture, &sub_capture, "Captura disparada de amostras (osciloscópio)",
+                   cmd_capture_status);
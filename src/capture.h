@@ -0,0 +1,50 @@
+/*
+ * Captura disparada em RAM (modo osciloscópio).
+ *
+ * Enquanto armada, a tarefa de tempo real grava as amostras brutas e
+ * filtradas (antes da decimação do canal) de um canal em um buffer circular: uma
+ * escrita de 32 bits por amostragem e um incremento de índice por bloco.
+ * O gatilho (nível, borda ou botão sw0) só é procurado depois que o
+ * histórico pré-gatilho foi preenchido. Depois de CAPTURE_POST amostras o
+ * buffer é congelado até ser lido com 'capture dump', que envia a janela
+ * inteira em base64:
+ *
+ *   capture: begin canal=<c> amostras=<n> pre=<p> intervalo_us=<t> gatilho=<g>
+ *   <linhas base64 com n pares int16 little-endian (bruta, filtrada)>
+ *   capture: end crc=<CRC-16/CCITT-FALSE dos bytes, em hexa>
+ *
+ * scripts/capture_rx.py converte o dump para CSV.
+ */
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "acquisition.h"
+
+#define CAPTURE_RING_LEN 2048 // potência de 2; sobra um bloco além da janela
+#define CAPTURE_MAX_LEN (CAPTURE_RING_LEN - ACQ_BLOCK_LEN)
+#define CAPTURE_DEFAULT_LEN 1024
+#define CAPTURE_DEFAULT_PRE 256
+
+enum capture_trigger
+{
+    CAPTURE_TRIGGER_LEVEL,   // amostra bruta >= nível
+    CAPTURE_TRIGGER_RISE,    // cruza o nível subindo
+    CAPTURE_TRIGGER_FALL,    // cruza o nível descendo
+    CAPTURE_TRIGGER_BUTTON,  // botão sw0
+    CAPTURE_TRIGGER_NOW,     // imediato (assim que houver pré-gatilho)
+};
+
+/* Grava um bloco do canal 'channel'. 'out' tem as 'n_out' amostras
+ * filtradas do bloco; com sobreamostragem há menos saídas que amostragens
+ * e cada saída é repetida nas amostragens correspondentes. Chamada só pela
+ * tarefa de tempo real. */
+void capture_block(size_t channel, const struct acq_block *block, const int32_t *out,
+                   size_t n_out);
+
+/* Dispara uma captura armada com CAPTURE_TRIGGER_BUTTON. Pode ser chamada de ISR. */
+void capture_button(void);
+
+#endif /* CAPTURE_H_ */
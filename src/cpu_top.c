@@ -0,0 +1,228 @@
+#include "cpu_top.h"
+#include "thread_info.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#ifdef CONFIG_CPU_LOAD
+#include <zephyr/debug/cpu_load.h>
+#endif
+
+struct top_sample
+{
+    uint32_t all_cycles;  // ciclos decorridos no intervalo (todas as threads + idle)
+    uint32_t idle_cycles;
+    int16_t cpu_load; // carga em milésimos pelo cpu_load, -1 se indisponível
+    uint32_t thread_cycles[THREAD_INFO_MAX];
+};
+
+/* Cada thread ocupa uma posição fixa para que o histórico seja comparável. */
+struct top_slot
+{
+    k_tid_t tid;
+    char name[THREAD_INFO_NAME_LEN];
+    uint64_t last_cycles;
+};
+
+static struct top_sample history[TOP_HISTORY_LEN];
+static uint8_t history_head; // próxima posição a escrever
+static uint8_t history_count;
+static struct top_slot slots[THREAD_INFO_MAX];
+static uint8_t slot_count;
+static uint64_t last_all_cycles;
+static uint64_t last_idle_cycles;
+static bool primed;
+
+static struct thread_info_snapshot sampler_snapshot;
+K_MUTEX_DEFINE(top_lock);
+
+static void top_sample_work(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(top_work, top_sample_work);
+
+static int find_slot(const struct thread_info *info)
+{
+    for (uint8_t i = 0; i < slot_count; i++)
+    {
+        if (slots[i].tid == info->tid)
+        {
+            return i;
+        }
+    }
+
+    if (slot_count >= THREAD_INFO_MAX)
+    {
+        return -1;
+    }
+
+    slots[slot_count].tid = info->tid;
+    slots[slot_count].last_cycles = info->cycles;
+    strncpy(slots[slot_count].name, info->name, sizeof(slots[slot_count].name));
+
+    return slot_count++;
+}
+
+static void top_sample_work(struct k_work *work)
+{
+    k_thread_runtime_stats_t all;
+    struct top_sample sample = {0};
+
+    (void)k_work_schedule(k_work_delayable_from_work(work), K_MSEC(TOP_SAMPLE_PERIOD_MS));
+
+    thread_info_snapshot(&sampler_snapshot, false);
+    (void)k_thread_runtime_stats_all_get(&all);
+
+#ifdef CONFIG_CPU_LOAD
+    sample.cpu_load = (int16_t)cpu_load_get(true);
+#else
+    sample.cpu_load = -1;
+#endif
+
+    k_mutex_lock(&top_lock, K_FOREVER);
+
+    for (uint8_t i = 0; i < sampler_snapshot.count; i++)
+    {
+        const struct thread_info *info = &sampler_snapshot.threads[i];
+        int slot = find_slot(info);
+
+        if (slot < 0)
+        {
+            continue;
+        }
+
+        sample.thread_cycles[slot] = (uint32_t)(info->cycles - slots[slot].last_cycles);
+        slots[slot].last_cycles = info->cycles;
+    }
+
+    sample.all_cycles = (uint32_t)(all.execution_cycles - last_all_cycles);
+    sample.idle_cycles = (uint32_t)(all.idle_cycles - last_idle_cycles);
+    last_all_cycles = all.execution_cycles;
+    last_idle_cycles = all.idle_cycles;
+
+    /* A primeira leitura só estabelece a referência dos contadores. */
+    if (primed)
+    {
+        history[history_head] = sample;
+        history_head = (history_head + 1U) % TOP_HISTORY_LEN;
+        history_count = MIN(history_count + 1U, TOP_HISTORY_LEN);
+    }
+    primed = true;
+
+    k_mutex_unlock(&top_lock);
+}
+
+void cpu_top_start(void)
+{
+    (void)k_work_schedule(&top_work, K_NO_WAIT);
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+#define TOP_NUM_WINDOWS 3
+
+static const uint8_t window_samples[TOP_NUM_WINDOWS] = {1, 10, 60};
+
+struct top_window
+{
+    uint8_t samples; // amostras efetivamente disponíveis na janela
+    uint64_t all_cycles;
+    uint64_t idle_cycles;
+    int32_t cpu_load_sum;
+    uint64_t thread_cycles[THREAD_INFO_MAX];
+};
+
+static struct top_window windows[TOP_NUM_WINDOWS];
+
+static void sum_window(struct top_window *win, uint8_t samples)
+{
+    memset(win, 0, sizeof(*win));
+
+    for (uint8_t n = 0; n < MIN(samples, history_count); n++)
+    {
+        const struct top_sample *s =
+            &history[(history_head + TOP_HISTORY_LEN - 1U - n) % TOP_HISTORY_LEN];
+
+        win->samples++;
+        win->all_cycles += s->all_cycles;
+        win->idle_cycles += s->idle_cycles;
+        win->cpu_load_sum += s->cpu_load;
+        for (uint8_t t = 0; t < slot_count; t++)
+        {
+            win->thread_cycles[t] += s->thread_cycles[t];
+        }
+    }
+}
+
+/* Porcentagem em décimos (per mille). */
+static uint32_t per_mille(uint64_t part, uint64_t whole)
+{
+    return whole > 0U ? (uint32_t)((part * 1000U) / whole) : 0U;
+}
+
+static int cmd_top(const struct shell *shell, size_t argc, char **argv)
+{
+    char names[THREAD_INFO_MAX][THREAD_INFO_NAME_LEN];
+    uint8_t count;
+
+    /* Copia e soma o histórico com o lock; a impressão acontece sem ele. */
+    k_mutex_lock(&top_lock, K_FOREVER);
+    for (uint8_t w = 0; w < TOP_NUM_WINDOWS; w++)
+    {
+        sum_window(&windows[w], window_samples[w]);
+    }
+    count = slot_count;
+    for (uint8_t t = 0; t < count; t++)
+    {
+        memcpy(names[t], slots[t].name, sizeof(names[t]));
+    }
+    k_mutex_unlock(&top_lock);
+
+    if (windows[0].samples == 0U)
+    {
+        shell_print(shell, "Sem amostras ainda, tente novamente em %d ms.", TOP_SAMPLE_PERIOD_MS);
+        return 0;
+    }
+
+    shell_print(shell, "Carga de CPU     |   1s   |  10s   |  60s");
+    shell_print(shell, "-----------------|--------|--------|-------");
+
+    uint32_t load[TOP_NUM_WINDOWS];
+    for (uint8_t w = 0; w < TOP_NUM_WINDOWS; w++)
+    {
+        load[w] = 1000U - per_mille(windows[w].idle_cycles, windows[w].all_cycles);
+    }
+    shell_print(shell, "%-16s | %3u.%u%% | %3u.%u%% | %3u.%u%%", "total",
+                load[0] / 10U, load[0] % 10U, load[1] / 10U, load[1] % 10U,
+                load[2] / 10U, load[2] % 10U);
+
+#ifdef CONFIG_CPU_LOAD
+    for (uint8_t w = 0; w < TOP_NUM_WINDOWS; w++)
+    {
+        load[w] = (uint32_t)(windows[w].cpu_load_sum / windows[w].samples);
+    }
+    shell_print(shell, "%-16s | %3u.%u%% | %3u.%u%% | %3u.%u%%", "total (cpu_load)",
+                load[0] / 10U, load[0] % 10U, load[1] / 10U, load[1] % 10U,
+                load[2] / 10U, load[2] % 10U);
+#endif
+
+    shell_print(shell, "-----------------|--------|--------|-------");
+
+    for (uint8_t t = 0; t < count; t++)
+    {
+        for (uint8_t w = 0; w < TOP_NUM_WINDOWS; w++)
+        {
+            load[w] = per_mille(windows[w].thread_cycles[t], windows[w].all_cycles);
+        }
+        shell_print(shell, "%-16s | %3u.%u%% | %3u.%u%% | %3u.%u%%", names[t],
+                    load[0] / 10U, load[0] % 10U, load[1] / 10U, load[1] % 10U,
+                    load[2] / 10U, load[2] % 10U);
+    }
+
+    shell_print(shell, "Janelas com %u/%u/%u amostras de %d ms.", windows[0].samples,
+                windows[1].samples, windows[2].samples, TOP_SAMPLE_PERIOD_MS);
+
+    return 0;
+}
+
+SHELL_CMD_REGISTER(top, NULL, "Carga de CPU total e por tarefa (1 s, 10 s, 60 s)", cmd_top);
@@ -0,0 +1,19 @@
+/*
+ * Amostrador de carga de CPU no estilo do 'top'.
+ *
+ * Um item de trabalho da system workqueue acorda a cada TOP_SAMPLE_PERIOD_MS,
+ * lê os ciclos de cada thread (CONFIG_SCHED_THREAD_USAGE) e a carga medida
+ * pelo cpu_load (ganchos do idle) e guarda os deltas em um histórico
+ * circular. O comando 'top' só lê o histórico, sem percorrer as threads.
+ */
+
+#ifndef CPU_TOP_H_
+#define CPU_TOP_H_
+
+#define TOP_SAMPLE_PERIOD_MS 1000
+#define TOP_HISTORY_LEN 60 // amostras guardadas (maior janela = 60 s)
+
+/* Inicia a amostragem periódica. */
+void cpu_top_start(void);
+
+#endif /* CPU_TOP_H_ */
@@ -0,0 +1,249 @@
+/*
+ * Benchmark e verificação dos kernels em ponto fixo (filter_q15).
+ *
+ * 'dsp bench' mede ciclos por amostra das versões escalar e SIMD de cada
+ * kernel para vários tamanhos; 'dsp check' confere que as duas produzem a
+ * mesma saída bit a bit. Os mesmos comandos rodam na placa e no native_sim
+ * (onde a versão SIMD é a escalar).
+ */
+
+#include "filter.h"
+#include "filter_q15.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SAMPLES 256
+#define BENCH_RUNS 4 // a menor medida descarta preempções durante o teste
+
+static const uint16_t bench_taps[] = {8, 16, 32, 64};
+static const uint16_t bench_sections[] = {1, 2, 4};
+
+static int32_t bench_in[BENCH_SAMPLES];
+static int32_t out_scalar[BENCH_SAMPLES];
+static int32_t out_simd[BENCH_SAMPLES];
+static int16_t coeffs[FILTER_Q15_COEFFS];
+static int16_t state_scalar[2 * FILTER_Q15_MAX_TAPS];
+static int16_t state_simd[2 * FILTER_Q15_MAX_TAPS];
+static uint32_t lcg_state;
+
+/* Os buffers de teste são compartilhados por bench e check. */
+K_MUTEX_DEFINE(bench_lock);
+
+static uint32_t lcg_next(void)
+{
+    lcg_state = lcg_state * 1664525U + 1013904223U;
+    return lcg_state >> 16;
+}
+
+/* Entrada de 12 bits como a do ADC, com saltos para exercitar a saturação. */
+static void fill_input(uint32_t seed)
+{
+    lcg_state = seed;
+    for (size_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        bench_in[i] = (i % 64U) == 63U ? 32767 : (int32_t)(lcg_next() & 0xFFFU);
+    }
+}
+
+static void fill_coeffs(size_t count)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        coeffs[k] = (int16_t)lcg_next();
+    }
+}
+
+/* Coeficientes de biquad estáveis (passa-baixas) para que a saída não sature toda. */
+static void fill_biquad_coeffs(uint16_t sections)
+{
+    static const float lowpass[FILTER_BIQUAD_COEFFS] = {0.0675f, 0.135f, 0.0675f, -1.143f, 0.4128f};
+
+    for (uint16_t s = 0; s < sections; s++)
+    {
+        q15_biquad_coeffs(lowpass, &coeffs[s * Q15_BIQUAD_COEFFS]);
+        coeffs[s * Q15_BIQUAD_COEFFS] += (int16_t)(lcg_next() & 0xFFU);
+    }
+}
+
+typedef void (*fir_kernel)(const int16_t *, uint16_t, int16_t *, uint16_t *, int32_t *, size_t);
+typedef void (*biquad_kernel)(const int16_t *, uint16_t, int16_t *, int32_t *, size_t);
+
+static uint32_t time_fir(fir_kernel kernel, uint16_t taps, int16_t *state, int32_t *out)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int run = 0; run < BENCH_RUNS; run++)
+    {
+        uint16_t index = 0;
+
+        memset(state, 0, sizeof(state_scalar));
+        memcpy(out, bench_in, sizeof(bench_in));
+
+        uint32_t start = k_cycle_get_32();
+        kernel(coeffs, taps, state, &index, out, BENCH_SAMPLES);
+        best = MIN(best, k_cycle_get_32() - start);
+    }
+
+    return best;
+}
+
+static uint32_t time_biquad(biquad_kernel kernel, uint16_t sections, int16_t *state, int32_t *out)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int run = 0; run < BENCH_RUNS; run++)
+    {
+        memset(state, 0, sizeof(state_scalar));
+        memcpy(out, bench_in, sizeof(bench_in));
+
+        uint32_t start = k_cycle_get_32();
+        kernel(coeffs, sections, state, out, BENCH_SAMPLES);
+        best = MIN(best, k_cycle_get_32() - start);
+    }
+
+    return best;
+}
+
+static bool outputs_match(void)
+{
+    return memcmp(out_scalar, out_simd, sizeof(out_scalar)) == 0;
+}
+
+/* Ciclos por amostra em décimos. */
+static uint32_t per_sample_x10(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 10U) / BENCH_SAMPLES);
+}
+
+static void print_result(const struct shell *shell, const char *name, uint16_t size,
+                         uint32_t scalar, uint32_t simd)
+{
+    uint32_t a = per_sample_x10(scalar);
+    uint32_t b = per_sample_x10(simd);
+
+    shell_print(shell, "%-7s %5u | %6u.%u | %6u.%u | %s", name, size, a / 10U, a % 10U,
+                b / 10U, b % 10U, outputs_match() ? "sim" : "NÃO");
+}
+
+static int cmd_dsp_bench(const struct shell *shell, size_t argc, char **argv)
+{
+    k_mutex_lock(&bench_lock, K_FOREVER);
+
+    fill_input(1U);
+
+    shell_print(shell, "Ciclos por amostra (%d amostras, SIMD %s)", BENCH_SAMPLES,
+                FILTER_Q15_HAS_SIMD ? "SMLALD" : "indisponível: usa o escalar");
+    shell_print(shell, "kernel  tamanho | escalar  |   SIMD   | idênticos");
+
+    for (size_t i = 0U; i < ARRAY_SIZE(bench_taps); i++)
+    {
+        fill_coeffs(bench_taps[i]);
+        uint32_t scalar = time_fir(q15_fir_scalar, bench_taps[i], state_scalar, out_scalar);
+        uint32_t simd = time_fir(q15_fir_simd, bench_taps[i], state_simd, out_simd);
+
+        print_result(shell, "fir", bench_taps[i], scalar, simd);
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(bench_sections); i++)
+    {
+        fill_biquad_coeffs(bench_sections[i]);
+        uint32_t scalar = time_biquad(q15_biquad_scalar, bench_sections[i], state_scalar, out_scalar);
+        uint32_t simd = time_biquad(q15_biquad_simd, bench_sections[i], state_simd, out_simd);
+
+        print_result(shell, "biquad", bench_sections[i], scalar, simd);
+    }
+
+    k_mutex_unlock(&bench_lock);
+
+    return 0;
+}
+
+/*
+ * Compara escalar e SIMD para todos os tamanhos suportados, com coeficientes
+ * aleatórios e a saída processada em pedaços de tamanhos diferentes (o estado
+ * precisa continuar entre chamadas). Retorna o número de divergências.
+ */
+static int dsp_check(void)
+{
+    int failures = 0;
+
+    k_mutex_lock(&bench_lock, K_FOREVER);
+
+    for (uint16_t taps = 1U; taps <= FILTER_MAX_TAPS; taps++)
+    {
+        uint16_t index_scalar = 0;
+        uint16_t index_simd = 0;
+
+        fill_input(taps);
+        fill_coeffs(q15_fir_taps(taps));
+        memset(state_scalar, 0, sizeof(state_scalar));
+        memset(state_simd, 0, sizeof(state_simd));
+        memcpy(out_scalar, bench_in, sizeof(bench_in));
+        memcpy(out_simd, bench_in, sizeof(bench_in));
+
+        q15_fir_scalar(coeffs, taps, state_scalar, &index_scalar, out_scalar, BENCH_SAMPLES);
+        q15_fir_simd(coeffs, taps, state_simd, &index_simd, out_simd, 100);
+        q15_fir_simd(coeffs, taps, state_simd, &index_simd, &out_simd[100], BENCH_SAMPLES - 100);
+
+        if (!outputs_match())
+        {
+            printk("dsp check: FIR com %u taps diverge\n", taps);
+            failures++;
+        }
+    }
+
+    for (uint16_t sections = 1U; sections <= FILTER_MAX_BIQUADS; sections++)
+    {
+        fill_input(1000U + sections);
+        fill_biquad_coeffs(sections);
+        memset(state_scalar, 0, sizeof(state_scalar));
+        memset(state_simd, 0, sizeof(state_simd));
+        memcpy(out_scalar, bench_in, sizeof(bench_in));
+        memcpy(out_simd, bench_in, sizeof(bench_in));
+
+        q15_biquad_scalar(coeffs, sections, state_scalar, out_scalar, BENCH_SAMPLES);
+        q15_biquad_simd(coeffs, sections, state_simd, out_simd, 100);
+        q15_biquad_simd(coeffs, sections, state_simd, &out_simd[100], BENCH_SAMPLES - 100);
+
+        if (!outputs_match())
+        {
+            printk("dsp check: biquad com %u seções diverge\n", sections);
+            failures++;
+        }
+    }
+
+    k_mutex_unlock(&bench_lock);
+
+    printk("dsp check: %s (%d divergências, %s)\n", failures == 0 ? "OK" : "FALHOU", failures,
+           FILTER_Q15_HAS_SIMD ? "SIMD" : "sem SIMD: escalar contra escalar");
+
+    return failures;
+}
+
+static int cmd_dsp_check(const struct shell *shell, size_t argc, char **argv)
+{
+    return dsp_check() == 0 ? 0 : -EIO;
+}
+
+#ifdef CONFIG_APP_DSP_SELFTEST
+static int dsp_selftest(void)
+{
+    (void)dsp_check();
+    return 0;
+}
+
+SYS_INIT(dsp_selftest, APPLICATION, 99);
+#endif
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_dsp,
+    SHELL_CMD(bench, NULL, "Ciclos por amostra dos kernels escalar e SIMD", cmd_dsp_bench),
+    SHELL_CMD(check, NULL, "Confere que escalar e SIMD dão a mesma saída", cmd_dsp_check),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(dsp, &sub_dsp, "Kernels de filtro em ponto fixo (Q15)", NULL);
@@ -0,0 +1,270 @@
+#include "edf.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct edf_task *tasks[EDF_MAX_TASKS];
+static uint8_t task_count;
+static struct k_spinlock lock;
+
+/* Densidade em centésimos de por cento, trocando os parâmetros de 'task'
+ * pelos informados. */
+static uint32_t density_bp(const struct edf_task *task, uint32_t deadline_us,
+                           uint32_t wcet_us)
+{
+    uint64_t total = 0U;
+
+    for (uint8_t i = 0U; i < task_count; i++)
+    {
+        const struct edf_task *t = tasks[i];
+        uint32_t c_us = (uint32_t)k_cyc_to_us_ceil64(t->wcet_cyc);
+        uint32_t d_us = t->deadline_us;
+
+        if (t == task)
+        {
+            c_us = wcet_us > 0U ? wcet_us : c_us;
+            d_us = deadline_us;
+        }
+        total += (uint64_t)c_us * 10000U / d_us;
+    }
+
+    return (uint32_t)MIN(total, UINT32_MAX);
+}
+
+int edf_register(struct edf_task *task, const char *name, uint32_t period_us,
+                 uint32_t deadline_us)
+{
+    if (deadline_us == 0U || deadline_us > period_us)
+    {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (task_count >= EDF_MAX_TASKS)
+    {
+        k_spin_unlock(&lock, key);
+        return -ENOMEM;
+    }
+
+    task->name = name;
+    task->tid = k_current_get();
+    task->period_us = period_us;
+    task->deadline_us = deadline_us;
+    task->wcet_cyc = 0U;
+    task->jobs = 0U;
+    task->misses = 0U;
+    task->last_slack_us = 0;
+    task->min_slack_us = INT32_MAX;
+    tasks[task_count++] = task;
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+int edf_admit(const struct edf_task *task, uint32_t period_us, uint32_t deadline_us,
+              uint32_t wcet_us)
+{
+    if (deadline_us == 0U || deadline_us > period_us)
+    {
+        return -EINVAL;
+    }
+
+#ifdef CONFIG_APP_EDF
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t density = density_bp(task, deadline_us, wcet_us);
+
+    k_spin_unlock(&lock, key);
+
+    if (density > EDF_UTIL_LIMIT_PCT * 100U)
+    {
+        return -E2BIG;
+    }
+#else
+    ARG_UNUSED(task);
+    ARG_UNUSED(wcet_us);
+#endif
+
+    return 0;
+}
+
+/* Prazo que mantém a razão prazo/período de 'task' com 'period_us'. */
+static uint32_t scaled_deadline(const struct edf_task *task, uint32_t period_us)
+{
+    if (task->period_us == 0U)
+    {
+        return period_us; // ainda não registrada: prazo igual ao período
+    }
+
+    return (uint32_t)MAX((uint64_t)task->deadline_us * period_us / task->period_us, 1U);
+}
+
+int edf_admit_period(const struct edf_task *task, uint32_t period_us, uint32_t wcet_us)
+{
+    if (period_us == 0U)
+    {
+        return -EINVAL;
+    }
+
+    return edf_admit(task, period_us, scaled_deadline(task, period_us), wcet_us);
+}
+
+int edf_set_period(struct edf_task *task, uint32_t period_us, bool check)
+{
+    if (period_us == 0U)
+    {
+        return -EINVAL;
+    }
+
+    uint32_t deadline_us = scaled_deadline(task, period_us);
+
+    if (check)
+    {
+        int err = edf_admit(task, period_us, deadline_us, 0U);
+
+        if (err < 0)
+        {
+            return err;
+        }
+    }
+
+    /* O prazo é lido pela própria tarefa no próximo edf_job_start(). */
+    task->period_us = period_us;
+    task->deadline_us = deadline_us;
+
+    return 0;
+}
+
+int edf_set_deadline(struct edf_task *task, uint32_t deadline_us)
+{
+    int err = edf_admit(task, task->period_us, deadline_us, 0U);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    task->deadline_us = deadline_us;
+    task->min_slack_us = INT32_MAX;
+    task->misses = 0U;
+
+    return 0;
+}
+
+void edf_job_start(struct edf_task *task, uint32_t release_cyc)
+{
+    task->deadline_cyc = release_cyc + (uint32_t)k_us_to_cyc_ceil32(task->deadline_us);
+
+#ifdef CONFIG_APP_EDF
+    /* O kernel recebe o prazo relativo ao instante atual. */
+    int32_t remaining = (int32_t)(task->deadline_cyc - k_cycle_get_32());
+
+    k_thread_deadline_set(task->tid, MAX(remaining, 1));
+#endif
+}
+
+bool edf_job_end(struct edf_task *task, uint32_t start_cyc, uint32_t end_cyc)
+{
+    int32_t slack_cyc = (int32_t)(task->deadline_cyc - end_cyc);
+    int32_t slack_us = slack_cyc >= 0 ? (int32_t)k_cyc_to_us_floor32(slack_cyc) :
+                                        -(int32_t)k_cyc_to_us_ceil32(-slack_cyc);
+
+    task->wcet_cyc = MAX(task->wcet_cyc, end_cyc - start_cyc);
+    task->jobs++;
+    task->last_slack_us = slack_us;
+    task->min_slack_us = MIN(task->min_slack_us, slack_us);
+    if (slack_cyc < 0)
+    {
+        task->misses++;
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t edf_density_pct(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t density = density_bp(NULL, 0U, 0U);
+
+    k_spin_unlock(&lock, key);
+
+    return density / 100U;
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_edf_show(const struct shell *shell, size_t argc, char **argv)
+{
+    uint32_t density = edf_density_pct();
+
+#ifdef CONFIG_APP_EDF
+    shell_print(shell, "Modo: EDF (prioridade %d), densidade %u%% de %d%%", EDF_PRIORITY,
+                density, EDF_UTIL_LIMIT_PCT);
+#else
+    shell_print(shell, "Modo: prioridades fixas, densidade %u%%", density);
+#endif
+    shell_print(shell, "%-12s %10s %10s %8s %10s %10s %8s", "Tarefa", "Período", "Prazo",
+                "WCET", "Folga", "Folga min", "Perdas");
+
+    for (uint8_t i = 0U; i < task_count; i++)
+    {
+        const struct edf_task *t = tasks[i];
+
+        shell_print(shell, "%-12s %8u us %8u us %5u us %7d us %7d us %8u", t->name,
+                    t->period_us, t->deadline_us, k_cyc_to_us_ceil32(t->wcet_cyc),
+                    t->last_slack_us, t->jobs > 0U ? t->min_slack_us : 0, t->misses);
+    }
+
+    return 0;
+}
+
+static int cmd_edf_deadline(const struct shell *shell, size_t argc, char **argv)
+{
+    struct edf_task *task = NULL;
+    char *end;
+    long deadline_us = strtol(argv[2], &end, 10);
+
+    for (uint8_t i = 0U; i < task_count; i++)
+    {
+        if (strcmp(tasks[i]->name, argv[1]) == 0)
+        {
+            task = tasks[i];
+        }
+    }
+
+    if (task == NULL)
+    {
+        shell_print(shell, "Tarefa desconhecida: %s", argv[1]);
+        return -ENOENT;
+    }
+
+    if (end == argv[2] || *end != '\0' || deadline_us <= 0 ||
+        (uint32_t)deadline_us > task->period_us)
+    {
+        shell_print(shell, "Prazo inválido: de 1 a %u us (período).", task->period_us);
+        return -EINVAL;
+    }
+
+    int err = edf_set_deadline(task, (uint32_t)deadline_us);
+
+    if (err == -E2BIG)
+    {
+        shell_print(shell, "Recusado: densidade passaria de %d%% com os WCET medidos.",
+                    EDF_UTIL_LIMIT_PCT);
+        return err;
+    }
+
+    shell_print(shell, "Prazo de %s: %ld us", task->name, deadline_us);
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_edf,
+    SHELL_CMD(show, NULL, "Período, prazo, WCET, folga e perdas", cmd_edf_show),
+    SHELL_CMD_ARG(deadline, NULL, "Prazo relativo: deadline <tarefa> <us>", cmd_edf_deadline, 3, 0),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(edf, &sub_edf, "Prazos das tarefas de tempo real (EDF)", cmd_edf_show);
@@ -0,0 +1,74 @@
+/*
+ * Prazos das tarefas periódicas e modo EDF (earliest deadline first).
+ *
+ * Cada tarefa de tempo real declara o período e o prazo relativo. A cada
+ * liberação ela chama edf_job_start() com o instante da liberação e, ao
+ * terminar, edf_job_end(); o módulo mede o pior tempo de execução (WCET),
+ * a folga até o prazo e os prazos perdidos.
+ *
+ * Com CONFIG_APP_EDF as tarefas registradas rodam todas na prioridade
+ * EDF_PRIORITY e edf_job_start() renova o prazo absoluto da thread com
+ * k_thread_deadline_set(); entre threads de mesma prioridade o kernel
+ * executa a de prazo mais próximo (CONFIG_SCHED_DEADLINE). Trocas de
+ * período ou prazo passam por um teste de admissão com os WCET medidos:
+ * a densidade soma(C / min(D, T)) não pode passar de EDF_UTIL_LIMIT_PCT.
+ * Sem CONFIG_APP_EDF as prioridades continuam fixas e o teste não é
+ * aplicado, mas prazos, folgas e perdas continuam sendo medidos.
+ */
+
+#ifndef EDF_H_
+#define EDF_H_
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+#define EDF_MAX_TASKS 4
+#define EDF_PRIORITY 3          // prioridade comum das tarefas no modo EDF
+#define EDF_UTIL_LIMIT_PCT 90   // o resto fica para ISRs, barramento e shell
+
+struct edf_task
+{
+    const char *name;
+    k_tid_t tid;
+    uint32_t period_us;
+    uint32_t deadline_us;  // prazo relativo à liberação (<= período)
+    uint32_t deadline_cyc; // prazo absoluto do job atual
+    uint32_t wcet_cyc;     // maior tempo de execução medido
+    uint32_t jobs;
+    uint32_t misses;
+    int32_t last_slack_us; // prazo - fim do último job
+    int32_t min_slack_us;
+};
+
+/* Registra a thread atual com período e prazo relativo em microssegundos.
+ * Retorna -EINVAL se o prazo for zero ou maior que o período e -ENOMEM se
+ * já houver EDF_MAX_TASKS tarefas. */
+int edf_register(struct edf_task *task, const char *name, uint32_t period_us,
+                 uint32_t deadline_us);
+
+/* Verifica se o conjunto continua escalonável com 'task' em 'period_us' e
+ * 'deadline_us' e WCET de 'wcet_us' (0 usa o medido). Retorna 0 ou -E2BIG. */
+int edf_admit(const struct edf_task *task, uint32_t period_us, uint32_t deadline_us,
+              uint32_t wcet_us);
+
+/* Como edf_admit(), com o prazo escalado para manter a razão prazo/período. */
+int edf_admit_period(const struct edf_task *task, uint32_t period_us, uint32_t wcet_us);
+
+/* Troca o período mantendo a razão prazo/período. Com 'check' passa pelo
+ * teste de admissão. */
+int edf_set_period(struct edf_task *task, uint32_t period_us, bool check);
+
+/* Troca o prazo relativo (1 us até o período), com teste de admissão. */
+int edf_set_deadline(struct edf_task *task, uint32_t deadline_us);
+
+/* Início de um job liberado em 'release_cyc' (k_cycle_get_32()). */
+void edf_job_start(struct edf_task *task, uint32_t release_cyc);
+
+/* Fim de um job que começou a executar em 'start_cyc'. Retorna true se o
+ * prazo foi perdido. */
+bool edf_job_end(struct edf_task *task, uint32_t start_cyc, uint32_t end_cyc);
+
+/* Densidade do conjunto atual em porcentagem. */
+uint32_t edf_density_pct(void);
+
+#endif /* EDF_H_ */
@@ -0,0 +1,174 @@
+#include "fft.h"
+
+#define FFT_TABLE_SIZE FFT_MAX_SIZE
+
+/* sin(2 * pi * i / FFT_TABLE_SIZE) em Q15, de 0 a pi/2. */
+static const int16_t sin_table[FFT_TABLE_SIZE / 4 + 1] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2411, 2611, 2811, 3012, 3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6787, 6983,
+    7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+    9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269, 15447, 15624, 15800, 15976,
+    16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001,
+    20160, 20318, 20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312, 23453, 23593,
+    23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674,
+    26791, 26906, 27020, 27133, 27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+    29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050,
+    31114, 31177, 31238, 31298, 31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251,
+    32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753,
+    32758, 32762, 32766, 32767, 32767,
+};
+
+/* sin(2 * pi * i / FFT_TABLE_SIZE) para qualquer i. */
+static int32_t sin_index(uint32_t i)
+{
+    const uint32_t quarter = FFT_TABLE_SIZE / 4U;
+    uint32_t r = i % quarter;
+
+    switch ((i / quarter) & 3U)
+    {
+    case 0:
+        return sin_table[r];
+    case 1:
+        return sin_table[quarter - r];
+    case 2:
+        return -sin_table[r];
+    default:
+        return -sin_table[quarter - r];
+    }
+}
+
+static inline int32_t cos_index(uint32_t i)
+{
+    return sin_index(i + FFT_TABLE_SIZE / 4U);
+}
+
+static inline int32_t mul_q15(int32_t a, int32_t w)
+{
+    return (int32_t)(((int64_t)a * w + (1 << 14)) >> 15);
+}
+
+bool fft_size_valid(uint16_t n)
+{
+    return n >= FFT_MIN_SIZE && n <= FFT_MAX_SIZE && (n & (n - 1U)) == 0U;
+}
+
+int32_t fft_hann_q15(uint16_t i, uint16_t n)
+{
+    /* (1 - cos(2 * pi * i / n)) / 2 */
+    return (32768 - cos_index((uint32_t)i * (FFT_TABLE_SIZE / n))) / 2;
+}
+
+void fft_complex(int32_t *data, uint16_t n)
+{
+    /* Reordenação por bits invertidos. */
+    for (uint16_t i = 1U, j = 0U; i < n; i++)
+    {
+        uint16_t bit = n >> 1;
+
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j)
+        {
+            int32_t re = data[2 * i];
+            int32_t im = data[2 * i + 1];
+
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    for (uint16_t len = 2U; len <= n; len <<= 1)
+    {
+        const uint16_t half = len / 2U;
+        const uint32_t step = FFT_TABLE_SIZE / len;
+
+        for (uint16_t j = 0U; j < half; j++)
+        {
+            /* W = exp(-2 * pi * i * j / len) */
+            const int32_t wr = cos_index(j * step);
+            const int32_t wi = -sin_index(j * step);
+
+            for (uint16_t i = j; i < n; i += len)
+            {
+                int32_t *u = &data[2 * i];
+                int32_t *v = &data[2 * (i + half)];
+                int32_t tr = mul_q15(v[0], wr) - mul_q15(v[1], wi);
+                int32_t ti = mul_q15(v[1], wr) + mul_q15(v[0], wi);
+
+                v[0] = u[0] - tr;
+                v[1] = u[1] - ti;
+                u[0] += tr;
+                u[1] += ti;
+            }
+        }
+    }
+}
+
+uint32_t fft_isqrt64(uint64_t value)
+{
+    uint64_t root = 0U;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0U)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+void fft_real_magnitude(int32_t *x, uint16_t n, uint32_t *mag)
+{
+    const uint16_t m = n / 2U;
+
+    /* z[k] = x[2k] + j * x[2k + 1] já está intercalado em 'x'. */
+    fft_complex(x, m);
+
+    for (uint16_t k = 0U; k <= m; k++)
+    {
+        const uint16_t a = k % m;
+        const uint16_t b = (m - k) % m;
+        const int64_t ar = x[2 * a];
+        const int64_t ai = x[2 * a + 1];
+        const int64_t br = x[2 * b];
+        const int64_t bi = x[2 * b + 1];
+        const int64_t c = cos_index((uint32_t)k * (FFT_TABLE_SIZE / n));
+        const int64_t s = sin_index((uint32_t)k * (FFT_TABLE_SIZE / n));
+
+        /* 2 * X[k] = (Z[k] + conj(Z[m-k])) - j * W^k * (Z[k] - conj(Z[m-k])) */
+        int64_t re = (ar + br) + ((c * (ai + bi) + s * (br - ar)) >> 15);
+        int64_t im = (ai - bi) + ((c * (br - ar) - s * (ai + bi)) >> 15);
+
+        mag[k] = fft_isqrt64((uint64_t)(re * re + im * im)) / 2U;
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * FFT real em ponto fixo para análise espectral.
+ *
+ * Radix-2 com dados int32 e fatores de giro Q15 de uma tabela de um quarto
+ * de onda. Uma FFT real de N pontos é feita como uma FFT complexa de N/2
+ * pontos seguida da separação das partes par e ímpar. Com amostras de 16
+ * bits o crescimento de até log2(N) bits cabe em int32 sem escala por
+ * estágio.
+ *
+ * Este módulo não depende do kernel para poder ser compilado no host.
+ */
+
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FFT_MIN_SIZE 16
+#define FFT_MAX_SIZE 1024
+
+/* true se 'n' é potência de 2 entre FFT_MIN_SIZE e FFT_MAX_SIZE. */
+bool fft_size_valid(uint16_t n);
+
+/* Peso da janela de Hann na posição 'i' de 'n', em Q15. */
+int32_t fft_hann_q15(uint16_t i, uint16_t n);
+
+/* FFT complexa de 'n' pontos no próprio buffer (re, im intercalados). */
+void fft_complex(int32_t *data, uint16_t n);
+
+/*
+ * Módulo do espectro de 'n' amostras reais. 'x' é usado como área de
+ * trabalho e perde o conteúdo. 'mag' recebe n/2 + 1 valores, do DC até
+ * Nyquist. Para uma senoide de amplitude A janelada com Hann, o pico vale
+ * cerca de A * n / 4.
+ */
+void fft_real_magnitude(int32_t *x, uint16_t n, uint32_t *mag);
+
+/* Raiz quadrada inteira (piso). */
+uint32_t fft_isqrt64(uint64_t value);
+
+#endif /* FFT_H_ */
@@ -0,0 +1,296 @@
+#include "filter.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifndef CONFIG_APP_FILTER_Q15
+static inline int32_t round_to_int(float value)
+{
+    return (int32_t)(value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+#endif
+
+int filter_config_validate(const struct filter_config *cfg)
+{
+    if (cfg->num_stages == 0 || cfg->num_stages > FILTER_MAX_STAGES)
+    {
+        return -EINVAL;
+    }
+
+    for (uint8_t s = 0; s < cfg->num_stages; s++)
+    {
+        const struct filter_stage_cfg *stage = &cfg->stages[s];
+
+        switch (stage->type)
+        {
+        case FILTER_STAGE_MAVG:
+        case FILTER_STAGE_FIR:
+            if (stage->len == 0 || stage->len > FILTER_MAX_TAPS)
+            {
+                return -EINVAL;
+            }
+            break;
+        case FILTER_STAGE_BIQUAD:
+            if (stage->len == 0 || stage->len > FILTER_MAX_BIQUADS)
+            {
+                return -EINVAL;
+            }
+            break;
+        default:
+            return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+/* Converte os coeficientes de FIR e biquad para os kernels em ponto fixo. */
+static void prepare_q15(struct filter_config *cfg)
+{
+    for (uint8_t s = 0; s < cfg->num_stages; s++)
+    {
+        struct filter_stage_cfg *stage = &cfg->stages[s];
+
+        if (stage->type == FILTER_STAGE_FIR)
+        {
+            q15_fir_coeffs(stage->coeffs, stage->len, stage->q15);
+        }
+        else if (stage->type == FILTER_STAGE_BIQUAD)
+        {
+            for (uint16_t b = 0; b < stage->len; b++)
+            {
+                q15_biquad_coeffs(&stage->coeffs[b * FILTER_BIQUAD_COEFFS],
+                                  &stage->q15[b * Q15_BIQUAD_COEFFS]);
+            }
+        }
+    }
+}
+
+int filter_chain_init(struct filter_chain *chain, const struct filter_config *cfg)
+{
+    int err = filter_config_validate(cfg);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    memset(chain, 0, sizeof(*chain));
+    chain->banks[0] = *cfg;
+    prepare_q15(&chain->banks[0]);
+
+    return 0;
+}
+
+int filter_chain_load(struct filter_chain *chain, const struct filter_config *cfg)
+{
+    int err = filter_config_validate(cfg);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    if (__atomic_load_n(&chain->pending, __ATOMIC_ACQUIRE) != 0)
+    {
+        return -EBUSY;
+    }
+
+    /* O banco inativo não é lido pela thread de processamento enquanto
+     * 'pending' estiver em zero. */
+    uint8_t inactive = __atomic_load_n(&chain->active, __ATOMIC_ACQUIRE) ^ 1U;
+
+    chain->banks[inactive] = *cfg;
+    prepare_q15(&chain->banks[inactive]);
+    __atomic_store_n(&chain->pending, 1U, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+bool filter_chain_sync(struct filter_chain *chain)
+{
+    if (__atomic_load_n(&chain->pending, __ATOMIC_ACQUIRE) == 0)
+    {
+        return false;
+    }
+
+    const struct filter_config *old = &chain->banks[chain->active];
+    const struct filter_config *new = &chain->banks[chain->active ^ 1U];
+
+    /* Estágios com o mesmo tipo e tamanho mantêm o estado (troca sem
+     * transitório); os demais recomeçam do zero. */
+    for (uint8_t s = 0; s < FILTER_MAX_STAGES; s++)
+    {
+        if (s >= old->num_stages || s >= new->num_stages ||
+            old->stages[s].type != new->stages[s].type ||
+            old->stages[s].len != new->stages[s].len)
+        {
+            memset(&chain->state[s], 0, sizeof(chain->state[s]));
+        }
+    }
+
+    __atomic_store_n(&chain->active, chain->active ^ 1U, __ATOMIC_RELEASE);
+    __atomic_store_n(&chain->pending, 0U, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+const struct filter_config *filter_chain_config(const struct filter_chain *chain)
+{
+    return &chain->banks[__atomic_load_n(&chain->active, __ATOMIC_ACQUIRE)];
+}
+
+/* Média móvel por soma corrente: uma soma e uma subtração por amostra. */
+static void process_mavg(const struct filter_stage_cfg *cfg,
+                         struct filter_stage_state *st, int32_t *buf, size_t n)
+{
+    int32_t sum = st->mavg.sum;
+    uint16_t index = st->mavg.index;
+    const int32_t len = cfg->len;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += buf[i] - st->mavg.history[index];
+        st->mavg.history[index] = buf[i];
+        if (++index >= len)
+        {
+            index = 0;
+        }
+        buf[i] = sum / len;
+    }
+
+    st->mavg.sum = sum;
+    st->mavg.index = index;
+}
+
+#ifndef CONFIG_APP_FILTER_Q15
+static void process_fir(const struct filter_stage_cfg *cfg,
+                        struct filter_stage_state *st, int32_t *buf, size_t n)
+{
+    const uint16_t taps = cfg->len;
+    uint16_t index = st->fir.index;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        float acc = 0.0f;
+        uint16_t k = 0;
+
+        st->fir.history[index] = (float)buf[i];
+
+        /* history[index] é x[n]; percorre para trás sem usar módulo. */
+        for (int32_t j = index; j >= 0; j--, k++)
+        {
+            acc += cfg->coeffs[k] * st->fir.history[j];
+        }
+        for (int32_t j = taps - 1; k < taps; j--, k++)
+        {
+            acc += cfg->coeffs[k] * st->fir.history[j];
+        }
+
+        if (++index >= taps)
+        {
+            index = 0;
+        }
+        buf[i] = round_to_int(acc);
+    }
+
+    st->fir.index = index;
+}
+
+/* Cascata de biquads na forma direta II transposta. */
+static void process_biquad(const struct filter_stage_cfg *cfg,
+                           struct filter_stage_state *st, int32_t *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float x = (float)buf[i];
+
+        for (uint16_t s = 0; s < cfg->len; s++)
+        {
+            const float *c = &cfg->coeffs[s * FILTER_BIQUAD_COEFFS];
+            float *z = st->biquad.z[s];
+            float y = c[0] * x + z[0];
+
+            z[0] = c[1] * x - c[3] * y + z[1];
+            z[1] = c[2] * x - c[4] * y;
+            x = y;
+        }
+
+        buf[i] = round_to_int(x);
+    }
+}
+#endif /* CONFIG_APP_FILTER_Q15 */
+
+void filter_chain_process(struct filter_chain *chain, int32_t *buf, size_t n)
+{
+    const struct filter_config *cfg = &chain->banks[chain->active];
+
+    /* O despacho por tipo acontece uma vez por estágio e por bloco, não por amostra. */
+    for (uint8_t s = 0; s < cfg->num_stages; s++)
+    {
+        const struct filter_stage_cfg *stage = &cfg->stages[s];
+
+        switch (stage->type)
+        {
+        case FILTER_STAGE_MAVG:
+            process_mavg(stage, &chain->state[s], buf, n);
+            break;
+#ifdef CONFIG_APP_FILTER_Q15
+        case FILTER_STAGE_FIR:
+            q15_fir_simd(stage->q15, stage->len, chain->state[s].fir_q15.delay,
+                         &chain->state[s].fir_q15.index, buf, n);
+            break;
+        case FILTER_STAGE_BIQUAD:
+            q15_biquad_simd(stage->q15, stage->len, chain->state[s].biquad_q15.state, buf, n);
+            break;
+#else
+        case FILTER_STAGE_FIR:
+            process_fir(stage, &chain->state[s], buf, n);
+            break;
+        case FILTER_STAGE_BIQUAD:
+            process_biquad(stage, &chain->state[s], buf, n);
+            break;
+#endif
+        }
+    }
+}
+
+void filter_config_mavg(struct filter_config *cfg, uint16_t len)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_stages = 1;
+    cfg->stages[0].type = FILTER_STAGE_MAVG;
+    cfg->stages[0].len = len;
+}
+
+size_t cic_decimate(struct cic_state *st, uint8_t r_log2, uint8_t shift, int32_t *buf, size_t n)
+{
+    const uint16_t r = (uint16_t)(1U << r_log2);
+    uint32_t i0 = st->integrator[0];
+    uint32_t i1 = st->integrator[1];
+    size_t n_out = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        i0 += (uint32_t)buf[i];
+        i1 += i0;
+
+        if (++st->phase < r)
+        {
+            continue;
+        }
+        st->phase = 0;
+
+        uint32_t c0 = i1 - st->comb[0];
+        uint32_t c1 = c0 - st->comb[1];
+
+        st->comb[0] = i1;
+        st->comb[1] = c0;
+        buf[n_out++] = (int32_t)c1 >> shift;
+    }
+
+    st->integrator[0] = i0;
+    st->integrator[1] = i1;
+
+    return n_out;
+}
@@ -0,0 +1,154 @@
+/*
+ * Motor de filtros em streaming.
+ *
+ * Uma cadeia de filtros é formada por até FILTER_MAX_STAGES estágios em
+ * série: média móvel (soma corrente, custo O(1) por amostra), FIR com
+ * número arbitrário de taps e cascata de biquads IIR. Cada estágio guarda
+ * o próprio estado.
+ *
+ * Os coeficientes ficam em dois bancos. O shell escreve no banco inativo
+ * com filter_chain_load() e a tarefa de tempo real troca os bancos em
+ * filter_chain_sync(), na fronteira de bloco, sem parar o laço.
+ *
+ * Com CONFIG_APP_FILTER_Q15, FIR e biquad usam os kernels em ponto fixo de
+ * filter_q15.h. Os coeficientes são convertidos quando a configuração é
+ * carregada, fora da tarefa de tempo real.
+ *
+ * Este módulo não depende do kernel para poder ser compilado no host.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "filter_q15.h"
+
+/* Os limites dimensionam o estado de cada canal; no build da aplicação
+ * vêm do Kconfig. */
+#ifdef CONFIG_APP_FILTER_MAX_STAGES
+#define FILTER_MAX_STAGES CONFIG_APP_FILTER_MAX_STAGES
+#else
+#define FILTER_MAX_STAGES 4
+#endif
+#ifdef CONFIG_APP_FILTER_MAX_TAPS
+#define FILTER_MAX_TAPS CONFIG_APP_FILTER_MAX_TAPS
+#else
+#define FILTER_MAX_TAPS 64 // taps de FIR, janela de média móvel ou 5 * seções de biquad
+#endif
+#define FILTER_BIQUAD_COEFFS 5 // b0, b1, b2, a1, a2 (a0 normalizado em 1)
+#define FILTER_MAX_BIQUADS (FILTER_MAX_TAPS / FILTER_BIQUAD_COEFFS)
+/* q15_fir_taps(FILTER_MAX_TAPS) como constante: o FIR Q15 completa os taps
+ * até um número par. */
+#define FILTER_Q15_MAX_TAPS ((FILTER_MAX_TAPS + 1) & ~1)
+/* Cabe os taps de FIR ou as seções de biquad em Q15, o que for maior. */
+#define FILTER_Q15_COEFFS                                                                  \
+    (FILTER_MAX_BIQUADS * Q15_BIQUAD_COEFFS > FILTER_Q15_MAX_TAPS ?                        \
+         FILTER_MAX_BIQUADS * Q15_BIQUAD_COEFFS : FILTER_Q15_MAX_TAPS)
+
+enum filter_stage_type
+{
+    FILTER_STAGE_MAVG,
+    FILTER_STAGE_FIR,
+    FILTER_STAGE_BIQUAD,
+};
+
+/* Configuração (coeficientes) de um estágio. */
+struct filter_stage_cfg
+{
+    enum filter_stage_type type;
+    uint16_t len; // janela (MAVG), número de taps (FIR) ou de seções (BIQUAD)
+    float coeffs[FILTER_MAX_TAPS];
+    int16_t q15[FILTER_Q15_COEFFS]; // coeffs convertidos para os kernels em ponto fixo
+};
+
+struct filter_config
+{
+    uint8_t num_stages;
+    struct filter_stage_cfg stages[FILTER_MAX_STAGES];
+};
+
+/* Estado de um estágio. */
+struct filter_stage_state
+{
+    union
+    {
+        struct
+        {
+            int32_t history[FILTER_MAX_TAPS];
+            int32_t sum;
+            uint16_t index;
+        } mavg;
+        struct
+        {
+            float history[FILTER_MAX_TAPS];
+            uint16_t index;
+        } fir;
+        struct
+        {
+            float z[FILTER_MAX_BIQUADS][2];
+        } biquad;
+        struct
+        {
+            int16_t delay[2 * FILTER_Q15_MAX_TAPS];
+            uint16_t index;
+        } fir_q15;
+        struct
+        {
+            int16_t state[FILTER_MAX_BIQUADS * 4];
+        } biquad_q15;
+    };
+};
+
+struct filter_chain
+{
+    struct filter_config banks[2];
+    struct filter_stage_state state[FILTER_MAX_STAGES];
+    uint8_t active;  // banco em uso pela tarefa de tempo real
+    uint8_t pending; // 1 quando o banco inativo contém uma nova configuração
+};
+
+/* Valida uma configuração. Retorna 0 ou -EINVAL. */
+int filter_config_validate(const struct filter_config *cfg);
+
+/* Inicializa a cadeia com 'cfg' e zera o estado. */
+int filter_chain_init(struct filter_chain *chain, const struct filter_config *cfg);
+
+/* Publica uma nova configuração no banco inativo. Pode ser chamada de outra
+ * thread enquanto a cadeia processa amostras. Retorna -EBUSY se a troca
+ * anterior ainda não foi aplicada. */
+int filter_chain_load(struct filter_chain *chain, const struct filter_config *cfg);
+
+/* Aplica uma configuração pendente. Chamada pela thread que processa as
+ * amostras, entre blocos. Retorna true se houve troca. */
+bool filter_chain_sync(struct filter_chain *chain);
+
+/* Configuração em uso. */
+const struct filter_config *filter_chain_config(const struct filter_chain *chain);
+
+/* Filtra 'n' amostras de 'buf' no próprio buffer. */
+void filter_chain_process(struct filter_chain *chain, int32_t *buf, size_t n);
+
+/* Preenche 'cfg' com uma única média móvel de 'len' amostras. */
+void filter_config_mavg(struct filter_config *cfg, uint16_t len);
+
+/* Decimador CIC de ordem 2 (atraso diferencial 1) usado na sobreamostragem
+ * da entrada. Só somas e subtrações; a aritmética modular de 32 bits
+ * dispensa saturação nos integradores. */
+#define CIC_ORDER 2
+
+struct cic_state
+{
+    uint32_t integrator[CIC_ORDER];
+    uint32_t comb[CIC_ORDER];
+    uint16_t phase;
+};
+
+/* Decima 'n' amostras de 'buf' por 2^r_log2 no próprio buffer. O ganho do
+ * filtro é 2^(CIC_ORDER * r_log2); a saída é deslocada de 'shift' bits.
+ * Retorna o número de amostras de saída. */
+size_t cic_decimate(struct cic_state *st, uint8_t r_log2, uint8_t shift, int32_t *buf, size_t n);
+
+#endif /* FILTER_H_ */
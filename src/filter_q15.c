@@ -0,0 +1,200 @@
+#include "filter_q15.h"
+
+#include <string.h>
+
+#if FILTER_Q15_HAS_SIMD
+#include <arm_acle.h>
+#endif
+
+static inline int16_t sat16(int64_t value)
+{
+    return value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : (int16_t)value;
+}
+
+static int16_t float_to_q(float value, int shift)
+{
+    float scaled = value * (float)(1 << shift);
+
+    return sat16((int64_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f));
+}
+
+/* Arredonda o acumulador para o formato das amostras. */
+static inline int16_t round_shift(int64_t acc, int shift)
+{
+    return sat16((acc + (1 << (shift - 1))) >> shift);
+}
+
+void q15_fir_coeffs(const float *coeffs, uint16_t taps, int16_t *out)
+{
+    const uint16_t padded = q15_fir_taps(taps);
+
+    /* out[k] multiplica a k-ésima amostra mais antiga da janela. */
+    out[0] = 0;
+    for (uint16_t k = 0; k < taps; k++)
+    {
+        out[padded - 1U - k] = float_to_q(coeffs[k], Q15_FIR_SHIFT);
+    }
+}
+
+void q15_biquad_coeffs(const float *coeffs, int16_t *out)
+{
+    out[0] = float_to_q(coeffs[0], Q15_BIQUAD_SHIFT);
+    out[1] = 0;
+    out[2] = float_to_q(coeffs[1], Q15_BIQUAD_SHIFT);
+    out[3] = float_to_q(coeffs[2], Q15_BIQUAD_SHIFT);
+    out[4] = float_to_q(-coeffs[3], Q15_BIQUAD_SHIFT);
+    out[5] = float_to_q(-coeffs[4], Q15_BIQUAD_SHIFT);
+}
+
+/* Escreve a amostra nas duas metades da linha de atraso e devolve o início
+ * da janela (amostra mais antiga). */
+static inline const int16_t *fir_push(int16_t *delay, uint16_t taps, uint16_t *index, int16_t x)
+{
+    uint16_t i = *index;
+
+    delay[i] = x;
+    delay[i + taps] = x;
+    if (++i >= taps)
+    {
+        i = 0;
+    }
+    *index = i;
+
+    return &delay[i];
+}
+
+void q15_fir_scalar(const int16_t *coeffs, uint16_t taps, int16_t *delay,
+                    uint16_t *index, int32_t *buf, size_t n)
+{
+    taps = q15_fir_taps(taps);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const int16_t *x = fir_push(delay, taps, index, sat16(buf[i]));
+        int64_t acc = 0;
+
+        for (uint16_t k = 0; k < taps; k++)
+        {
+            acc += (int32_t)coeffs[k] * x[k];
+        }
+
+        buf[i] = round_shift(acc, Q15_FIR_SHIFT);
+    }
+}
+
+#if FILTER_Q15_HAS_SIMD
+
+/* Lê dois valores de 16 bits como uma palavra; o M4 aceita LDR desalinhado. */
+static inline int16x2_t load_pair(const int16_t *p)
+{
+    int16x2_t pair;
+
+    memcpy(&pair, p, sizeof(pair));
+    return pair;
+}
+
+void q15_fir_simd(const int16_t *coeffs, uint16_t taps, int16_t *delay,
+                  uint16_t *index, int32_t *buf, size_t n)
+{
+    taps = q15_fir_taps(taps);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const int16_t *x = fir_push(delay, taps, index, sat16(buf[i]));
+        int64_t acc = 0;
+
+        /* Dois produtos por instrução; o laço é desenrolado em quatro taps. */
+        uint16_t k = 0;
+        for (; k + 4U <= taps; k += 4U)
+        {
+            acc = __smlald(load_pair(&coeffs[k]), load_pair(&x[k]), acc);
+            acc = __smlald(load_pair(&coeffs[k + 2U]), load_pair(&x[k + 2U]), acc);
+        }
+        if (k < taps)
+        {
+            acc = __smlald(load_pair(&coeffs[k]), load_pair(&x[k]), acc);
+        }
+
+        buf[i] = round_shift(acc, Q15_FIR_SHIFT);
+    }
+}
+
+#else
+
+void q15_fir_simd(const int16_t *coeffs, uint16_t taps, int16_t *delay,
+                  uint16_t *index, int32_t *buf, size_t n)
+{
+    q15_fir_scalar(coeffs, taps, delay, index, buf, n);
+}
+
+#endif /* FILTER_Q15_HAS_SIMD */
+
+void q15_biquad_scalar(const int16_t *coeffs, uint16_t sections, int16_t *state,
+                       int32_t *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        int16_t x = sat16(buf[i]);
+
+        for (uint16_t s = 0; s < sections; s++)
+        {
+            const int16_t *c = &coeffs[s * Q15_BIQUAD_COEFFS];
+            int16_t *z = &state[s * 4U];
+            int64_t acc = (int32_t)c[0] * x;
+
+            acc += (int32_t)c[2] * z[0] + (int32_t)c[3] * z[1];
+            acc += (int32_t)c[4] * z[2] + (int32_t)c[5] * z[3];
+
+            int16_t y = round_shift(acc, Q15_BIQUAD_SHIFT);
+
+            z[1] = z[0];
+            z[0] = x;
+            z[3] = z[2];
+            z[2] = y;
+            x = y;
+        }
+
+        buf[i] = x;
+    }
+}
+
+#if FILTER_Q15_HAS_SIMD
+
+void q15_biquad_simd(const int16_t *coeffs, uint16_t sections, int16_t *state,
+                     int32_t *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        int16_t x = sat16(buf[i]);
+
+        for (uint16_t s = 0; s < sections; s++)
+        {
+            const int16_t *c = &coeffs[s * Q15_BIQUAD_COEFFS];
+            int16_t *z = &state[s * 4U];
+            int64_t acc = (int32_t)c[0] * x;
+
+            acc = __smlald(load_pair(&c[2]), load_pair(&z[0]), acc);
+            acc = __smlald(load_pair(&c[4]), load_pair(&z[2]), acc);
+
+            int16_t y = round_shift(acc, Q15_BIQUAD_SHIFT);
+
+            z[1] = z[0];
+            z[0] = x;
+            z[3] = z[2];
+            z[2] = y;
+            x = y;
+        }
+
+        buf[i] = x;
+    }
+}
+
+#else
+
+void q15_biquad_simd(const int16_t *coeffs, uint16_t sections, int16_t *state,
+                     int32_t *buf, size_t n)
+{
+    q15_biquad_scalar(coeffs, sections, state, buf, n);
+}
+
+#endif /* FILTER_Q15_HAS_SIMD */
@@ -0,0 +1,62 @@
+/*
+ * Kernels de filtro em ponto fixo (Q15) para FIR e biquad.
+ *
+ * As amostras são inteiros de 16 bits e os produtos são somados em um
+ * acumulador de 64 bits, sem saturação intermediária. Cada kernel tem uma
+ * versão escalar portável e uma versão com as instruções SIMD de 16 bits
+ * do Cortex-M4 (SMLALD). Como a soma é exata nas duas, a saída é idêntica
+ * bit a bit; sem a extensão DSP a versão SIMD é a própria escalar.
+ *
+ * Este módulo não depende do kernel para poder ser compilado no host.
+ */
+
+#ifndef FILTER_Q15_H_
+#define FILTER_Q15_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define FILTER_Q15_HAS_SIMD 1
+#else
+#define FILTER_Q15_HAS_SIMD 0
+#endif
+
+#define Q15_FIR_SHIFT 15    // coeficientes de FIR em Q15: [-1, 1)
+#define Q15_BIQUAD_SHIFT 13 // coeficientes de biquad em Q2.13: [-4, 4)
+#define Q15_BIQUAD_COEFFS 6 // b0, 0, b1, b2, -a1, -a2 (pares alinhados para SMLALD)
+
+/* FIRs são processados com um número par de taps; o tap extra tem
+ * coeficiente zero. */
+static inline uint16_t q15_fir_taps(uint16_t taps)
+{
+    return (uint16_t)((taps + 1U) & ~1U);
+}
+
+/* Converte 'taps' coeficientes para Q15 na ordem usada pelos kernels
+ * (invertida e completada até q15_fir_taps(taps)). */
+void q15_fir_coeffs(const float *coeffs, uint16_t taps, int16_t *out);
+
+/* Converte uma seção biquad (b0, b1, b2, a1, a2) para Q2.13. */
+void q15_biquad_coeffs(const float *coeffs, int16_t *out);
+
+/*
+ * FIR sobre 'n' amostras de 'buf', no próprio buffer. 'delay' é uma linha
+ * de atraso duplicada com 2 * q15_fir_taps(taps) posições, o que deixa a
+ * janela de amostras sempre contígua. '*index' é a posição de escrita.
+ */
+void q15_fir_scalar(const int16_t *coeffs, uint16_t taps, int16_t *delay,
+                    uint16_t *index, int32_t *buf, size_t n);
+void q15_fir_simd(const int16_t *coeffs, uint16_t taps, int16_t *delay,
+                  uint16_t *index, int32_t *buf, size_t n);
+
+/*
+ * Cascata de 'sections' biquads na forma direta I. 'state' guarda
+ * x[n-1], x[n-2], y[n-1], y[n-2] de cada seção (4 valores por seção).
+ */
+void q15_biquad_scalar(const int16_t *coeffs, uint16_t sections, int16_t *state,
+                       int32_t *buf, size_t n);
+void q15_biquad_simd(const int16_t *coeffs, uint16_t sections, int16_t *state,
+                     int32_t *buf, size_t n);
+
+#endif /* FILTER_Q15_H_ */
@@ -0,0 +1,375 @@
+/*
+ * Benchmark em malha fechada DAC -> ADC.
+ *
+ * 'bench sweep' liga a saída do gerador de sinais (siggen.h) ao canal 0 de
+ * io-channels (na placa, um fio de PA5 para PA1; no native_sim, o emulador
+ * do ADC) e, para cada taxa de saída pedida, mede:
+ *  - ruído: desvio padrão da entrada bruta e da saída do pipeline com o
+ *    DAC parado no meio da escala;
+ *  - latência: tempo do degrau no DAC até a primeira amostra bruta e a
+ *    primeira saída do pipeline que passam do meio do degrau;
+ *  - resposta em frequência: ganho RMS saída/entrada para senoides de 1% a
+ *    40% da taxa de saída.
+ * Os blocos chegam pelo barramento (assinante 'loop_sub'), com os instantes
+ * de cada amostra reconstruídos a partir de block->timestamp. A taxa e o
+ * gerador são restaurados no fim.
+ */
+
+#include "acquisition.h"
+#include "block_bus.h"
+#include "pipeline.h"
+#include "rate.h"
+#include "siggen.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define LOOP_CHANNEL 0          // canal de io-channels ligado ao gerador
+#define LOOP_MAX_RATES 8
+#define LOOP_MID_CODE 2048
+#define LOOP_STEP_LOW 1024
+#define LOOP_STEP_HIGH 3072
+#define LOOP_SINE_AMPLITUDE 1000
+#define LOOP_SETTLE_MS 50       // descarta o transitório dos filtros
+#define LOOP_NOISE_MS 500
+#define LOOP_STEP_TIMEOUT_MS 500
+#define LOOP_RATE_TIMEOUT_MS 1000
+#define LOOP_MIN_OUT_SAMPLES 256
+
+static const uint32_t default_rates_hz[] = {1000, 2000, 5000};
+
+/* Frequências de teste em milésimos da taxa de saída. */
+static const uint16_t sine_permille[] = {10, 20, 50, 100, 150, 200, 300, 400};
+
+BLOCK_SUBSCRIBER_DEFINE(loop_sub, 4);
+
+struct loop_acc
+{
+    uint32_t n_in;
+    uint32_t n_out;
+    int64_t sum_in;
+    int64_t sum_out;
+    uint64_t sq_in;
+    uint64_t sq_out;
+};
+
+static void drain(void)
+{
+    struct acq_block *block;
+
+    while (block_bus_get(&loop_sub, &block, K_NO_WAIT) == 0)
+    {
+        acq_release_block(block);
+    }
+}
+
+/* Espera os filtros assentarem com o gerador na nova saída. */
+static void settle(void)
+{
+    block_bus_set_active(&loop_sub, false);
+    k_sleep(K_MSEC(LOOP_SETTLE_MS));
+    drain();
+    block_bus_set_active(&loop_sub, true);
+}
+
+static void accumulate(struct loop_acc *acc, const struct acq_block *block)
+{
+    for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+    {
+        int32_t x = acq_sample(block, n, LOOP_CHANNEL);
+
+        acc->sum_in += x;
+        acc->sq_in += (uint64_t)((int64_t)x * x);
+    }
+    for (size_t k = 0U; k < block->n_out[LOOP_CHANNEL]; k++)
+    {
+        int32_t y = block->out[LOOP_CHANNEL][k];
+
+        acc->sum_out += y;
+        acc->sq_out += (uint64_t)((int64_t)y * y);
+    }
+    acc->n_in += ACQ_BLOCK_LEN;
+    acc->n_out += block->n_out[LOOP_CHANNEL];
+}
+
+static int collect(struct loop_acc *acc, uint32_t duration_ms)
+{
+    const int64_t end = k_uptime_get() + duration_ms;
+    struct acq_block *block;
+
+    *acc = (struct loop_acc){0};
+
+    while (k_uptime_get() < end)
+    {
+        if (block_bus_get(&loop_sub, &block, K_MSEC(100)) != 0)
+        {
+            return -ETIMEDOUT;
+        }
+        accumulate(acc, block);
+        acq_release_block(block);
+    }
+
+    return acc->n_in > 0U && acc->n_out > 0U ? 0 : -ENODATA;
+}
+
+static double variance(int64_t sum, uint64_t sq, uint32_t n)
+{
+    const double mean = (double)sum / n;
+
+    return MAX((double)sq / n - mean * mean, 0.0);
+}
+
+/* Desvios padrão em códigos do ADC; a saída perde os bits extras. */
+static void acc_rms(const struct loop_acc *acc, uint8_t extra_bits, double *rms_in,
+                    double *rms_out)
+{
+    *rms_in = sqrt(variance(acc->sum_in, acc->sq_in, acc->n_in));
+    *rms_out = sqrt(variance(acc->sum_out, acc->sq_out, acc->n_out)) / (1U << extra_bits);
+}
+
+/* Período de uma saída do pipeline do canal de teste, em ciclos. */
+static uint32_t out_interval_cyc(const struct rate_config *cfg)
+{
+    return k_us_to_cyc_floor32(cfg->interval_us << rate_osr_log2(cfg)) *
+           pipelines[LOOP_CHANNEL].decimation;
+}
+
+/* Degrau LOOP_STEP_LOW -> LOOP_STEP_HIGH. Os instantes das amostras são
+ * reconstruídos a partir do fim do bloco; os da saída têm a resolução de um
+ * período de saída. */
+static int measure_step(const struct rate_config *cfg, uint32_t *raw_us, uint32_t *out_us)
+{
+    const uint32_t out_cyc = out_interval_cyc(cfg);
+    const int64_t end = k_uptime_get() + LOOP_STEP_TIMEOUT_MS;
+    bool raw_seen = false;
+    bool out_seen = false;
+
+    (void)siggen_step(LOOP_STEP_LOW);
+    settle();
+
+    const uint32_t t0 = siggen_step(LOOP_STEP_HIGH);
+
+    while (!(raw_seen && out_seen) && k_uptime_get() < end)
+    {
+        struct acq_block *block;
+
+        if (block_bus_get(&loop_sub, &block, K_MSEC(100)) != 0)
+        {
+            continue;
+        }
+
+        const uint32_t in_cyc = k_us_to_cyc_floor32(block->interval_us);
+
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN && !raw_seen; n++)
+        {
+            uint32_t t = block->timestamp - (ACQ_BLOCK_LEN - 1U - n) * in_cyc;
+
+            if ((int32_t)(t - t0) >= 0 && acq_sample(block, n, LOOP_CHANNEL) >= LOOP_MID_CODE)
+            {
+                raw_seen = true;
+                *raw_us = k_cyc_to_us_floor32(t - t0);
+            }
+        }
+
+        const size_t n_out = block->n_out[LOOP_CHANNEL];
+
+        for (size_t k = 0U; k < n_out && !out_seen; k++)
+        {
+            uint32_t t = block->timestamp - (n_out - 1U - k) * out_cyc;
+
+            if ((int32_t)(t - t0) >= 0 &&
+                (block->out[LOOP_CHANNEL][k] >> cfg->extra_bits) >= LOOP_MID_CODE)
+            {
+                out_seen = true;
+                *out_us = k_cyc_to_us_floor32(t - t0);
+            }
+        }
+
+        acq_release_block(block);
+    }
+
+    return raw_seen && out_seen ? 0 : -ETIMEDOUT;
+}
+
+/* Pede a troca de taxa e espera a tarefa de tempo real aplicá-la. */
+static int apply_rate(const struct rate_config *cfg, bool check_budget)
+{
+    const int64_t end = k_uptime_get() + LOOP_RATE_TIMEOUT_MS;
+    int err;
+
+    while ((err = rate_request(cfg, check_budget)) == -EBUSY && k_uptime_get() < end)
+    {
+        k_sleep(K_MSEC(10));
+    }
+    if (err < 0)
+    {
+        return err;
+    }
+
+    while (rate_current().interval_us != cfg->interval_us ||
+           rate_current().extra_bits != cfg->extra_bits)
+    {
+        if (k_uptime_get() >= end)
+        {
+            return -ETIMEDOUT;
+        }
+        k_sleep(K_MSEC(10));
+    }
+
+    return 0;
+}
+
+static void sweep_rate(const struct shell *shell, uint32_t out_hz, uint8_t extra_bits)
+{
+    struct rate_config cfg;
+    struct loop_acc acc;
+    double rms_in;
+    double rms_out;
+    int err = rate_plan(out_hz, extra_bits, &cfg);
+
+    if (err == 0)
+    {
+        err = apply_rate(&cfg, true);
+    }
+    if (err < 0)
+    {
+        shell_print(shell, "%u Hz: taxa recusada (%d)", out_hz, err);
+        return;
+    }
+
+    const uint32_t fs_mhz =
+        (uint32_t)(rate_output_mhz(&cfg) / pipelines[LOOP_CHANNEL].decimation);
+
+    shell_print(shell, "--- %u Hz: aquisição a cada %u us, %u bits extras, saída %u.%03u Hz ---",
+                out_hz, cfg.interval_us, cfg.extra_bits, fs_mhz / 1000U, fs_mhz % 1000U);
+
+    (void)siggen_step(LOOP_MID_CODE);
+    settle();
+    if (collect(&acc, LOOP_NOISE_MS) == 0)
+    {
+        acc_rms(&acc, cfg.extra_bits, &rms_in, &rms_out);
+        shell_print(shell, "Ruído rms: entrada %.2f, saída %.2f códigos", rms_in, rms_out);
+    }
+    else
+    {
+        shell_print(shell, "Ruído: sem blocos");
+    }
+
+    uint32_t raw_us;
+    uint32_t out_us;
+
+    if (measure_step(&cfg, &raw_us, &out_us) == 0)
+    {
+        shell_print(shell, "Degrau: ADC em %u us, saída do filtro em %u us", raw_us, out_us);
+    }
+    else
+    {
+        shell_print(shell, "Degrau: não detectado em %d ms", LOOP_STEP_TIMEOUT_MS);
+    }
+
+    shell_print(shell, "%10s %10s %10s %8s", "Hz", "rms ent.", "rms saída", "ganho");
+    for (size_t i = 0U; i < ARRAY_SIZE(sine_permille); i++)
+    {
+        const uint32_t freq_hz = (uint32_t)((uint64_t)fs_mhz * sine_permille[i] / 1000000U);
+        const struct siggen_config sine = {
+            .wave = SIGGEN_SINE,
+            .freq_hz = freq_hz,
+            .amplitude = LOOP_SINE_AMPLITUDE,
+            .offset = LOOP_MID_CODE,
+        };
+
+        if (freq_hz == 0U || siggen_start(&sine) < 0)
+        {
+            continue;
+        }
+        settle();
+
+        /* Pelo menos 4 períodos e LOOP_MIN_OUT_SAMPLES saídas. */
+        uint32_t duration_ms = MAX(4000U / freq_hz,
+                                   (uint32_t)((uint64_t)LOOP_MIN_OUT_SAMPLES * 1000000U / fs_mhz));
+
+        if (collect(&acc, CLAMP(duration_ms, 100U, 2000U)) < 0)
+        {
+            shell_print(shell, "%10u sem blocos", freq_hz);
+            continue;
+        }
+        acc_rms(&acc, cfg.extra_bits, &rms_in, &rms_out);
+        shell_print(shell, "%10u %10.1f %10.1f %8.3f", freq_hz, rms_in, rms_out,
+                    rms_in > 0.0 ? rms_out / rms_in : 0.0);
+    }
+}
+
+static int cmd_bench_sweep(const struct shell *shell, size_t argc, char **argv)
+{
+    static bool subscribed;
+    uint32_t rates[LOOP_MAX_RATES];
+    size_t n_rates = 0U;
+
+    if (!subscribed)
+    {
+        if (block_bus_subscribe(&loop_sub) < 0)
+        {
+            shell_print(shell, "Sem vaga no barramento de blocos.");
+            return -ENOMEM;
+        }
+        subscribed = true;
+    }
+
+    for (size_t i = 1U; i < argc && n_rates < LOOP_MAX_RATES; i++)
+    {
+        rates[n_rates++] = (uint32_t)atoi(argv[i]);
+    }
+    if (n_rates == 0U)
+    {
+        for (size_t i = 0U; i < ARRAY_SIZE(default_rates_hz); i++)
+        {
+            rates[n_rates++] = default_rates_hz[i];
+        }
+    }
+
+    const struct rate_config saved_rate = rate_current();
+    const struct siggen_config saved_gen = siggen_current();
+    const struct siggen_config mid = {.wave = SIGGEN_DC, .offset = LOOP_MID_CODE};
+
+    if (siggen_start(&mid) == -ENOTSUP)
+    {
+        shell_print(shell, "Sem gerador de sinais nesta placa.");
+        return -ENOTSUP;
+    }
+
+    shell_print(shell, "Gerador ligado ao canal %d do ADC (%s).", LOOP_CHANNEL,
+                acq_channel(LOOP_CHANNEL)->dev->name);
+
+    for (size_t i = 0U; i < n_rates; i++)
+    {
+        sweep_rate(shell, rates[i], saved_rate.extra_bits);
+    }
+
+    block_bus_set_active(&loop_sub, false);
+    drain();
+
+    if (apply_rate(&saved_rate, false) < 0)
+    {
+        shell_print(shell, "Não foi possível restaurar a taxa anterior.");
+    }
+    if (saved_gen.wave == SIGGEN_OFF)
+    {
+        siggen_stop();
+    }
+    else
+    {
+        (void)siggen_start(&saved_gen);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_bench,
+    SHELL_CMD_ARG(sweep, NULL, "Ruído, latência e resposta em frequência: sweep [hz ...]",
+                  cmd_bench_sweep, 1, LOOP_MAX_RATES),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(bench, &sub_bench, "Benchmark em malha fechada DAC -> ADC", NULL);
@@ -6,13 +6,30 @@
 #include <zephyr/shell/shell.h> // api do shel, comunicação
 #include <stdlib.h>             // para atoi
 #include <string.h>             // para strlen, strtol
-#include <zephyr/debug/thread_analyzer.h>
 #include <zephyr/drivers/adc.h>
 #include <zephyr/devicetree.h>
 #include <inttypes.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/usb/usb_device.h>
+#include "acquisition.h"
+#include "filter.h"
+#include "pipeline.h"
+#include "rt_stats.h"
+#include "thread_info.h"
+#include "cpu_top.h"
+#include "mem_stats.h"
+#include "block_bus.h"
+#include "capture.h"
+#include "periodic.h"
+#include "rate.h"
+#include "edf.h"
+#include "button.h"
+#include "trace.h"
+#include "boot_prof.h"
+#include "calib.h"
+#include "rtlog.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
@@ -20,60 +37,30 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
 #define LED0_NODE DT_ALIAS(led0)
 #define LED1_NODE DT_ALIAS(led1)
-#define SW0_NODE DT_ALIAS(sw0)
-#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
-#define DAC_NODE DT_PHANDLE(ZEPHYR_USER_NODE, dac)
-#define DAC_CHANNEL_ID DT_PROP(ZEPHYR_USER_NODE, dac_channel_id)
-#define DAC_RESOLUTION DT_PROP(ZEPHYR_USER_NODE, dac_resolution)
-#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
-    ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
-static const struct device *const dac_dev = DEVICE_DT_GET(DAC_NODE);
-
-static const struct dac_channel_cfg dac_ch_cfg = {
-    .channel_id = DAC_CHANNEL_ID,
-    .resolution = DAC_RESOLUTION,
-#if defined(CONFIG_DAC_BUFFER_NOT_SUPPORT)
-    .buffered = false,
-#else
-    .buffered = true,
-#endif /* CONFIG_DAC_BUFFER_NOT_SUPPORT */
-};
-
-static const struct adc_dt_spec adc_channels[] = {
-    DT_FOREACH_PROP_ELEM(DT_PATH(zephyr_user), io_channels,
-                         DT_SPEC_AND_COMMA)};
 
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
 static const struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
-static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(SW0_NODE, gpios,
-                                                              {0});
-uint64_t sample_speed = 1000;
-static struct gpio_callback button_cb_data;
 volatile uint32_t led_speed = 1000;
-volatile uint8_t led_mode = 0; // 0 = leds alternando, 1 = apenas led verde, 2 = apenas led vermelho, 3 = leds sincronizados
-
-// Variáveis para monitoramento ADC/DAC
-volatile uint32_t last_adc_value = 0;
-volatile uint32_t last_dac_value = 0;
-volatile uint32_t last_adc_mv = 0;
+atomic_t led_mode = ATOMIC_INIT(0); // 0 = leds alternando, 1 = apenas led verde, 2 = apenas led vermelho, 3 = leds sincronizados
 volatile uint8_t adc_dac_enable_print = 0;
 
-/* Estrutura para passar informações para o callback */
-struct task_search_info {
-    const struct shell *shell;
-    const char *task_name;
-    bool found;
-};
-
-struct task_search_info search_info_g;
+/* Captura das threads usada pelos comandos do shell (apenas a thread do shell a acessa) */
+static struct thread_info_snapshot threads_snapshot;
 
-#define LED_STACK_SIZE 512
-#define LED_PRIORITY 5 // Prioridade da tarefa do LED
-#define FILTER_PRIORITY 3
-#define FILTER_STACK_SIZE 1024
-const uint16_t dac_values = 1U << DAC_RESOLUTION;
-
-const uint16_t sleep_time = 4096 / dac_values > 0 ? 4096 / dac_values : 1;
+#define LED_STACK_SIZE CONFIG_APP_LED_STACK_SIZE
+#define LED_MIN_PERIOD_MS 10 // abaixo disso o LED vira um laço competindo com o filtro
+#ifdef CONFIG_APP_EDF
+/* Mesma prioridade: o kernel escolhe pelo prazo mais próximo (edf.h). */
+#define LED_PRIORITY EDF_PRIORITY
+#define FILTER_PRIORITY EDF_PRIORITY
+#else
+#define LED_PRIORITY CONFIG_APP_LED_PRIORITY // Prioridade da tarefa do LED
+#define FILTER_PRIORITY CONFIG_APP_FILTER_PRIORITY
+#endif
+#define FILTER_STACK_SIZE CONFIG_APP_FILTER_STACK_SIZE
+#define MAIN_SERVICES_PRIORITY (FILTER_PRIORITY + 1) // main após a partida rápida
+#define FILTER_DEFAULT_LEN CONFIG_APP_FILTER_DEFAULT_LEN // canais sem nó no devicetree
+#define SAMPLE_SPEED_DEFAULT_US CONFIG_APP_SAMPLE_PERIOD_US // período de aquisição inicial
 K_THREAD_STACK_DEFINE(led_stack, LED_STACK_SIZE);
 K_THREAD_STACK_DEFINE(filter_stack, FILTER_STACK_SIZE);
 struct k_thread led_thread_data;
@@ -81,9 +68,47 @@ struct k_thread dac_thread_data;
 k_tid_t led_thread_id;
 k_tid_t filter_thread_id;
 
+static struct filter_config filter_staged; // configuração montada pelo comando filter
+#ifndef CONFIG_APP_LED_TIMER
+static struct periodic_task led_release;
+static struct edf_task led_edf;
+#endif
+static struct edf_task filter_edf;
+
 /* --- TAREFA DO LED (Soft Real-Time) --- */
 // Esta é um exemplo de tarefa de tempo real soft.
-/* Esta tarefa pisca os leds de acordo com o led_mode, definido no cabeçalho do arquivo. */
+
+/* LEDs trocados em cada passo, por led_mode: bit 0 = led, bit 1 = led1. */
+static const uint8_t led_toggle_mask[] = {0x3, 0x1, 0x2, 0x3};
+
+/* Um passo do padrão de piscar do led_mode atual. */
+static void led_blink_step(void)
+{
+    const uint8_t mask = led_toggle_mask[atomic_get(&led_mode)];
+
+    if (mask & BIT(0))
+    {
+        gpio_pin_toggle_dt(&led);
+    }
+    if (mask & BIT(1))
+    {
+        gpio_pin_toggle_dt(&led1);
+    }
+}
+
+#ifdef CONFIG_APP_LED_TIMER
+/* O padrão roda no callback de um k_timer; a tarefa só acorda quando a
+ * velocidade muda (o modo é lido pelo próprio callback). */
+K_SEM_DEFINE(led_changed, 0, 1);
+static struct k_timer led_timer;
+
+static void led_timer_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    led_blink_step();
+}
+
 void led_task(void *arg1, void *arg2, void *arg3)
 {
     ARG_UNUSED(arg1);
@@ -92,120 +117,167 @@ void led_task(void *arg1, void *arg2, void *arg3)
 
     LOG_INF("LED task started");
     gpio_pin_toggle_dt(&led); // inicia a task como led_mode = 0;
+    k_timer_init(&led_timer, led_timer_expiry, NULL);
 
     while (1)
     {
+        uint32_t period_ms = led_speed;
 
-        if (led_mode == 0 || led_mode == 3)
-        {
-            gpio_pin_toggle_dt(&led);
-            gpio_pin_toggle_dt(&led1);
-        }
-        else if (led_mode == 1)
-        {
-            gpio_pin_toggle_dt(&led);
-        }
-        else if (led_mode == 2)
-        {
-            gpio_pin_toggle_dt(&led1);
-        }
-
-        k_sleep(K_MSEC(led_speed));
-        
+        k_timer_start(&led_timer, K_MSEC(period_ms), K_MSEC(period_ms));
+        (void)k_sem_take(&led_changed, K_FOREVER);
     }
 }
-
-void filter_task()
+#else
+/* Esta tarefa pisca os leds de acordo com o led_mode, definido no cabeçalho do arquivo. */
+void led_task(void *arg1, void *arg2, void *arg3)
 {
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
 
-    uint8_t err;
-    uint16_t buf;
-    struct adc_sequence sequence = {
-        .buffer = &buf,
-        /* buffer size in bytes, not number of samples */
-        .buffer_size = sizeof(buf),
-    };
+    LOG_INF("LED task started");
+    gpio_pin_toggle_dt(&led); // inicia a task como led_mode = 0;
 
-    /* Configure channels individually prior to sampling. */
-    for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++)
-    {
-        if (!adc_is_ready_dt(&adc_channels[i]))
-        {
-            printk("ADC controller device %s not ready\n", adc_channels[i].dev->name);
-            return;
-        }
+    /* Liberação por alarme absoluto: o tempo gasto no laço não atrasa o próximo período. */
+    uint32_t period_ms = led_speed;
+    int err = periodic_register(&led_release, "led_task", period_ms * 1000U);
 
-        err = adc_channel_setup_dt(&adc_channels[i]);
-        if (err < 0)
-        {
-            printk("Could not setup channel #%d (%d)\n", i, err);
-            return;
-        }
+    if (err < 0)
+    {
+        LOG_ERR("Could not register led_task for periodic release (%d)", err);
+        return;
     }
 
-    uint8_t sample_size = 30;
-    uint16_t samples_to_filter[sample_size];
-    uint8_t current_index = 0;
-    for (uint8_t i = 0; i < sample_size; i++)
+    err = edf_register(&led_edf, "led_task", period_ms * 1000U, period_ms * 1000U);
+    if (err < 0)
     {
-        samples_to_filter[i] = 0.0;
+        LOG_ERR("Could not register led_task deadline (%d)", err);
+        return;
     }
 
     while (1)
     {
+        uint32_t start = k_cycle_get_32();
 
-        for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++)
+        edf_job_start(&led_edf, start);
+        led_blink_step();
+
+        if (led_speed != period_ms)
         {
-            int32_t val_mv;
+            period_ms = led_speed;
+            (void)periodic_set_period(&led_release, period_ms * 1000U);
+        }
 
-            (void)adc_sequence_init_dt(&adc_channels[i], &sequence);
+        (void)edf_job_end(&led_edf, start, k_cycle_get_32());
+        (void)periodic_wait(&led_release);
+    }
+}
+#endif /* CONFIG_APP_LED_TIMER */
 
-            err = adc_read_dt(&adc_channels[i], &sequence);
-            if (err < 0)
-            {
-                printk("Could not read (%d)\n", err);
-                continue;
-            }
+/* Reação a um prazo perdido, conforme a política configurada em rt_stats. */
+static void handle_overrun(void)
+{
+    switch (rt_overrun_policy_get())
+    {
+    case RT_OVERRUN_SKIP:
+        rt_stats_count_skipped(acq_flush_ready());
+        break;
+    case RT_OVERRUN_DEGRADE:
+    {
+        struct rate_config cfg = rate_current();
 
-            if (adc_channels[i].channel_cfg.differential)
-            {
-                val_mv = (int32_t)((int16_t)buf);
-            }
-            else
+        if (cfg.interval_us < RATE_MAX_INTERVAL_US)
+        {
+            cfg.interval_us = acq_interval_snap(MIN(cfg.interval_us * 2U, RATE_MAX_INTERVAL_US));
+            if (rate_request(&cfg, false) == 0)
             {
-                val_mv = (int32_t)buf;
+                rt_stats_count_degrade();
+                RTLOG_WRN("filter_task overrun: sample period raised to %u us", cfg.interval_us);
             }
+        }
+        break;
+    }
+    case RT_OVERRUN_CATCH_UP:
+    default:
+        break;
+    }
+}
 
-            samples_to_filter[current_index] = val_mv;
-            current_index++;
+/* Anel de log da filter_task: os erros não formatam nem esperam o USB (rtlog.h). */
+RTLOG_RING_DEFINE(filter_log, CONFIG_APP_RTLOG_RING_LEN);
 
-            if (current_index >= sample_size)
-            {
-                current_index = 0;
-            }
+void filter_task()
+{
+    int err;
 
-            float sum = 0.0;
-            for (uint8_t i = 0; i < sample_size; i++)
-            {
-                sum += samples_to_filter[i];
-            }
+    rtlog_attach(&filter_log);
 
-            uint32_t filtered_value = (uint32_t)(sum / sample_size);
+    err = acq_init();
+    if (err < 0)
+    {
+        RTLOG_ERR("Could not initialize ADC acquisition (%d)", err);
+        return;
+    }
 
-            // Atualiza variáveis para monitoramento
-            last_adc_value = val_mv;
-            last_dac_value = filtered_value;
+    uint32_t block_us = rate_current().interval_us * ACQ_BLOCK_LEN;
 
-            dac_write_value(dac_dev, DAC_CHANNEL_ID, filtered_value);
+    /* Prazo de cada bloco: a chegada do bloco seguinte. */
+    err = edf_register(&filter_edf, "filter_task", block_us, block_us);
+    if (err < 0)
+    {
+        RTLOG_ERR("Could not register filter_task deadline (%d)", err);
+        return;
+    }
 
-            err = adc_raw_to_millivolts_dt(&adc_channels[i], &val_mv);
-            if (err >= 0)
-            {
-                last_adc_mv = val_mv;
-            }
+    err = acq_start(rate_current().interval_us);
+    if (err < 0)
+    {
+        RTLOG_ERR("Could not start ADC acquisition (%d)", err);
+        return;
+    }
+    boot_mark(BOOT_STAGE_ACQ_STARTED);
+
+    while (1)
+    {
+        struct acq_block *block;
+
+        /* Acorda uma vez por bloco de ACQ_BLOCK_LEN amostragens. */
+        if (acq_get_block(&block, K_SECONDS(1)) != 0)
+        {
+            continue;
         }
 
-            k_sleep(K_USEC(sample_speed));
+        uint32_t start = k_cycle_get_32();
+        uint32_t release = block->timestamp;
+        uint32_t period_us = block->interval_us * ACQ_BLOCK_LEN;
+
+        if (period_us != filter_edf.period_us)
+        {
+            /* Já admitida pelo comando adc_dac (ou redução de taxa). */
+            (void)edf_set_period(&filter_edf, period_us, false);
+        }
+        edf_job_start(&filter_edf, release);
+        trace_mark(TRACE_MARK_BLOCK_START, (uint8_t)block->seq);
+
+        rate_sync(block); // troca de taxa pedida pelo shell, na fronteira de bloco
+        pipeline_process_block(block);
+        trace_mark(TRACE_MARK_PIPELINE_DONE, 0U);
+        /* Só empresta o bloco; telemetria, FFT e o retrato do shell o
+         * recebem em prioridade mais baixa (block_bus.h). */
+        block_bus_publish(block);
+        trace_mark(TRACE_MARK_PUBLISHED, 0U);
+        acq_release_block(block);
+
+        uint32_t end = k_cycle_get_32();
+
+        trace_mark(TRACE_MARK_BLOCK_END, 0U);
+        boot_mark(BOOT_STAGE_FIRST_BLOCK);
+        (void)edf_job_end(&filter_edf, start, end);
+        if (rt_stats_record(period_us, release, start, end))
+        {
+            trace_mark(TRACE_MARK_DEADLINE_MISS, 0U);
+            handle_overrun();
+        }
     }
 }
 
@@ -220,21 +292,25 @@ uint8_t is_string_number(const char *str)
     return (*endptr == '\0' && endptr != str);
 }
 
-/* Função chamada pela interrupção do botão, que altera o estado dos LEDS. */
-void button_pressed(const struct device *dev, struct gpio_callback *cb,
-                    uint32_t pins)
+/* Toque no botão, já filtrado pelo debounce: altera o estado dos LEDS.
+ * Roda na thread do botão (button.h), não no ISR. */
+static void button_pressed(void)
 {
-    if (led_mode == 0)
+    atomic_val_t mode = atomic_get(&led_mode);
+
+    capture_button();
+
+    if (mode == 0)
     {
         gpio_pin_set_dt(&led, 1);
         gpio_pin_set_dt(&led1, 0);
     }
-    else if (led_mode == 1)
+    else if (mode == 1)
     {
         gpio_pin_set_dt(&led, 0);
         gpio_pin_set_dt(&led1, 1);
     }
-    else if (led_mode == 2)
+    else if (mode == 2)
     {
         gpio_pin_set_dt(&led, 1);
         gpio_pin_set_dt(&led1, 1);
@@ -243,11 +319,11 @@ void button_pressed(const struct device *dev, struct gpio_callback *cb,
     {
         gpio_pin_set_dt(&led, 1);
         gpio_pin_set_dt(&led1, 0);
-        led_mode = 0;
+        atomic_set(&led_mode, 0);
         return;
     }
 
-    led_mode++;
+    atomic_set(&led_mode, mode + 1);
 }
 
 /* --- COMANDOS DO SHELL --- */
@@ -277,7 +353,25 @@ static int cmd_led_control(const struct shell *shell, size_t argc, char **argv)
         }
 
         uint32_t user_input_led_speed = atoi(argv[1]);
+
+        if (user_input_led_speed < LED_MIN_PERIOD_MS)
+        {
+            shell_print(shell, "Velocidade do LED inválida: mínimo de %d ms.", LED_MIN_PERIOD_MS);
+            return -EINVAL;
+        }
+
+#ifdef CONFIG_APP_LED_TIMER
+        led_speed = user_input_led_speed;
+        trace_sem_give(&led_changed);
+#else
+        if (edf_set_period(&led_edf, user_input_led_speed * 1000U, true) == -E2BIG)
+        {
+            shell_print(shell, "Recusado: densidade EDF passaria de %d%% com os WCET medidos.",
+                        EDF_UTIL_LIMIT_PCT);
+            return -E2BIG;
+        }
         led_speed = user_input_led_speed;
+#endif
         shell_print(shell, "Frequência de amostragem alterada para: %d hz", led_speed);
         return 0;
     }
@@ -294,119 +388,174 @@ void show_startup_help(void)
     printk("==========================================\n");
 }
 
-/* Callback para buscar informações de uma tarefa específica */
-static void specific_task_info_callback(const struct k_thread *thread, void *user_data)
+/* Prazo configurado, folga e prazos perdidos de uma tarefa periódica. */
+static void print_deadline_info(const struct shell *shell, const struct edf_task *task)
 {
-    // Cast para remover const - necessário para compatibilidade da API
-    k_tid_t tid = (k_tid_t)thread;
-    const char *name = k_thread_name_get(tid);
-    
-    if (search_info_g.task_name == NULL || strcmp(name, search_info_g.task_name) == 0)
-    {
-        search_info_g.found = true;
-        struct k_thread_runtime_stats stats;
-        k_thread_runtime_stats_get(tid, &stats);
+#ifdef CONFIG_APP_EDF
+    shell_print(shell, "Escalonamento: EDF, prazo de %u us a cada %u us",
+                task->deadline_us, task->period_us);
+#else
+    shell_print(shell, "Escalonamento: prioridade fixa, prazo de %u us a cada %u us",
+                task->deadline_us, task->period_us);
+#endif
+    shell_print(shell, "Folga: %d us (mínima %d us), WCET %u us",
+                task->last_slack_us, task->jobs > 0U ? task->min_slack_us : 0,
+                k_cyc_to_us_ceil32(task->wcet_cyc));
+    shell_print(shell, "Prazos perdidos: %u de %u jobs", task->misses, task->jobs);
+}
+
+/* Imprime as informações de uma tarefa capturada. Chamada fora do lock de threads. */
+static void print_task_info(const struct shell *shell, const struct thread_info *info)
+{
+    /* Buffer para armazenar a string do estado da thread */
+    char state_buf[32];
 
-        /* Buffer para armazenar a string do estado da thread */
-        char state_buf[32];
+    shell_print(shell, "=== Informações da Tarefa: %s ===", info->name);
 
-        shell_print(search_info_g.shell, "=== Informações da Tarefa: %s ===", name);
-        
-        shell_print(search_info_g.shell, "Uso de CPU: %llu ciclos", stats.execution_cycles);
+    shell_print(shell, "Uso de CPU: %llu ciclos", info->cycles);
 
-        shell_print(search_info_g.shell, "Estado: %s", k_thread_state_str(tid, state_buf, sizeof(state_buf)));
-        
-        // Informações específicas para tarefas de tempo real
-        if (strcmp(name, "led_task") == 0)
-        {
-            char *led_details[] = {"ambos, alternando", "apenas LED verde",
-                                   "apenas LED vermelho", "ambos, sincronizados"};
-            shell_print(search_info_g.shell, "Tipo: Tempo Real Soft");
-            shell_print(search_info_g.shell, "Prioridade: %d", LED_PRIORITY);
-            shell_print(search_info_g.shell, "Velocidade: %d ms", led_speed);
-            shell_print(search_info_g.shell, "Modo LED: %s", led_details[led_mode]);
-        }
-        else if (strcmp(name, "filter_task") == 0)
+    shell_print(shell, "Estado: %s", thread_info_state_str(info, state_buf, sizeof(state_buf)));
+
+    if (info->stack_size > 0U)
+    {
+        shell_print(shell, "Pilha: %u de %u bytes usados (pico)",
+                    (uint32_t)(info->stack_size - info->stack_unused), (uint32_t)info->stack_size);
+    }
+
+    // Informações específicas para tarefas de tempo real
+    if (strcmp(info->name, "led_task") == 0)
+    {
+        char *led_details[] = {"ambos, alternando", "apenas LED verde",
+                               "apenas LED vermelho", "ambos, sincronizados"};
+        shell_print(shell, "Tipo: Tempo Real Soft");
+        shell_print(shell, "Prioridade: %d", LED_PRIORITY);
+        shell_print(shell, "Velocidade: %d ms", led_speed);
+        shell_print(shell, "Modo LED: %s", led_details[atomic_get(&led_mode)]);
+#ifdef CONFIG_APP_LED_TIMER
+        shell_print(shell, "Pisca por k_timer: a tarefa só acorda quando a velocidade muda");
+#else
+        print_deadline_info(shell, &led_edf);
+#endif
+    }
+    else if (strcmp(info->name, "filter_task") == 0)
+    {
+        shell_print(shell, "Tipo: Tempo Real Hard");
+        shell_print(shell, "Prioridade: %d", FILTER_PRIORITY);
+        shell_print(shell, "Função: Filtro digital ADC->DAC (%d canais)", ACQ_NUM_CHANNELS);
+
+        struct block_bus_snapshot snap;
+        if (block_bus_snapshot(&snap))
         {
-            shell_print(search_info_g.shell, "Tipo: Tempo Real Hard");
-            shell_print(search_info_g.shell, "Prioridade: %d", FILTER_PRIORITY);
-            shell_print(search_info_g.shell, "Função: Filtro digital ADC->DAC");
-            shell_print(search_info_g.shell, "Último ADC: %d (%d mV)",
-                        last_adc_value, last_adc_mv);
-            shell_print(search_info_g.shell, "Último DAC: %d", last_dac_value);
-            shell_print(search_info_g.shell, "Frequência de amostragem: %i", 1000000/sample_speed);
+            /* Correção e conversão para mV feitas aqui, fora da tarefa de
+             * tempo real. */
+            int32_t code = acq_channel(0)->channel_cfg.differential ?
+                           snap.last_in[0] : calib_apply(calib_table(0), (uint16_t)snap.last_in[0]);
+            int32_t val_mv = code;
+            if (adc_raw_to_millivolts_dt(acq_channel(0), &val_mv) < 0)
+            {
+                val_mv = 0;
+            }
+            shell_print(shell, "Último ADC: %d (corrigido %d, %d mV), bloco %u", snap.last_in[0],
+                        code, val_mv, snap.seq);
+            shell_print(shell, "Último DAC: %d", snap.last_out[0] >> pipeline_extra_bits());
         }
-        shell_print(search_info_g.shell, "=====================================");
+        struct rate_config rate = rate_current();
+        shell_print(shell, "Frequência de amostragem: %u Hz (saída %u Hz, +%u bits)",
+                    1000000U / rate.interval_us, (uint32_t)(rate_output_mhz(&rate) / 1000U),
+                    rate.extra_bits);
+
+        struct rt_stats rt;
+        rt_stats_snapshot(&rt);
+        shell_print(shell, "Prazos perdidos: %u de %u períodos (ver rt_stats)",
+                    rt.deadline_misses, rt.iterations);
+        print_deadline_info(shell, &filter_edf);
     }
+    else
+    {
+        shell_print(shell, "Prioridade: %d", info->priority);
+    }
+    shell_print(shell, "=====================================");
 }
 
 /* Comando para exibir informações da tarefa do LED */
 static int cmd_task_info(const struct shell *shell, size_t argc, char **argv)
 {
-    search_info_g.shell = shell;
-    search_info_g.task_name = NULL;
-    search_info_g.found = false;
-
-    if (argc == 2)
-    {
-        search_info_g.task_name = argv[1];
-        shell_print(shell, "Buscando informações da tarefa: %s", argv[1]);
-    }
-    else if (argc == 1)
-    {
-        shell_print(shell, "Mostrando informações de todas as tarefas:");
-    }
-    else
+    if (argc > 2)
     {
         shell_print(shell, "Uso: task_info [nome_da_tarefa]");
         shell_print(shell, "Tarefas disponíveis: led_task, filter_task");
         return -EINVAL;
     }
 
-    k_thread_foreach(specific_task_info_callback, NULL);
+    thread_info_snapshot(&threads_snapshot, true);
 
-    if (argc == 2 && !search_info_g.found)
+    if (argc == 2)
     {
-        shell_print(shell, "Tarefa '%s' não encontrada.", argv[1]);
-        shell_print(shell, "Tarefas disponíveis: led_task, filter_task");
-        return -ENOENT;
+        shell_print(shell, "Buscando informações da tarefa: %s", argv[1]);
+
+        const struct thread_info *info = thread_info_find(&threads_snapshot, argv[1]);
+        if (info == NULL)
+        {
+            shell_print(shell, "Tarefa '%s' não encontrada.", argv[1]);
+            shell_print(shell, "Tarefas disponíveis: led_task, filter_task");
+            return -ENOENT;
+        }
+
+        print_task_info(shell, info);
+        return 0;
+    }
+
+    shell_print(shell, "Mostrando informações de todas as tarefas:");
+    for (uint8_t i = 0; i < threads_snapshot.count; i++)
+    {
+        print_task_info(shell, &threads_snapshot.threads[i]);
     }
 
     return 0;
 }
 
-/* Callback para listar todas as tarefas */
-static void thread_list_callback(const struct k_thread *thread, void *user_data)
+static int cmd_system_info(const struct shell *shell, size_t argc, char **argv)
 {
-    // Cast para remover const - necessário para compatibilidade da API
-    k_tid_t tid = (k_tid_t)thread;
-    const char *name = k_thread_name_get(tid);
-    
     /* Buffer para armazenar a string do estado da thread */
     char state_buf[32];
-    
-    shell_print(search_info_g.shell, "%-15s | %s",
-                name,
-                /* Chamada correta, passando o buffer */
-                k_thread_state_str(tid, state_buf, sizeof(state_buf)));
-}
 
-static int cmd_system_info(const struct shell *shell, size_t argc, char **argv)
-{
-    search_info_g.shell = shell;
-    search_info_g.task_name = NULL;
-    search_info_g.found = false;
+    thread_info_snapshot(&threads_snapshot, true);
 
     shell_print(shell, "=== Informações do Sistema ===");
     shell_print(shell, "Tarefas Instaladas:");
-    shell_print(shell, "Nome            | Estado");
-    shell_print(shell, "----------------|-------");
+    shell_print(shell, "Nome            | Prio | Pilha (pico/total) | Estado");
+    shell_print(shell, "----------------|------|--------------------|-------");
 
-    k_thread_foreach(thread_list_callback, NULL);
+    for (uint8_t i = 0; i < threads_snapshot.count; i++)
+    {
+        const struct thread_info *info = &threads_snapshot.threads[i];
+
+        shell_print(shell, "%-15s | %4d | %8u/%-9u | %s",
+                    info->name, info->priority,
+                    (uint32_t)(info->stack_size - info->stack_unused), (uint32_t)info->stack_size,
+                    thread_info_state_str(info, state_buf, sizeof(state_buf)));
+    }
+    if (threads_snapshot.truncated)
+    {
+        shell_print(shell, "(mais de %d tarefas, lista truncada)", THREAD_INFO_MAX);
+    }
 
     shell_print(shell, "");
+    shell_print(shell, "Lock de threads nesta captura: %u us (máx: %u us)",
+                k_cyc_to_us_ceil32(threads_snapshot.lock_cycles),
+                k_cyc_to_us_ceil32(thread_info_max_lock_cycles()));
 
-    shell_print(shell, "Heap configurado: %d bytes", CONFIG_HEAP_MEM_POOL_SIZE);
+    shell_print(shell, "");
+
+    struct sys_memory_stats heap;
+
+    if (mem_stats_system_heap(&heap) == 0)
+    {
+        shell_print(shell, "Heap: %u livres, %u alocados, pico %u de %u bytes ('mem' para detalhes)",
+                    (uint32_t)heap.free_bytes, (uint32_t)heap.allocated_bytes,
+                    (uint32_t)heap.max_allocated_bytes,
+                    (uint32_t)(heap.free_bytes + heap.allocated_bytes));
+    }
 
     shell_print(shell, "");
     shell_print(shell, "Para informações detalhadas de uma tarefa específica:");
@@ -418,38 +567,439 @@ static int cmd_system_info(const struct shell *shell, size_t argc, char **argv)
 /* Comando para controlar saída ADC/DAC */
 static int cmd_adc_dac_control(const struct shell *shell, size_t argc, char **argv)
 {
-     if (argc != 2)
+    struct rate_config cfg = rate_current();
+    uint32_t load_pct;
+
+    if (argc == 1)
+    {
+        uint64_t out_mhz = rate_output_mhz(&cfg);
+
+        shell_print(shell, "Aquisição: %u us (%u Hz), sobreamostragem %ux, +%u bits",
+                    cfg.interval_us, 1000000U / cfg.interval_us, 1U << rate_osr_log2(&cfg),
+                    cfg.extra_bits);
+        shell_print(shell, "Saída dos filtros: %u.%03u Hz", (uint32_t)(out_mhz / 1000U),
+                    (uint32_t)(out_mhz % 1000U));
+        if (rate_estimate_load(&cfg, &load_pct) == 0)
+        {
+            shell_print(shell, "Ocupação medida da filter_task: %u%% (orçamento %d%%)",
+                        load_pct, RATE_CPU_BUDGET_PCT);
+        }
+        return 0;
+    }
+
+    if (is_string_number(argv[1]) == 0 || argv[1][0] == '-' || strlen(argv[1]) > 6 ||
+        (argc > 2 && (is_string_number(argv[2]) == 0 || argv[2][0] == '-')))
     {
-        shell_print(shell, "Uso: adc_dac <frequencia_de_amostragem_hz>");
+        shell_print(shell, "Uso: adc_dac [frequencia_de_saida_hz] [bits_extras 0..%d]",
+                    RATE_MAX_EXTRA_BITS);
         return -EINVAL;
     }
 
-    if (is_string_number(argv[1]) != 0)
+    uint32_t out_hz = (uint32_t)atoi(argv[1]);
+    uint32_t extra_bits = argc > 2 ? (uint32_t)atoi(argv[2]) : 0U;
+
+    if (extra_bits > RATE_MAX_EXTRA_BITS)
+    {
+        shell_print(shell, "Bits extras: de 0 a %d (sobreamostragem de até %dx).",
+                    RATE_MAX_EXTRA_BITS, 1 << (2 * RATE_MAX_EXTRA_BITS));
+        return -EINVAL;
+    }
+
+    int err = rate_plan(out_hz, (uint8_t)extra_bits, &cfg);
+
+    if (err < 0)
     {
+        shell_print(shell, "Frequência inválida: a aquisição (saída x %u) deve ficar entre %d Hz e %u Hz.",
+                    1U << (2U * extra_bits), 1000000 / RATE_MAX_INTERVAL_US,
+                    1000000U / rate_min_interval_us());
+        return err;
+    }
 
-        if (strlen(argv[1]) > 10 || strlen(argv[1]) == 0)
+    bool has_load = rate_estimate_load(&cfg, &load_pct) == 0;
+    uint32_t exec_us;
+
+    if (rate_estimate_exec_us(&cfg, &exec_us) == 0 &&
+        edf_admit_period(&filter_edf, cfg.interval_us * ACQ_BLOCK_LEN, exec_us) == -E2BIG)
+    {
+        shell_print(shell, "Recusado: densidade EDF passaria de %d%% (WCET estimado %u us).",
+                    EDF_UTIL_LIMIT_PCT, exec_us);
+        return -E2BIG;
+    }
+
+    err = rate_request(&cfg, true);
+    if (err == -EOVERFLOW)
+    {
+        shell_print(shell, "Recusado: ocupação estimada de %u%% passa do orçamento de %d%%.",
+                    load_pct, RATE_CPU_BUDGET_PCT);
+        return err;
+    }
+    if (err == -EBUSY)
+    {
+        shell_print(shell, "Troca anterior ainda não aplicada, tente novamente.");
+        return err;
+    }
+
+    shell_print(shell, "Aquisição a %u us, sobreamostragem %ux, saída %u Hz (+%u bits)",
+                cfg.interval_us, 1U << rate_osr_log2(&cfg),
+                (uint32_t)(rate_output_mhz(&cfg) / 1000U), cfg.extra_bits);
+    if (has_load)
+    {
+        shell_print(shell, "Ocupação estimada: %u%%. Aplicada no próximo bloco.", load_pct);
+    }
+    return 0;
+}
+
+/* Mostra os estágios de uma configuração de filtro */
+static void print_filter_config(const struct shell *shell, const struct filter_config *cfg)
+{
+    const char *names[] = {"mavg", "fir", "biquad"};
+
+    for (uint8_t s = 0; s < cfg->num_stages; s++)
+    {
+        const struct filter_stage_cfg *stage = &cfg->stages[s];
+
+        shell_print(shell, "Estágio %d: %s, tamanho %d", s, names[stage->type], stage->len);
+
+        size_t ncoeffs = stage->type == FILTER_STAGE_FIR ? stage->len :
+                         stage->type == FILTER_STAGE_BIQUAD ? stage->len * FILTER_BIQUAD_COEFFS : 0;
+        for (size_t k = 0; k < ncoeffs; k++)
         {
-            shell_print(shell, "Frequencia inválida.");
-            return -EINVAL;
+            shell_print(shell, "  c[%d] = %f", (int)k, (double)stage->coeffs[k]);
         }
+    }
+}
 
-        if (argv[1][0] == '-')
+/* Adiciona um estágio à configuração montada pelo shell */
+static struct filter_stage_cfg *filter_staged_add(const struct shell *shell,
+                                                  enum filter_stage_type type)
+{
+    if (filter_staged.num_stages >= FILTER_MAX_STAGES)
+    {
+        shell_print(shell, "Máximo de %d estágios.", FILTER_MAX_STAGES);
+        return NULL;
+    }
+
+    struct filter_stage_cfg *stage = &filter_staged.stages[filter_staged.num_stages];
+
+    memset(stage, 0, sizeof(*stage));
+    stage->type = type;
+    return stage;
+}
+
+/* Lê os coeficientes em ponto flutuante de argv[1..argc-1] */
+static int parse_coeffs(const struct shell *shell, size_t argc, char **argv, float *coeffs)
+{
+    for (size_t i = 1; i < argc; i++)
+    {
+        char *endptr;
+
+        coeffs[i - 1] = strtof(argv[i], &endptr);
+        if (*endptr != '\0' || endptr == argv[i])
         {
-            shell_print(shell, "Frequência inválida.");
+            shell_print(shell, "Coeficiente inválido: %s", argv[i]);
             return -EINVAL;
         }
-        if (atoi(argv[1]) < 1 || atoi(argv[1]) > 100000){
-            shell_print(shell, "Frequência de amostragem inválida. Digite um valor entre 1 e 100khz");
+    }
+
+    return 0;
+}
+
+/* Lê o índice de canal opcional em argv[1]. Retorna -1 se inválido. */
+static int parse_channel(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return 0;
+    }
+
+    if (is_string_number(argv[1]) == 0 || atoi(argv[1]) < 0 || atoi(argv[1]) >= ACQ_NUM_CHANNELS)
+    {
+        shell_print(shell, "Canal inválido. Digite um valor entre 0 e %d", ACQ_NUM_CHANNELS - 1);
+        return -1;
+    }
+
+    return atoi(argv[1]);
+}
+
+static int cmd_filter_show(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = parse_channel(shell, argc, argv);
+
+    if (channel < 0)
+    {
+        return -EINVAL;
+    }
+
+    shell_print(shell, "=== Filtro em uso no canal %d ===", channel);
+    print_filter_config(shell, filter_chain_config(&pipelines[channel].chain));
+    shell_print(shell, "=== Filtro montado (aplicar com 'filter apply') ===");
+    print_filter_config(shell, &filter_staged);
+    return 0;
+}
+
+static int cmd_filter_clear(const struct shell *shell, size_t argc, char **argv)
+{
+    filter_staged.num_stages = 0;
+    shell_print(shell, "Configuração montada apagada.");
+    return 0;
+}
+
+static int cmd_filter_mavg(const struct shell *shell, size_t argc, char **argv)
+{
+    if (is_string_number(argv[1]) == 0 || atoi(argv[1]) < 1 || atoi(argv[1]) > FILTER_MAX_TAPS)
+    {
+        shell_print(shell, "Janela inválida. Digite um valor entre 1 e %d", FILTER_MAX_TAPS);
+        return -EINVAL;
+    }
+
+    struct filter_stage_cfg *stage = filter_staged_add(shell, FILTER_STAGE_MAVG);
+    if (stage == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    stage->len = atoi(argv[1]);
+    filter_staged.num_stages++;
+    return 0;
+}
+
+/* Lê coeficientes para a posição 'offset' do estágio, respeitando o limite de taps */
+static int stage_add_coeffs(const struct shell *shell, struct filter_stage_cfg *stage,
+                            size_t offset, size_t argc, char **argv)
+{
+    if (offset + argc - 1 > FILTER_MAX_TAPS)
+    {
+        shell_print(shell, "Máximo de %d coeficientes por estágio.", FILTER_MAX_TAPS);
+        return -EINVAL;
+    }
+
+    return parse_coeffs(shell, argc, argv, &stage->coeffs[offset]);
+}
+
+static int cmd_filter_fir(const struct shell *shell, size_t argc, char **argv)
+{
+    struct filter_stage_cfg *stage = filter_staged_add(shell, FILTER_STAGE_FIR);
+    if (stage == NULL || stage_add_coeffs(shell, stage, 0, argc, argv) < 0)
+    {
+        return -EINVAL;
+    }
+
+    stage->len = argc - 1;
+    filter_staged.num_stages++;
+    return 0;
+}
+
+static int cmd_filter_biquad(const struct shell *shell, size_t argc, char **argv)
+{
+    if ((argc - 1) % FILTER_BIQUAD_COEFFS != 0)
+    {
+        shell_print(shell, "Uso: filter biquad <b0> <b1> <b2> <a1> <a2> [...]");
+        return -EINVAL;
+    }
+
+    struct filter_stage_cfg *stage = filter_staged_add(shell, FILTER_STAGE_BIQUAD);
+    if (stage == NULL || stage_add_coeffs(shell, stage, 0, argc, argv) < 0)
+    {
+        return -EINVAL;
+    }
+
+    stage->len = (argc - 1) / FILTER_BIQUAD_COEFFS;
+    filter_staged.num_stages++;
+    return 0;
+}
+
+/* Acrescenta coeficientes ao último estágio FIR/biquad montado. Permite
+ * filtros mais longos do que cabem em uma linha do shell. */
+static int cmd_filter_more(const struct shell *shell, size_t argc, char **argv)
+{
+    if (filter_staged.num_stages == 0 ||
+        filter_staged.stages[filter_staged.num_stages - 1].type == FILTER_STAGE_MAVG)
+    {
+        shell_print(shell, "Nenhum estágio FIR ou biquad montado.");
+        return -EINVAL;
+    }
+
+    struct filter_stage_cfg *stage = &filter_staged.stages[filter_staged.num_stages - 1];
+
+    if (stage->type == FILTER_STAGE_FIR)
+    {
+        if (stage_add_coeffs(shell, stage, stage->len, argc, argv) < 0)
+        {
+            return -EINVAL;
         }
-        uint32_t user_input_sample_frequency = atoi(argv[1]);
-        sample_speed = ( 1 / user_input_sample_frequency ) * 1000000; // Período em microssegundos
-        shell_print(shell, "Frequencia de amostragem alterada para: %d Hz ", user_input_sample_frequency);
+        stage->len += argc - 1;
         return 0;
     }
-    shell_print(shell, "Frequência inválida.");
-    return -EINVAL;
+
+    if ((argc - 1) % FILTER_BIQUAD_COEFFS != 0 ||
+        stage_add_coeffs(shell, stage, stage->len * FILTER_BIQUAD_COEFFS, argc, argv) < 0)
+    {
+        shell_print(shell, "Cada seção biquad tem %d coeficientes.", FILTER_BIQUAD_COEFFS);
+        return -EINVAL;
+    }
+    stage->len += (argc - 1) / FILTER_BIQUAD_COEFFS;
+    return 0;
+}
+
+static int cmd_filter_apply(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = parse_channel(shell, argc, argv);
+
+    if (channel < 0)
+    {
+        return -EINVAL;
+    }
+
+    int err = filter_chain_load(&pipelines[channel].chain, &filter_staged);
+
+    if (err == -EBUSY)
+    {
+        shell_print(shell, "Troca anterior ainda não aplicada, tente novamente.");
+        return err;
+    }
+    if (err < 0)
+    {
+        shell_print(shell, "Configuração de filtro inválida.");
+        return err;
+    }
+
+    shell_print(shell, "Filtro aplicado ao canal %d no próximo bloco.", channel);
+    return 0;
 }
 
+/* Comando para mostrar os pipelines de cada canal */
+static int cmd_pipeline_show(const struct shell *shell, size_t argc, char **argv)
+{
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        const struct pipeline_channel *ch = &pipelines[i];
+        const struct pipeline_stats *st = &ch->stats;
+
+        shell_print(shell, "=== Canal %d (ADC canal %d) ===", (int)i, acq_channel(i)->channel_id);
+        shell_print(shell, "Estágios de filtro: %d", filter_chain_config(&ch->chain)->num_stages);
+        shell_print(shell, "Decimação: %d", ch->decimation);
+        if (ch->sink == PIPELINE_SINK_DAC)
+        {
+            shell_print(shell, "Saída: dac (canal %d), %u blocos atrasados",
+                        ch->dac_channel, st->dac_late);
+        }
+        else
+        {
+            shell_print(shell, "Saída: %s", pipeline_sink_name(ch->sink));
+        }
+        shell_print(shell, "Amostras: %u entrada, %u saída", st->samples_in, st->samples_out);
+        shell_print(shell, "Última entrada: %d, última saída: %d", st->last_in, st->last_out);
+        if (st->samples_out > 0U)
+        {
+            shell_print(shell, "Saída mín/máx: %d / %d", st->min_out, st->max_out);
+        }
+    }
+    shell_print(shell, "Blocos perdidos: %u", acq_overruns());
+
+    return 0;
+}
+
+static int cmd_pipeline_sink(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = parse_channel(shell, argc, argv);
+    enum pipeline_sink sink;
+    uint8_t dac_channel = 0;
+
+    if (channel < 0)
+    {
+        return -EINVAL;
+    }
+
+    if (strcmp(argv[2], "dac") == 0)
+    {
+        if (argc != 4 || is_string_number(argv[3]) == 0)
+        {
+            shell_print(shell, "Uso: pipeline sink <canal> dac <canal_dac>");
+            return -EINVAL;
+        }
+        sink = PIPELINE_SINK_DAC;
+        dac_channel = atoi(argv[3]);
+    }
+    else if (strcmp(argv[2], "telemetry") == 0)
+    {
+        sink = PIPELINE_SINK_TELEMETRY;
+    }
+    else if (strcmp(argv[2], "none") == 0)
+    {
+        sink = PIPELINE_SINK_NONE;
+    }
+    else
+    {
+        shell_print(shell, "Saída inválida. Use dac, telemetry ou none.");
+        return -EINVAL;
+    }
+
+    int err = pipeline_set_sink(channel, sink, dac_channel);
+    if (err == -ENOTSUP && sink == PIPELINE_SINK_DAC)
+    {
+        shell_print(shell, "Canal %d do DAC sem saída disparada pela aquisição", dac_channel);
+        return err;
+    }
+    if (err < 0)
+    {
+        shell_print(shell, "Falha ao configurar a saída (%d)", err);
+        return err;
+    }
+
+    return 0;
+}
+
+static int cmd_pipeline_decim(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = parse_channel(shell, argc, argv);
+
+    if (channel < 0)
+    {
+        return -EINVAL;
+    }
+
+    if (is_string_number(argv[2]) == 0 || pipeline_set_decimation(channel, atoi(argv[2])) < 0)
+    {
+        shell_print(shell, "Decimação inválida. Digite um valor entre 1 e %d", PIPELINE_MAX_DECIMATION);
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+static int cmd_pipeline_reset(const struct shell *shell, size_t argc, char **argv)
+{
+    for (size_t i = 0U; i < ACQ_NUM_CHANNELS; i++)
+    {
+        pipeline_reset_stats(i);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_filter,
+    SHELL_CMD_ARG(show, NULL, "Mostra o filtro em uso e o montado: show [canal]",
+                  cmd_filter_show, 1, 1),
+    SHELL_CMD(clear, NULL, "Apaga a configuração montada", cmd_filter_clear),
+    SHELL_CMD_ARG(mavg, NULL, "Adiciona média móvel: mavg <janela>", cmd_filter_mavg, 2, 0),
+    SHELL_CMD_ARG(fir, NULL, "Adiciona FIR: fir <h0> [h1 ...]", cmd_filter_fir,
+                  2, SHELL_OPT_ARG_CHECK_SKIP),
+    SHELL_CMD_ARG(biquad, NULL, "Adiciona biquads: biquad <b0> <b1> <b2> <a1> <a2> [...]",
+                  cmd_filter_biquad, 6, SHELL_OPT_ARG_CHECK_SKIP),
+    SHELL_CMD_ARG(more, NULL, "Acrescenta coeficientes ao último FIR/biquad", cmd_filter_more,
+                  2, SHELL_OPT_ARG_CHECK_SKIP),
+    SHELL_CMD_ARG(apply, NULL, "Troca o filtro em uso sem parar a aquisição: apply [canal]",
+                  cmd_filter_apply, 1, 1),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_pipeline,
+    SHELL_CMD(show, NULL, "Mostra o pipeline e as estatísticas de cada canal", cmd_pipeline_show),
+    SHELL_CMD_ARG(sink, NULL, "Define a saída: sink <canal> <dac <canal_dac>|telemetry|none>",
+                  cmd_pipeline_sink, 3, 1),
+    SHELL_CMD_ARG(decim, NULL, "Define a decimação: decim <canal> <fator>", cmd_pipeline_decim, 3, 0),
+    SHELL_CMD(reset, NULL, "Zera as estatísticas", cmd_pipeline_reset),
+    SHELL_SUBCMD_SET_END);
+
 /* Comando para mostrar informações do sistema */
 static int cmd_help(const struct shell *shell, size_t argc, char **argv)
 {
@@ -459,7 +1009,31 @@ static int cmd_help(const struct shell *shell, size_t argc, char **argv)
     shell_print(shell, "task_info [nome]    - Informações detalhadas de tarefa");
     shell_print(shell, "                      Tarefas: led_task, filter_task");
     shell_print(shell, "system              - Informações do sistema completo");
-    shell_print(shell, "adc_dac <frequencia_amostragem>    - Habilita/desabilita saída ADC/DAC");
+    shell_print(shell, "adc_dac [freq_saida_hz] [bits_extras] - Taxa de amostragem e sobreamostragem");
+    shell_print(shell, "filter <show|clear|mavg|fir|biquad|more|apply> - Configura o filtro digital");
+    shell_print(shell, "pipeline <show|sink|decim|reset> - Pipelines por canal do ADC");
+    shell_print(shell, "rt_stats [reset|policy] - Prazo, jitter e latência da filter_task");
+    shell_print(shell, "top                 - Carga de CPU total e por tarefa");
+    shell_print(shell, "mem [scan]          - Uso de heap, slabs e pico das pilhas");
+    shell_print(shell, "boot                - Etapas da inicialização e causa do reset");
+    shell_print(shell, "calib [show|run|reset] - Calibração da entrada do ADC por tabela");
+#ifdef CONFIG_APP_RTLOG
+    shell_print(shell, "rtlog [status|bench] - Log adiado das tarefas de tempo real");
+#endif
+#ifdef CONFIG_APP_TRACE
+    shell_print(shell, "trace [start|stop|status|dump] - Trace do escalonador em RAM");
+#endif
+    shell_print(shell, "dsp <bench|check>   - Benchmark e verificação dos kernels Q15");
+    shell_print(shell, "spectrum [start|stop|show|bins] - Análise espectral (FFT) de um canal");
+    shell_print(shell, "capture [config|arm|stop|dump] - Captura disparada (osciloscópio)");
+    shell_print(shell, "periodic            - Erro de período das tarefas periódicas");
+    shell_print(shell, "bus                 - Assinantes dos blocos de amostras e descartes");
+    shell_print(shell, "edf [show|deadline] - Prazos, folgas e modo EDF das tarefas");
+    shell_print(shell, "button [latency|inject|reset] - Latência da interrupção do botão");
+#ifdef CONFIG_APP_SIGGEN
+    shell_print(shell, "gen [sine|square|ramp|chirp|dc|off] - Gerador de sinais no DAC");
+    shell_print(shell, "bench sweep [hz ...] - Ruído, latência e resposta DAC -> ADC");
+#endif
     shell_print(shell, "help                - Mostra esta ajuda");
     shell_print(shell, "");
     shell_print(shell, "=== Informações das Tarefas de Tempo Real ===");
@@ -476,15 +1050,58 @@ static int cmd_help(const struct shell *shell, size_t argc, char **argv)
 SHELL_CMD_REGISTER(led, NULL, "Controla a velocidade do LED", cmd_led_control);
 SHELL_CMD_REGISTER(task_info, NULL, "Informações detalhadas de tarefa", cmd_task_info);
 SHELL_CMD_REGISTER(system, NULL, "Informações completas do sistema", cmd_system_info);
-SHELL_CMD_REGISTER(adc_dac, NULL, "Controla saída ADC/DAC", cmd_adc_dac_control);
+SHELL_CMD_REGISTER(adc_dac, NULL, "Taxa de amostragem e sobreamostragem ADC/DAC", cmd_adc_dac_control);
+SHELL_CMD_REGISTER(filter, &sub_filter, "Configura a cadeia de filtros", NULL);
+SHELL_CMD_REGISTER(pipeline, &sub_pipeline, "Pipelines por canal do ADC", NULL);
 SHELL_CMD_REGISTER(help, NULL, "Mostra comandos disponíveis", cmd_help);
 
 /* --- FUNÇÃO PRINCIPAL --- */
-int main(void)
+
+/* Pipelines, taxa de amostragem e a filter_task: o caminho até a primeira
+ * amostra no DAC. */
+static int start_pipeline(void)
 {
     int ret;
 
-    LOG_INF("Aplicacao Zephyr com Shell Iniciada...");
+    ret = pipeline_init(FILTER_DEFAULT_LEN);
+    rate_init(SAMPLE_SPEED_DEFAULT_US);
+
+    if (ret != 0)
+    {
+        printk("Setting up of filter pipelines failed with code %d\n", ret);
+        return ret;
+    }
+
+    boot_mark(BOOT_STAGE_PIPELINE_READY);
+
+    filter_thread_id = k_thread_create(&dac_thread_data, filter_stack,
+                                       K_THREAD_STACK_SIZEOF(filter_stack),
+                                       filter_task, NULL, NULL, NULL,
+                                       FILTER_PRIORITY, 0, K_NO_WAIT);
+
+    k_thread_name_set(filter_thread_id, "filter_task");
+
+    return 0;
+}
+
+/* USB (console e shell), LEDs, botão e amostradores de carga e memória. */
+static int start_services(void)
+{
+    int ret;
+
+#if defined(CONFIG_USB_DEVICE_STACK) && !defined(CONFIG_USB_DEVICE_INITIALIZE_AT_BOOT)
+    /* A enumeração sai do caminho de boot; o console e o shell aparecem
+     * quando o host abrir a porta CDC ACM. */
+    ret = usb_enable(NULL);
+    if (ret != 0 && ret != -EALREADY)
+    {
+        LOG_ERR("Falha ao habilitar o USB: %d", ret);
+    }
+    else
+    {
+        boot_mark(BOOT_STAGE_USB_ENABLED);
+    }
+#endif
 
     /* Verifica se o dispositivo do LED está pronto */
     if (!device_is_ready(led.port))
@@ -525,51 +1142,74 @@ int main(void)
     // Define um nome para a thread, que aparecerá nos comandos do shell
     k_thread_name_set(led_thread_id, "led_task");
 
-    /* Configura o pino do botão */
-    ret = gpio_pin_configure_dt(&button, GPIO_INPUT);
+    /* Botão: o ISR só registra a borda; o tratamento roda em thread */
+    ret = button_init(button_pressed);
     if (ret != 0)
     {
-        LOG_ERR("Error %d: failed to configure %s pin %d\n",
-                ret, button.port->name, button.pin);
-        return 0;
+        return ret;
     }
 
-    /* Configura a interrupção do botão */
-    ret = gpio_pin_interrupt_configure_dt(&button,
-                                          GPIO_INT_EDGE_TO_ACTIVE);
-    if (ret != 0)
+    cpu_top_start();
+    mem_stats_start();
+
+    boot_mark(BOOT_STAGE_SERVICES);
+    LOG_INF("Tarefa do LED criada com sucesso. Shell esta pronto.");
+
+    return 0;
+}
+
+int main(void)
+{
+    int ret;
+
+    boot_mark(BOOT_STAGE_MAIN);
+    if (IS_ENABLED(CONFIG_USB_DEVICE_INITIALIZE_AT_BOOT))
     {
-        LOG_ERR("Error %d: failed to configure interrupt on %s pin %d\n",
-                ret, button.port->name, button.pin);
-        return 0;
+        boot_mark(BOOT_STAGE_USB_ENABLED);
     }
 
-    gpio_init_callback(&button_cb_data, button_pressed, BIT(button.pin));
-    gpio_add_callback(button.port, &button_cb_data);
-    LOG_INF("Set up button at %s pin %d\n", button.port->name, button.pin);
+    LOG_INF("Aplicacao Zephyr com Shell Iniciada...");
 
-    if (!device_is_ready(dac_dev))
+#ifdef CONFIG_APP_FAST_START
+    /* Depois de um reset (watchdog, brown-out) a saída volta antes de tudo:
+     * a filter_task começa a converter e o resto sobe em segundo plano. */
+    ret = start_pipeline();
+    if (ret != 0)
     {
-        printk("DAC device %s is not ready\n", dac_dev->name);
         return 0;
     }
 
-    ret = dac_channel_setup(dac_dev, &dac_ch_cfg);
+    /* main tem prioridade 0, acima da filter_task: sem isso o USB e os LEDs
+     * atrasariam o primeiro bloco. */
+    k_thread_priority_set(k_current_get(), MAIN_SERVICES_PRIORITY);
 
+    ret = start_services();
     if (ret != 0)
     {
-        printk("Setting up of DAC channel failed with code %d\n", ret);
-        return 0;
+        return ret;
+    }
+#else
+    ret = start_services();
+    if (ret != 0)
+    {
+        return ret;
     }
 
-    filter_thread_id = k_thread_create(&dac_thread_data, filter_stack,
-                                       K_THREAD_STACK_SIZEOF(filter_stack),
-                                       filter_task, NULL, NULL, NULL,
-                                       FILTER_PRIORITY, 0, K_NO_WAIT);
-
-    k_thread_name_set(filter_thread_id, "filter_task");
+    ret = start_pipeline();
+    if (ret != 0)
+    {
+        return 0;
+    }
+#endif
 
-    LOG_INF("Tarefa do LED criada com sucesso. Shell esta pronto.");
+#ifdef CONFIG_APP_CALIB_AT_BOOT
+    /* Mede a tabela do canal 0 pelo gerador com o pipeline já rodando. */
+    ret = calib_run(0, CONFIG_APP_CALIB_POINTS);
+    if (ret != 0)
+    {
+        LOG_WRN("Calibracao do ADC falhou: %d", ret);
+    }
+#endif
 
     /* Aguarda um pouco para garantir que o shell esteja pronto */
     k_sleep(K_MSEC(2000));
@@ -0,0 +1,331 @@
+#include "mem_stats.h"
+#include "thread_info.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/sys_heap.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+/* Estrutura interna do sys_heap (lib/heap), para percorrer as listas livres. */
+#include <heap.h>
+
+#if defined(CONFIG_HEAP_MEM_POOL_SIZE) && CONFIG_HEAP_MEM_POOL_SIZE > 0
+extern struct k_heap _system_heap; // heap do k_malloc, definido pelo kernel
+#define HAS_SYSTEM_HEAP 1
+#else
+#define HAS_SYSTEM_HEAP 0
+#endif
+
+#define STACK_MARGIN_PCT 25 // folga sobre o pico no tamanho sugerido
+
+struct heap_sample
+{
+    struct k_heap *heap;
+    struct sys_memory_stats stats;
+    size_t min_free; // menor livre desde a descoberta do heap
+};
+
+struct slab_sample
+{
+    struct k_mem_slab *slab;
+    uint32_t block_size;
+    uint32_t num_blocks;
+    uint32_t used;
+    uint32_t max_used;
+};
+
+struct mem_view
+{
+    uint8_t heap_count;
+    uint8_t slab_count;
+    bool truncated;
+    uint32_t samples;
+    struct heap_sample heaps[MEM_MAX_HEAPS];
+    struct slab_sample slabs[MEM_MAX_SLABS];
+};
+
+/* Escrita pelo amostrador; o shell copia para 'view' e imprime sem o lock. */
+static struct mem_view state;
+static struct mem_view view;
+K_MUTEX_DEFINE(mem_lock);
+
+/* Última varredura das pilhas. Só a thread do shell lê e escreve. */
+static struct thread_info_snapshot stacks;
+static uint32_t scan_cycles;   // duração da última varredura
+static int64_t scan_uptime_ms; // instante da última varredura
+
+static void mem_sample_work(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(mem_work, mem_sample_work);
+
+static void sample_heaps(void)
+{
+    uint8_t n = 0U;
+
+    STRUCT_SECTION_FOREACH(k_heap, heap)
+    {
+        if (n >= MEM_MAX_HEAPS)
+        {
+            state.truncated = true;
+            break;
+        }
+
+        struct heap_sample *s = &state.heaps[n++];
+
+        if (s->heap != heap)
+        {
+            s->heap = heap;
+            s->min_free = SIZE_MAX;
+        }
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+        k_spinlock_key_t key = k_spin_lock(&heap->lock);
+
+        (void)sys_heap_runtime_stats_get(&heap->heap, &s->stats);
+        k_spin_unlock(&heap->lock, key);
+#endif
+        s->min_free = MIN(s->min_free, s->stats.free_bytes);
+    }
+    state.heap_count = n;
+}
+
+static void sample_slabs(void)
+{
+    uint8_t n = 0U;
+
+    STRUCT_SECTION_FOREACH(k_mem_slab, slab)
+    {
+        if (n >= MEM_MAX_SLABS)
+        {
+            state.truncated = true;
+            break;
+        }
+
+        struct slab_sample *s = &state.slabs[n++];
+
+        s->slab = slab;
+        s->block_size = (uint32_t)slab->info.block_size;
+        s->num_blocks = slab->info.num_blocks;
+        s->used = k_mem_slab_num_used_get(slab);
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+        s->max_used = k_mem_slab_max_used_get(slab);
+#else
+        s->max_used = MAX(s->max_used, s->used);
+#endif
+    }
+    state.slab_count = n;
+}
+
+static void mem_sample_work(struct k_work *work)
+{
+    (void)k_work_schedule(k_work_delayable_from_work(work), K_MSEC(MEM_SAMPLE_PERIOD_MS));
+
+    k_mutex_lock(&mem_lock, K_FOREVER);
+
+    sample_heaps();
+    sample_slabs();
+    state.samples++;
+
+    k_mutex_unlock(&mem_lock);
+}
+
+void mem_stats_start(void)
+{
+    (void)k_work_schedule(&mem_work, K_NO_WAIT);
+}
+
+int mem_stats_system_heap(struct sys_memory_stats *stats)
+{
+#if HAS_SYSTEM_HEAP && defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+    k_spinlock_key_t key = k_spin_lock(&_system_heap.lock);
+    int err = sys_heap_runtime_stats_get(&_system_heap.heap, stats);
+
+    k_spin_unlock(&_system_heap.lock, key);
+
+    return err;
+#else
+    ARG_UNUSED(stats);
+    return -ENOTSUP;
+#endif
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+/* Maior bloco alocável: o maior pedaço livre do balde mais alto não vazio
+ * (cada balde guarda pedaços de [2^b, 2^(b+1)) unidades), menos o
+ * cabeçalho. Só lê as listas livres, sob o lock do heap: sem alocações de
+ * teste, o pico de alocação das estatísticas não muda. */
+static size_t largest_free_block(struct k_heap *heap)
+{
+    k_spinlock_key_t key = k_spin_lock(&heap->lock);
+    struct z_heap *h = heap->heap.heap;
+    size_t largest = 0U;
+
+    if (h->avail_buckets != 0U)
+    {
+        const int bucket = 31 - __builtin_clz(h->avail_buckets);
+        const chunkid_t first = h->buckets[bucket].next;
+        chunkid_t c = first;
+
+        do
+        {
+            largest = MAX(largest, (size_t)chunk_size(h, c));
+            c = next_free_chunk(h, c);
+        } while (c != first);
+
+        largest = chunksz_to_bytes(h, largest) - chunk_header_bytes(h);
+    }
+    k_spin_unlock(&heap->lock, key);
+
+    return largest;
+}
+
+static const char *heap_name(const struct k_heap *heap, char *buf, size_t size)
+{
+#if HAS_SYSTEM_HEAP
+    if (heap == &_system_heap)
+    {
+        return "sistema";
+    }
+#endif
+    snprintk(buf, size, "%p", (const void *)heap);
+    return buf;
+}
+
+static void print_heaps(const struct shell *shell)
+{
+    char name[16];
+
+#ifndef CONFIG_SYS_HEAP_RUNTIME_STATS
+    shell_print(shell, "Heaps: sem CONFIG_SYS_HEAP_RUNTIME_STATS.");
+    return;
+#endif
+
+    if (view.heap_count == 0U)
+    {
+        shell_print(shell, "Nenhum k_heap definido.");
+        return;
+    }
+
+    shell_print(shell, "Heap        |  Total | Livre  | Alocado | Pico   | Menor livre | Maior bloco | Frag.");
+    shell_print(shell, "------------|--------|--------|---------|--------|-------------|-------------|------");
+
+    for (uint8_t i = 0U; i < view.heap_count; i++)
+    {
+        const struct heap_sample *s = &view.heaps[i];
+        const size_t total = s->stats.free_bytes + s->stats.allocated_bytes;
+        const size_t largest = largest_free_block(s->heap);
+        const uint32_t frag_pct = s->stats.free_bytes > 0U ?
+            100U - (uint32_t)(largest * 100U / s->stats.free_bytes) : 0U;
+
+        shell_print(shell, "%-11s | %6u | %6u | %7u | %6u | %11u | %11u | %3u%%",
+                    heap_name(s->heap, name, sizeof(name)), (uint32_t)total,
+                    (uint32_t)s->stats.free_bytes, (uint32_t)s->stats.allocated_bytes,
+                    (uint32_t)s->stats.max_allocated_bytes, (uint32_t)s->min_free,
+                    (uint32_t)largest, frag_pct);
+    }
+}
+
+static void print_slabs(const struct shell *shell)
+{
+    if (view.slab_count == 0U)
+    {
+        shell_print(shell, "Nenhum k_mem_slab definido.");
+        return;
+    }
+
+    shell_print(shell, "Slab        | Bloco  | Em uso      | Pico");
+    shell_print(shell, "------------|--------|-------------|-----");
+
+    for (uint8_t i = 0U; i < view.slab_count; i++)
+    {
+        const struct slab_sample *s = &view.slabs[i];
+
+        shell_print(shell, "%p | %6u | %5u/%-5u | %u", (void *)s->slab, s->block_size,
+                    s->used, s->num_blocks, s->max_used);
+    }
+}
+
+static void scan_stacks(void)
+{
+    uint32_t start = k_cycle_get_32();
+
+    thread_info_snapshot(&stacks, true);
+    scan_cycles = k_cycle_get_32() - start;
+    scan_uptime_ms = k_uptime_get();
+}
+
+static void print_stacks(const struct shell *shell)
+{
+    uint32_t total = 0U;
+    uint32_t reclaim = 0U;
+
+    if (stacks.count == 0U)
+    {
+        scan_stacks();
+    }
+
+    shell_print(shell, "Tarefa          |  Pico/Total   | Uso  | Sugerido");
+    shell_print(shell, "----------------|---------------|------|---------");
+
+    for (uint8_t i = 0U; i < stacks.count; i++)
+    {
+        const struct thread_info *info = &stacks.threads[i];
+        const uint32_t size = (uint32_t)info->stack_size;
+        const uint32_t used = (uint32_t)(info->stack_size - info->stack_unused);
+        const uint32_t pct = size > 0U ? used * 100U / size : 0U;
+        const uint32_t suggested = ROUND_UP(used + used * STACK_MARGIN_PCT / 100U, 8U);
+
+        total += size;
+        reclaim += size > suggested ? size - suggested : 0U;
+
+        shell_print(shell, "%-15s | %5u/%-6u | %3u%%%s | %u", info->name, used, size, pct,
+                    pct >= MEM_STACK_WARN_PCT ? "!" : " ", suggested);
+    }
+
+    shell_print(shell, "Pilhas: %u bytes, %u recuperáveis com %d%% de folga sobre o pico.",
+                total, reclaim, STACK_MARGIN_PCT);
+    shell_print(shell, "Varredura há %u ms, durou %u us.",
+                (uint32_t)(k_uptime_get() - scan_uptime_ms), k_cyc_to_us_ceil32(scan_cycles));
+}
+
+static int cmd_mem_show(const struct shell *shell, size_t argc, char **argv)
+{
+    k_mutex_lock(&mem_lock, K_FOREVER);
+    view = state;
+    k_mutex_unlock(&mem_lock);
+
+    if (view.samples == 0U)
+    {
+        shell_print(shell, "Sem amostras ainda, tente novamente em %d ms.", MEM_SAMPLE_PERIOD_MS);
+        return 0;
+    }
+
+    print_heaps(shell);
+    shell_print(shell, "");
+    print_slabs(shell);
+    shell_print(shell, "");
+    print_stacks(shell);
+
+    if (view.truncated)
+    {
+        shell_print(shell, "(mais de %d heaps ou %d slabs, lista truncada)", MEM_MAX_HEAPS,
+                    MEM_MAX_SLABS);
+    }
+
+    return 0;
+}
+
+static int cmd_mem_scan(const struct shell *shell, size_t argc, char **argv)
+{
+    scan_stacks();
+
+    return cmd_mem_show(shell, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_mem,
+    SHELL_CMD(scan, NULL, "Varre as pilhas agora e mostra o uso", cmd_mem_scan),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(mem, &sub_mem, "Uso de heap, slabs e pilhas", cmd_mem_show);
@@ -0,0 +1,34 @@
+/*
+ * Uso real de memória: heaps, slabs e pilhas.
+ *
+ * Um item de trabalho da system workqueue lê a cada MEM_SAMPLE_PERIOD_MS
+ * as estatísticas de execução de cada k_heap (livre, alocado, pico de
+ * alocação; CONFIG_SYS_HEAP_RUNTIME_STATS) e de cada k_mem_slab, e guarda
+ * o menor livre observado. Essas leituras são O(1). A varredura das pilhas
+ * (pico de uso de cada thread) percorre a região inteira de cada pilha e
+ * por isso não é periódica: é feita pela thread do shell em 'mem scan' (ou
+ * no primeiro 'mem'). Como as pilhas pintadas guardam o pico sozinhas, a
+ * varredura sob demanda não perde nada. O comando 'mem' lê o último retrato
+ * dos heaps e slabs e a última varredura das pilhas.
+ */
+
+#ifndef MEM_STATS_H_
+#define MEM_STATS_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/mem_stats.h>
+#include <stdint.h>
+
+#define MEM_SAMPLE_PERIOD_MS 1000
+#define MEM_MAX_HEAPS 4
+#define MEM_MAX_SLABS 8
+#define MEM_STACK_WARN_PCT 80   // pilhas acima disso aparecem marcadas
+
+/* Inicia a amostragem periódica. */
+void mem_stats_start(void);
+
+/* Estatísticas atuais do heap do sistema (k_malloc). Retorna -ENOTSUP se
+ * não houver heap do sistema ou estatísticas de execução. */
+int mem_stats_system_heap(struct sys_memory_stats *stats);
+
+#endif /* MEM_STATS_H_ */
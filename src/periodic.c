@@ -0,0 +1,383 @@
+#include "periodic.h"
+#include "trace.h"
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/counter.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(periodic, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+#define HAS_RELEASE_COUNTER DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, release_counter)
+#define RELEASE_ALARM_CHANNEL 0
+/* Um alarme absoluto até meia volta no passado é tratado como atrasado e
+ * dispara na hora (COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE), em vez de esperar
+ * o contador dar a volta. */
+#define RELEASE_GUARD_TICKS (UINT32_MAX / 2U)
+
+static struct periodic_task *tasks[PERIODIC_MAX_TASKS];
+static uint8_t task_count;
+static struct k_spinlock lock;
+/* A base de tempo só sobe no primeiro registro: sem tarefas periódicas
+ * (APP_LED_TIMER) o contador e o alarme ficam parados. */
+static K_MUTEX_DEFINE(start_lock);
+static bool started;
+
+/* Instantes comparados com aritmética modular: o contador dá a volta. */
+static inline bool is_due(uint32_t when, uint32_t now)
+{
+    return (int32_t)(when - now) <= 0;
+}
+
+#if HAS_RELEASE_COUNTER
+
+static const struct device *const counter =
+    DEVICE_DT_GET(DT_PHANDLE(ZEPHYR_USER_NODE, release_counter));
+
+static void release_alarm(const struct device *dev, uint8_t chan_id, uint32_t ticks,
+                          void *user_data);
+
+static inline uint32_t now_ticks(void)
+{
+    uint32_t ticks = 0U;
+
+    (void)counter_get_value(counter, &ticks);
+    return ticks;
+}
+
+static inline uint32_t us_to_ticks(uint32_t us)
+{
+    return counter_us_to_ticks(counter, us);
+}
+
+static inline uint32_t ticks_to_us(uint32_t ticks)
+{
+    return (uint32_t)counter_ticks_to_us(counter, ticks);
+}
+
+static void program_alarm(uint32_t when)
+{
+    const struct counter_alarm_cfg cfg = {
+        .callback = release_alarm,
+        .ticks = when,
+        .flags = COUNTER_ALARM_CFG_ABSOLUTE | COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE,
+    };
+
+    (void)counter_cancel_channel_alarm(counter, RELEASE_ALARM_CHANNEL);
+    (void)counter_set_channel_alarm(counter, RELEASE_ALARM_CHANNEL, &cfg);
+}
+
+#else
+
+static void release_timer_expired(struct k_timer *timer);
+K_TIMER_DEFINE(release_timer, release_timer_expired, NULL);
+
+static inline uint32_t now_ticks(void)
+{
+    return k_cycle_get_32();
+}
+
+static inline uint32_t us_to_ticks(uint32_t us)
+{
+    return k_us_to_cyc_ceil32(us);
+}
+
+static inline uint32_t ticks_to_us(uint32_t ticks)
+{
+    return k_cyc_to_us_floor32(ticks);
+}
+
+static void program_alarm(uint32_t when)
+{
+    int32_t delta = (int32_t)(when - now_ticks());
+
+    k_timer_start(&release_timer, K_USEC(delta > 0 ? ticks_to_us((uint32_t)delta) : 0),
+                  K_NO_WAIT);
+}
+
+#endif /* HAS_RELEASE_COUNTER */
+
+/* Programa o alarme para a liberação mais próxima. Chamada com 'lock'. */
+static void arm_next_release(void)
+{
+    if (task_count == 0U)
+    {
+        return;
+    }
+
+    uint32_t next = tasks[0]->next_release;
+
+    for (uint8_t i = 1U; i < task_count; i++)
+    {
+        if ((int32_t)(tasks[i]->next_release - next) < 0)
+        {
+            next = tasks[i]->next_release;
+        }
+    }
+
+    program_alarm(next);
+}
+
+/* Libera as tarefas vencidas e reprograma o alarme. Contexto de ISR. */
+static void release_due_tasks(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t now = now_ticks();
+
+    for (uint8_t i = 0U; i < task_count; i++)
+    {
+        struct periodic_task *task = tasks[i];
+
+        if (!is_due(task->next_release, now))
+        {
+            continue;
+        }
+
+        task->last_release = task->next_release;
+        task->next_release += task->period_ticks;
+        task->releases++;
+
+        /* Se o alarme chegou mais de um período atrasado, as liberações
+         * perdidas são contadas e não acumuladas. */
+        while (is_due(task->next_release, now))
+        {
+            task->next_release += task->period_ticks;
+            task->skipped++;
+            task->pending_skips++;
+        }
+
+        if (k_sem_count_get(&task->release) > 0U)
+        {
+            task->overruns++;
+        }
+        trace_sem_give(&task->release);
+    }
+
+    arm_next_release();
+    k_spin_unlock(&lock, key);
+}
+
+#if HAS_RELEASE_COUNTER
+static void release_alarm(const struct device *dev, uint8_t chan_id, uint32_t ticks,
+                          void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(chan_id);
+    ARG_UNUSED(ticks);
+    ARG_UNUSED(user_data);
+
+    release_due_tasks();
+}
+#else
+static void release_timer_expired(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    release_due_tasks();
+}
+#endif
+
+static void reset_stats(struct periodic_task *task)
+{
+    task->releases = 0U;
+    task->skipped = 0U;
+    task->overruns = 0U;
+    task->wakes = 0U;
+    task->max_latency_us = 0U;
+    task->sum_latency_us = 0U;
+    task->min_period_err_us = INT32_MAX;
+    task->max_period_err_us = INT32_MIN;
+}
+
+/* Sobe a base de tempo no primeiro registro. Contexto de thread. */
+static int start_release_base(void)
+{
+    int ret = 0;
+
+    k_mutex_lock(&start_lock, K_FOREVER);
+    if (started)
+    {
+        k_mutex_unlock(&start_lock);
+        return 0;
+    }
+
+#if HAS_RELEASE_COUNTER
+    if (!device_is_ready(counter))
+    {
+        LOG_ERR("Release counter %s not ready", counter->name);
+        ret = -ENODEV;
+    }
+    else if (counter_get_top_value(counter) != UINT32_MAX)
+    {
+        LOG_ERR("Release counter %s must be a free-running 32-bit counter", counter->name);
+        ret = -ENOTSUP;
+    }
+    else
+    {
+        ret = counter_set_guard_period(counter, RELEASE_GUARD_TICKS,
+                                       COUNTER_GUARD_PERIOD_LATE_TO_SET);
+        if (ret < 0)
+        {
+            LOG_ERR("Release counter %s: guard period not supported (%d)", counter->name,
+                    ret);
+        }
+        else
+        {
+            ret = counter_start(counter);
+        }
+    }
+
+    if (ret == 0)
+    {
+        LOG_INF("Periodic release on %s at %u Hz", counter->name,
+                counter_get_frequency(counter));
+    }
+#endif
+
+    started = ret == 0;
+    k_mutex_unlock(&start_lock);
+
+    return ret;
+}
+
+int periodic_register(struct periodic_task *task, const char *name, uint32_t period_us)
+{
+    if (period_us == 0U)
+    {
+        return -EINVAL;
+    }
+
+    int ret = start_release_base();
+
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (task_count >= PERIODIC_MAX_TASKS)
+    {
+        k_spin_unlock(&lock, key);
+        return -ENOMEM;
+    }
+
+    task->name = name;
+    k_sem_init(&task->release, 0, 1);
+    task->period_ticks = MAX(us_to_ticks(period_us), 1U);
+    task->next_release = now_ticks() + task->period_ticks;
+    task->last_release = task->next_release;
+    reset_stats(task);
+    task->pending_skips = 0U;
+    tasks[task_count++] = task;
+
+    arm_next_release();
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+int periodic_set_period(struct periodic_task *task, uint32_t period_us)
+{
+    if (period_us == 0U)
+    {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    /* A próxima liberação já programada é mantida; o novo período vale a
+     * partir dela. */
+    task->period_ticks = MAX(us_to_ticks(period_us), 1U);
+    reset_stats(task);
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+uint32_t periodic_get_period_us(const struct periodic_task *task)
+{
+    return ticks_to_us(task->period_ticks);
+}
+
+/* Diferença com sinal em microssegundos. */
+static int32_t signed_ticks_to_us(int32_t ticks)
+{
+    return ticks >= 0 ? (int32_t)ticks_to_us((uint32_t)ticks) : -(int32_t)ticks_to_us((uint32_t)-ticks);
+}
+
+uint32_t periodic_wait(struct periodic_task *task)
+{
+    (void)k_sem_take(&task->release, K_FOREVER);
+
+    uint32_t now = now_ticks();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t latency_us = ticks_to_us(now - task->last_release);
+    uint32_t skipped = task->pending_skips;
+
+    task->pending_skips = 0U;
+
+    if (task->wakes > 0U && skipped == 0U)
+    {
+        int32_t err = signed_ticks_to_us((int32_t)(now - task->last_wake - task->period_ticks));
+
+        task->min_period_err_us = MIN(task->min_period_err_us, err);
+        task->max_period_err_us = MAX(task->max_period_err_us, err);
+    }
+
+    task->last_wake = now;
+    task->wakes++;
+    task->max_latency_us = MAX(task->max_latency_us, latency_us);
+    task->sum_latency_us += latency_us;
+    k_spin_unlock(&lock, key);
+
+    return skipped;
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_periodic(const struct shell *shell, size_t argc, char **argv)
+{
+    struct periodic_task copy[PERIODIC_MAX_TASKS];
+    uint8_t count;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    count = task_count;
+    for (uint8_t i = 0U; i < count; i++)
+    {
+        copy[i] = *tasks[i];
+    }
+    k_spin_unlock(&lock, key);
+
+#if HAS_RELEASE_COUNTER
+    if (count == 0U)
+    {
+        shell_print(shell, "Base de tempo: %s parado, nenhuma tarefa registrada", counter->name);
+        return 0;
+    }
+    shell_print(shell, "Base de tempo: %s (%u Hz)", counter->name, counter_get_frequency(counter));
+#else
+    shell_print(shell, "Base de tempo: k_timer (resolução do tick do kernel)");
+#endif
+    shell_print(shell, "tarefa       | período us | liberações | puladas | overruns |"
+                       " latência méd/máx us | erro do período mín/máx us");
+
+    for (uint8_t i = 0U; i < count; i++)
+    {
+        const struct periodic_task *t = &copy[i];
+        uint32_t avg = t->wakes > 0U ? (uint32_t)(t->sum_latency_us / t->wakes) : 0U;
+        bool has_err = t->min_period_err_us <= t->max_period_err_us;
+
+        shell_print(shell, "%-12s | %10u | %10u | %7u | %8u | %8u / %-8u | %8d / %d",
+                    t->name, ticks_to_us(t->period_ticks), t->releases, t->skipped,
+                    t->overruns, avg, t->max_latency_us,
+                    has_err ? t->min_period_err_us : 0, has_err ? t->max_period_err_us : 0);
+    }
+
+    return 0;
+}
+
+SHELL_CMD_REGISTER(periodic, NULL, "Erro de período e latência das tarefas periódicas", cmd_periodic);
@@ -0,0 +1,57 @@
+/*
+ * Liberação periódica de tarefas por alarmes absolutos.
+ *
+ * Cada tarefa registrada tem o próximo instante de liberação em ticks de um
+ * contador de hardware (release-counter em zephyr,user, por exemplo o TIM2
+ * de 32 bits a 1 MHz). O instante seguinte é sempre o anterior mais o
+ * período, então o tempo de processamento não se acumula e a resolução não
+ * depende de CONFIG_SYS_CLOCK_TICKS_PER_SEC. Um único canal de alarme é
+ * programado para a liberação mais próxima entre todas as tarefas. O
+ * contador só é configurado e iniciado no primeiro periodic_register().
+ *
+ * Sem release-counter (native_sim) o mesmo esquema usa k_cycle_get_32() e
+ * um k_timer, com a resolução do tick do kernel.
+ */
+
+#ifndef PERIODIC_H_
+#define PERIODIC_H_
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+#define PERIODIC_MAX_TASKS 4
+
+struct periodic_task
+{
+    const char *name;
+    struct k_sem release;   // liberada pelo alarme
+    uint32_t period_ticks;
+    uint32_t next_release;  // instante absoluto, em ticks do contador
+    uint32_t last_release;  // liberação correspondente ao último k_sem_give
+    uint32_t last_wake;
+    uint32_t pending_skips; // liberações puladas desde o último periodic_wait()
+    /* Estatísticas (zeradas quando o período muda). */
+    uint32_t releases;
+    uint32_t skipped;       // liberações puladas porque o alarme chegou atrasado
+    uint32_t overruns;      // liberações com a anterior ainda não consumida
+    uint32_t wakes;
+    uint32_t max_latency_us; // liberação -> tarefa executando
+    uint64_t sum_latency_us;
+    int32_t min_period_err_us; // intervalo entre despertares - período
+    int32_t max_period_err_us;
+};
+
+/* Registra 'task' com o período em microssegundos. A primeira liberação
+ * acontece um período depois do registro. */
+int periodic_register(struct periodic_task *task, const char *name, uint32_t period_us);
+
+/* Troca o período a partir da próxima liberação. */
+int periodic_set_period(struct periodic_task *task, uint32_t period_us);
+
+uint32_t periodic_get_period_us(const struct periodic_task *task);
+
+/* Espera a próxima liberação. Retorna quantas liberações foram puladas
+ * desde a chamada anterior (0 quando a tarefa acompanha o período). */
+uint32_t periodic_wait(struct periodic_task *task);
+
+#endif /* PERIODIC_H_ */
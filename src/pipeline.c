@@ -0,0 +1,590 @@
+#include "pipeline.h"
+#include "capture.h"
+#include "calib.h"
+#include "boot_prof.h"
+
+#ifdef CONFIG_APP_REPLAY
+#include "replay.h"
+#endif
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/dac.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(pipeline, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+#define HAS_DAC DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, dac)
+#define DAC_CHANNEL_ID DT_PROP_OR(ZEPHYR_USER_NODE, dac_channel_id, 0)
+#define DAC_RESOLUTION DT_PROP_OR(ZEPHYR_USER_NODE, dac_resolution, 12)
+#define DAC_MAX_VALUE ((1 << DAC_RESOLUTION) - 1)
+
+#if HAS_DAC
+#define DAC_NODE DT_PHANDLE(ZEPHYR_USER_NODE, dac)
+static const struct device *const dac_dev = DEVICE_DT_GET(DAC_NODE);
+#endif /* HAS_DAC */
+
+/* Saída do DAC por DMA circular, disparada pelo mesmo TRGO do TIM8 que
+ * dispara o ADC (dmas "dac" em zephyr,user, acquisition.h). */
+#if HAS_DAC && defined(CONFIG_APP_ACQ_HW_TRIGGER) && DT_DMAS_HAS_NAME(ZEPHYR_USER_NODE, dac)
+#define HAS_DAC_DMA 1
+#else
+#define HAS_DAC_DMA 0
+#endif
+
+#if HAS_DAC_DMA
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/dma/dma_stm32.h>
+#include <stm32_ll_dac.h>
+#endif
+
+/* Topologia descrita no devicetree (dts/bindings/app,adc-pipeline.yaml). */
+#define PIPELINE_DT_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(app_adc_pipeline)
+#define HAS_PIPELINE_DT DT_HAS_COMPAT_STATUS_OKAY(app_adc_pipeline)
+
+#if HAS_PIPELINE_DT
+
+#define DT_FILTER_TYPE(node) ((enum filter_stage_type)DT_ENUM_IDX(node, filter))
+#define DT_NUM_COEFFS(node) DT_PROP_LEN_OR(node, coefficients, 0)
+
+/* Janela (MAVG), taps (FIR) ou seções (BIQUAD) do estágio do nó. */
+#define DT_STAGE_LEN(node)                                                                 \
+    (DT_FILTER_TYPE(node) == FILTER_STAGE_MAVG ?                                           \
+         DT_PROP_OR(node, window, CONFIG_APP_FILTER_DEFAULT_LEN) :                         \
+     DT_FILTER_TYPE(node) == FILTER_STAGE_BIQUAD ? DT_NUM_COEFFS(node) / FILTER_BIQUAD_COEFFS \
+                                                 : DT_NUM_COEFFS(node))
+
+#define DT_COEFF(node, prop, idx) ((float)(int32_t)DT_PROP_BY_IDX(node, prop, idx) / 1e6f)
+
+#define PIPELINE_DT_CHECK(node)                                                            \
+    BUILD_ASSERT(DT_PROP(node, channel) < ACQ_NUM_CHANNELS,                                \
+                 "app,adc-pipeline: channel outside io-channels");                         \
+    BUILD_ASSERT(DT_PROP(node, decimation) >= 1 &&                                         \
+                 DT_PROP(node, decimation) <= PIPELINE_MAX_DECIMATION,                     \
+                 "app,adc-pipeline: decimation out of range");                             \
+    BUILD_ASSERT(DT_STAGE_LEN(node) >= 1 &&                                                \
+                 DT_STAGE_LEN(node) <= (DT_FILTER_TYPE(node) == FILTER_STAGE_BIQUAD ?      \
+                                        FILTER_MAX_BIQUADS : FILTER_MAX_TAPS),             \
+                 "app,adc-pipeline: filter length exceeds CONFIG_APP_FILTER_MAX_TAPS");    \
+    BUILD_ASSERT(DT_FILTER_TYPE(node) != FILTER_STAGE_BIQUAD ||                            \
+                 DT_NUM_COEFFS(node) % FILTER_BIQUAD_COEFFS == 0,                          \
+                 "app,adc-pipeline: biquad needs 5 coefficients per section");
+
+DT_FOREACH_CHILD_STATUS_OKAY(PIPELINE_DT_NODE, PIPELINE_DT_CHECK)
+
+/* Sem canais repetidos: a soma dos bits dos canais só é igual ao OU deles
+ * se nenhum bit aparece duas vezes. */
+#define DT_CHANNEL_SUM(node) +BIT64(DT_PROP(node, channel))
+#define DT_CHANNEL_OR(node) | BIT64(DT_PROP(node, channel))
+
+BUILD_ASSERT((0 DT_FOREACH_CHILD_STATUS_OKAY(PIPELINE_DT_NODE, DT_CHANNEL_SUM)) ==
+                 (0 DT_FOREACH_CHILD_STATUS_OKAY(PIPELINE_DT_NODE, DT_CHANNEL_OR)),
+             "app,adc-pipeline: two nodes name the same channel");
+
+struct pipeline_dt_channel
+{
+    uint8_t channel;
+    enum pipeline_sink sink;
+    uint8_t dac_channel;
+    uint16_t decimation;
+    struct filter_config filter;
+};
+
+#define PIPELINE_DT_CHANNEL(node)                                                          \
+    {                                                                                      \
+        .channel = DT_PROP(node, channel),                                                 \
+        .sink = (enum pipeline_sink)DT_ENUM_IDX(node, sink),                               \
+        .dac_channel = DT_PROP_OR(node, dac_channel_id, DAC_CHANNEL_ID),                   \
+        .decimation = DT_PROP(node, decimation),                                           \
+        .filter = {                                                                        \
+            .num_stages = 1,                                                               \
+            .stages[0] = {                                                                 \
+                .type = DT_FILTER_TYPE(node),                                              \
+                .len = DT_STAGE_LEN(node),                                                 \
+                .coeffs = {COND_CODE_1(DT_NODE_HAS_PROP(node, coefficients),               \
+                                       (DT_FOREACH_PROP_ELEM_SEP(node, coefficients,       \
+                                                                 DT_COEFF, (,))),          \
+                                       ())},                                               \
+            },                                                                             \
+        },                                                                                 \
+    },
+
+/* Gerada em flash; pipeline_init() copia cada entrada para o canal. */
+static const struct pipeline_dt_channel dt_channels[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(PIPELINE_DT_NODE, PIPELINE_DT_CHANNEL)};
+
+#endif /* HAS_PIPELINE_DT */
+
+struct pipeline_channel pipelines[ACQ_NUM_CHANNELS];
+
+/* Sobreamostragem da entrada, comum a todos os canais (ver rate.h). */
+static uint8_t input_osr_log2;
+static uint8_t input_extra_bits;
+
+#if HAS_DAC_DMA
+#define DAC_LL_CHANNEL (DAC_CHANNEL_ID == 1 ? LL_DAC_CHANNEL_1 : LL_DAC_CHANNEL_2)
+#define DAC_DMA_STREAM DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, dac, channel)
+#define DAC_DMA_SLOT DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, dac, slot)
+#define DAC_DMA_CONFIG DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, dac, channel_config)
+
+static const struct device *const dac_dma_dev =
+    DEVICE_DT_GET(DT_DMAS_CTLR_BY_NAME(ZEPHYR_USER_NODE, dac));
+
+/* Uma metade por bloco da aquisição, com a paridade de block->seq: a
+ * metade de um bloco sai enquanto o ADC converte o bloco seq + 2, com o
+ * mesmo TRGO. As variáveis abaixo só são usadas pela tarefa de tempo real. */
+static uint16_t dac_buf[2][ACQ_BLOCK_LEN] __aligned(4);
+static uint16_t dac_hold;       // último valor escrito, repetido nos blocos sem saída
+static bool dac_block_written;  // algum canal escreveu no DAC no bloco em processamento
+static bool dac_dma_running;
+
+/* O driver chama o callback a cada meia transferência; a tarefa de tempo
+ * real lê a posição do DMA com dma_get_status(). */
+static void dac_dma_half_done(const struct device *dev, void *user_data, uint32_t channel,
+                              int status)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+    ARG_UNUSED(channel);
+    ARG_UNUSED(status);
+}
+
+static int dac_dma_arm(void)
+{
+    int err;
+
+    if (!device_is_ready(dac_dma_dev))
+    {
+        LOG_ERR("DAC DMA not ready");
+        return -ENODEV;
+    }
+
+    struct dma_block_config block = {
+        .source_address = (uint32_t)dac_buf,
+        .dest_address = LL_DAC_DMA_GetRegAddr(DAC, DAC_LL_CHANNEL,
+                                              LL_DAC_DMA_REG_DATA_12BITS_RIGHT_ALIGNED),
+        .block_size = sizeof(dac_buf),
+        .source_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+        .dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+        .source_reload_en = 1,
+        .dest_reload_en = 1,
+    };
+    struct dma_config dma_cfg = {
+        .dma_slot = DAC_DMA_SLOT,
+        .channel_direction = MEMORY_TO_PERIPHERAL,
+        .channel_priority = STM32_DMA_CONFIG_PRIORITY(DAC_DMA_CONFIG),
+        .source_data_size = sizeof(dac_buf[0][0]),
+        .dest_data_size = sizeof(dac_buf[0][0]),
+        .source_burst_length = 1,
+        .dest_burst_length = 1,
+        .cyclic = 1,
+        .block_count = 1,
+        .head_block = &block,
+        .dma_callback = dac_dma_half_done,
+    };
+
+    err = dma_config(dac_dma_dev, DAC_DMA_STREAM, &dma_cfg);
+    if (err == 0)
+    {
+        err = dma_start(dac_dma_dev, DAC_DMA_STREAM);
+    }
+    if (err < 0)
+    {
+        LOG_ERR("Could not start DAC DMA (%d)", err);
+        return err;
+    }
+    dac_dma_running = true;
+
+    return 0;
+}
+
+/* Liga o canal do DAC ao TRGO da aquisição com o DMA circular. A primeira
+ * chamada vem de pipeline_init(), antes de acq_start(), para que a
+ * primeira amostragem do ADC e a primeira atualização do DAC saiam do
+ * mesmo disparo. O gatilho é refeito a cada chamada porque
+ * dac_channel_setup() reconfigura o canal. */
+static int dac_dma_start(void)
+{
+    if (!dac_dma_running)
+    {
+        int err = dac_dma_arm();
+
+        if (err < 0)
+        {
+            return err;
+        }
+    }
+
+    LL_DAC_Disable(DAC, DAC_LL_CHANNEL);
+    LL_DAC_SetTriggerSource(DAC, DAC_LL_CHANNEL, LL_DAC_TRIG_EXT_TIM8_TRGO);
+    LL_DAC_EnableTrigger(DAC, DAC_LL_CHANNEL);
+    LL_DAC_EnableDMAReq(DAC, DAC_LL_CHANNEL);
+    LL_DAC_Enable(DAC, DAC_LL_CHANNEL);
+
+    return 0;
+}
+
+/* Escreve a metade do bloco 'seq' com as n saídas do canal espalhadas
+ * pelas ACQ_BLOCK_LEN amostragens (retenção de ordem zero). O prazo é o
+ * início do bloco seq + 2: se o DMA já está lendo essa metade, a tarefa
+ * atrasou e parte dela sai com os valores de dois blocos antes. */
+static void dac_dma_write(struct pipeline_stats *st, const uint16_t *values, size_t n,
+                          uint32_t seq)
+{
+    uint16_t *half = dac_buf[seq & 1U];
+    struct dma_status status;
+
+    if (dma_get_status(dac_dma_dev, DAC_DMA_STREAM, &status) == 0 &&
+        (status.pending_length > ACQ_BLOCK_LEN ? 0U : 1U) == (seq & 1U))
+    {
+        st->dac_late++;
+    }
+
+    for (size_t i = 0U; i < ACQ_BLOCK_LEN; i++)
+    {
+        half[i] = values[i * n / ACQ_BLOCK_LEN];
+    }
+    dac_hold = values[n - 1U];
+    dac_block_written = true;
+}
+
+/* Sem saída para o DAC no bloco (canal sem saída ou decimação maior que o
+ * bloco), a metade repete o último valor. */
+static void dac_dma_hold(uint32_t seq)
+{
+    if (dac_dma_running && !dac_block_written)
+    {
+        for (size_t i = 0U; i < ACQ_BLOCK_LEN; i++)
+        {
+            dac_buf[seq & 1U][i] = dac_hold;
+        }
+    }
+    dac_block_written = false;
+}
+#endif /* HAS_DAC_DMA */
+
+static int setup_dac_channel(uint8_t dac_channel)
+{
+#if defined(CONFIG_APP_REPLAY)
+    ARG_UNUSED(dac_channel);
+    return 0;
+#elif HAS_DAC
+    const struct dac_channel_cfg dac_ch_cfg = {
+        .channel_id = dac_channel,
+        .resolution = DAC_RESOLUTION,
+#if defined(CONFIG_DAC_BUFFER_NOT_SUPPORT)
+        .buffered = false,
+#else
+        .buffered = true,
+#endif /* CONFIG_DAC_BUFFER_NOT_SUPPORT */
+    };
+
+    if (!device_is_ready(dac_dev))
+    {
+        LOG_ERR("DAC device %s is not ready", dac_dev->name);
+        return -ENODEV;
+    }
+
+#if HAS_DAC_DMA
+    /* Só o canal de dac-channel-id tem DMA disparado pela aquisição. */
+    if (dac_channel != DAC_CHANNEL_ID)
+    {
+        return -ENOTSUP;
+    }
+#endif
+
+    int err = dac_channel_setup(dac_dev, &dac_ch_cfg);
+
+#if HAS_DAC_DMA
+    if (err == 0)
+    {
+        err = dac_dma_start();
+    }
+#endif
+
+    return err;
+#else
+    ARG_UNUSED(dac_channel);
+    return -ENOTSUP;
+#endif /* HAS_DAC */
+}
+
+int pipeline_init(uint16_t default_filter_len)
+{
+    struct filter_config cfg;
+    int err;
+
+    filter_config_mavg(&cfg, default_filter_len);
+
+    err = calib_init();
+    if (err < 0)
+    {
+        return err;
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(pipelines); i++)
+    {
+        struct pipeline_channel *ch = &pipelines[i];
+
+        err = filter_chain_init(&ch->chain, &cfg);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        ch->sink = PIPELINE_SINK_NONE;
+        ch->decimation = 1;
+        ch->requested_decimation = 1;
+        ch->reset_stats = true;
+    }
+
+#if HAS_PIPELINE_DT
+    for (size_t i = 0U; i < ARRAY_SIZE(dt_channels); i++)
+    {
+        const struct pipeline_dt_channel *dt = &dt_channels[i];
+        struct pipeline_channel *ch = &pipelines[dt->channel];
+
+        err = filter_chain_init(&ch->chain, &dt->filter);
+        if (err < 0)
+        {
+            LOG_ERR("Invalid devicetree filter for channel %u", dt->channel);
+            return err;
+        }
+
+        ch->decimation = dt->decimation;
+        ch->requested_decimation = dt->decimation;
+
+#if !HAS_DAC && !defined(CONFIG_APP_REPLAY)
+        if (dt->sink == PIPELINE_SINK_DAC)
+        {
+            continue; // sem DAC na placa: o canal fica sem saída
+        }
+#endif
+        err = pipeline_set_sink(dt->channel, dt->sink, dt->dac_channel);
+        if (err < 0)
+        {
+            LOG_ERR("Setting up of channel %u output failed with code %d", dt->channel, err);
+            return err;
+        }
+    }
+#elif HAS_DAC || defined(CONFIG_APP_REPLAY)
+    err = pipeline_set_sink(0, PIPELINE_SINK_DAC, DAC_CHANNEL_ID);
+    if (err < 0)
+    {
+        LOG_ERR("Setting up of DAC channel failed with code %d", err);
+        return err;
+    }
+#endif
+
+    return 0;
+}
+
+/* Entrega as amostras de saída ao destino do canal. A telemetria lê a
+ * saída direto do bloco publicado (block_bus.h). */
+static void sink_output(struct pipeline_channel *ch, const int32_t *out, size_t n,
+                        uint32_t seq)
+{
+    switch (ch->sink)
+    {
+    case PIPELINE_SINK_DAC:
+    {
+        uint16_t values[ACQ_BLOCK_LEN];
+
+        for (size_t k = 0U; k < n; k++)
+        {
+            /* Os bits extras da sobreamostragem não cabem no DAC. */
+            values[k] = (uint16_t)CLAMP(out[k] >> input_extra_bits, 0, DAC_MAX_VALUE);
+#if defined(CONFIG_APP_REPLAY)
+            replay_dac_write(ch->dac_channel, values[k]);
+#endif
+        }
+#if HAS_DAC_DMA
+        dac_dma_write(&ch->stats, values, n, seq);
+#elif HAS_DAC && !defined(CONFIG_APP_REPLAY)
+        /* Sem o disparo da aquisição, o DAC recebe uma amostra por bloco. */
+        ARG_UNUSED(seq);
+        (void)dac_write_value(dac_dev, ch->dac_channel, values[n - 1U]);
+#else
+        ARG_UNUSED(seq);
+#endif
+        boot_mark(BOOT_STAGE_FIRST_DAC);
+        break;
+    }
+    case PIPELINE_SINK_TELEMETRY:
+    case PIPELINE_SINK_NONE:
+    default:
+        break;
+    }
+}
+
+static void process_channel(struct pipeline_channel *ch, struct acq_block *block,
+                            size_t channel, bool differential)
+{
+    struct pipeline_stats *st = &ch->stats;
+    int32_t *work = block->out[channel]; // a saída fica no próprio bloco
+    size_t n_out = 0U;
+
+    if (ch->reset_stats)
+    {
+        st->samples_in = 0;
+        st->samples_out = 0;
+        st->min_out = INT32_MAX;
+        st->max_out = INT32_MIN;
+        st->dac_late = 0;
+        ch->reset_stats = false;
+    }
+
+    if (ch->requested_decimation != ch->decimation)
+    {
+        ch->decimation = ch->requested_decimation;
+        ch->decimation_count = 0;
+    }
+
+    (void)filter_chain_sync(&ch->chain);
+    (void)calib_sync(channel);
+
+    if (differential)
+    {
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+        {
+            work[n] = (int32_t)((int16_t)acq_sample(block, n, channel));
+        }
+    }
+    else
+    {
+        /* Offset, ganho e linearidade numa leitura por amostra (calib.h). */
+        const uint16_t *table = calib_table(channel);
+
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++)
+        {
+            work[n] = calib_apply(table, acq_sample(block, n, channel));
+        }
+    }
+
+    st->last_in = work[ACQ_BLOCK_LEN - 1];
+    st->samples_in += ACQ_BLOCK_LEN;
+
+    size_t n_in = ACQ_BLOCK_LEN;
+
+    if (input_osr_log2 > 0U)
+    {
+        n_in = cic_decimate(&ch->cic, input_osr_log2,
+                            CIC_ORDER * input_osr_log2 - input_extra_bits, work, n_in);
+    }
+
+    filter_chain_process(&ch->chain, work, n_in);
+    capture_block(channel, block, work, n_in);
+
+    /* Decimação: mantém uma de cada 'decimation' amostras filtradas (o
+     * filtro do canal faz o papel de anti-aliasing). */
+    for (size_t n = 0U; n < n_in; n++)
+    {
+        if (++ch->decimation_count < ch->decimation)
+        {
+            continue;
+        }
+        ch->decimation_count = 0;
+
+        int32_t y = work[n];
+
+        work[n_out++] = y;
+        st->min_out = MIN(st->min_out, y);
+        st->max_out = MAX(st->max_out, y);
+    }
+
+    if (n_out > 0U)
+    {
+        st->last_out = work[n_out - 1U];
+        st->samples_out += n_out;
+        sink_output(ch, work, n_out, block->seq);
+    }
+
+    block->n_out[channel] = (uint8_t)n_out;
+}
+
+void pipeline_process_block(struct acq_block *block)
+{
+    for (size_t i = 0U; i < ARRAY_SIZE(pipelines); i++)
+    {
+        process_channel(&pipelines[i], block, i, acq_channel(i)->channel_cfg.differential);
+    }
+
+#if HAS_DAC_DMA
+    dac_dma_hold(block->seq);
+#endif
+}
+
+void pipeline_set_oversampling(uint8_t osr_log2, uint8_t extra_bits)
+{
+    input_osr_log2 = osr_log2;
+    input_extra_bits = extra_bits;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(pipelines); i++)
+    {
+        memset(&pipelines[i].cic, 0, sizeof(pipelines[i].cic));
+    }
+}
+
+uint8_t pipeline_extra_bits(void)
+{
+    return input_extra_bits;
+}
+
+int pipeline_set_sink(size_t channel, enum pipeline_sink sink, uint8_t dac_channel)
+{
+    if (channel >= ARRAY_SIZE(pipelines))
+    {
+        return -EINVAL;
+    }
+
+    if (sink == PIPELINE_SINK_DAC)
+    {
+        int err = setup_dac_channel(dac_channel);
+
+        if (err < 0)
+        {
+            return err;
+        }
+        pipelines[channel].dac_channel = dac_channel;
+    }
+
+    pipelines[channel].sink = sink;
+
+    return 0;
+}
+
+int pipeline_set_decimation(size_t channel, uint16_t factor)
+{
+    if (channel >= ARRAY_SIZE(pipelines) || factor == 0 || factor > PIPELINE_MAX_DECIMATION)
+    {
+        return -EINVAL;
+    }
+
+    pipelines[channel].requested_decimation = factor;
+
+    return 0;
+}
+
+void pipeline_reset_stats(size_t channel)
+{
+    if (channel < ARRAY_SIZE(pipelines))
+    {
+        pipelines[channel].reset_stats = true;
+    }
+}
+
+const char *pipeline_sink_name(enum pipeline_sink sink)
+{
+    switch (sink)
+    {
+    case PIPELINE_SINK_DAC:
+        return "dac";
+    case PIPELINE_SINK_TELEMETRY:
+        return "telemetria";
+    default:
+        return "nenhuma";
+    }
+}
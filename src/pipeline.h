@@ -0,0 +1,89 @@
+/*
+ * Pipelines independentes por canal de io-channels.
+ *
+ * Cada canal tem a própria cadeia de filtros, decimação, saída (DAC,
+ * telemetria ou nenhuma) e estatísticas. Os blocos da aquisição chegam
+ * com os canais intercalados e são separados aqui. Com sobreamostragem,
+ * um decimador CIC antes da cadeia de filtros reduz a taxa e acrescenta
+ * bits de resolução às amostras. As amostras entram corrigidas pela
+ * tabela de calibração do canal (calib.h).
+ *
+ * Com CONFIG_APP_ACQ_HW_TRIGGER a saída do DAC é atualizada pelo mesmo
+ * TRGO do TIM8 que dispara o ADC, por DMA circular (dmas "dac" em
+ * zephyr,user): cada bloco de saída ocupa ACQ_BLOCK_LEN amostragens,
+ * com retenção de ordem zero das amostras decimadas, e sai um bloco depois
+ * de o bloco de entrada ficar pronto. Entrada e saída têm o mesmo clock,
+ * então a latência não varia. Só o canal de dac-channel-id pode ser
+ * saída. Sem a opção, o DAC recebe a última amostra de cada bloco.
+ */
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "acquisition.h"
+#include "filter.h"
+
+#define PIPELINE_MAX_DECIMATION 64
+
+enum pipeline_sink
+{
+    PIPELINE_SINK_NONE,
+    PIPELINE_SINK_DAC,
+    PIPELINE_SINK_TELEMETRY,
+};
+
+struct pipeline_stats
+{
+    uint32_t samples_in;
+    uint32_t samples_out;
+    int32_t last_in;  // última amostra de entrada, já corrigida (calib.h)
+    int32_t last_out; // última amostra filtrada e decimada (com os bits extras)
+    int32_t min_out;
+    int32_t max_out;
+    uint32_t dac_late; // blocos escritos no DAC depois do prazo (metade já em saída)
+};
+
+struct pipeline_channel
+{
+    struct cic_state cic;
+    struct filter_chain chain;
+    enum pipeline_sink sink;
+    uint8_t dac_channel;
+    uint16_t decimation;
+    uint16_t decimation_count;
+    uint16_t requested_decimation; // aplicada na fronteira de bloco
+    volatile bool reset_stats;
+    struct pipeline_stats stats;
+};
+
+extern struct pipeline_channel pipelines[ACQ_NUM_CHANNELS];
+
+/* Configura o DAC e inicializa os pipelines. Os canais descritos por um nó
+ * "app,adc-pipeline" no devicetree recebem o filtro, a decimação e a saída
+ * do nó; os demais, uma média móvel de 'default_filter_len' sem saída. Sem
+ * o nó, o canal 0 sai no canal do DAC definido em zephyr,user. */
+int pipeline_init(uint16_t default_filter_len);
+
+/* Processa um bloco da aquisição em todos os canais. As saídas de cada
+ * canal ficam em block->out e block->n_out. */
+void pipeline_process_block(struct acq_block *block);
+
+/* Configura o CIC de entrada de todos os canais: decimação por 2^osr_log2 e
+ * 'extra_bits' bits a mais nas amostras filtradas. Chamada pela tarefa de
+ * tempo real entre blocos (rate_sync()). */
+void pipeline_set_oversampling(uint8_t osr_log2, uint8_t extra_bits);
+
+uint8_t pipeline_extra_bits(void);
+
+int pipeline_set_sink(size_t channel, enum pipeline_sink sink, uint8_t dac_channel);
+
+int pipeline_set_decimation(size_t channel, uint16_t factor);
+
+/* Pede a limpeza das estatísticas; feita pela tarefa de tempo real no próximo bloco. */
+void pipeline_reset_stats(size_t channel);
+
+const char *pipeline_sink_name(enum pipeline_sink sink);
+
+#endif /* PIPELINE_H_ */
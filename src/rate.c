@@ -0,0 +1,140 @@
+#include "rate.h"
+#include "pipeline.h"
+#include "rt_stats.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+static struct rate_config current;
+static struct rate_config pending;
+static atomic_t has_pending;
+
+uint64_t rate_output_mhz(const struct rate_config *cfg)
+{
+    return 1000000000ULL / ((uint64_t)cfg->interval_us << rate_osr_log2(cfg));
+}
+
+uint32_t rate_min_interval_us(void)
+{
+    return MAX(RATE_MIN_INTERVAL_US, acq_min_interval_us());
+}
+
+void rate_init(uint32_t interval_us)
+{
+    current.interval_us = acq_interval_snap(CLAMP(interval_us, rate_min_interval_us(),
+                                                  RATE_MAX_INTERVAL_US));
+    current.extra_bits = 0U;
+    pipeline_set_oversampling(0U, 0U);
+}
+
+struct rate_config rate_current(void)
+{
+    return current;
+}
+
+int rate_plan(uint32_t out_hz, uint8_t extra_bits, struct rate_config *cfg)
+{
+    if (out_hz == 0U || extra_bits > RATE_MAX_EXTRA_BITS)
+    {
+        return -EINVAL;
+    }
+
+    uint64_t acq_hz = (uint64_t)out_hz << (2U * extra_bits);
+    uint64_t interval_us = (1000000U + acq_hz / 2U) / acq_hz;
+
+    if (interval_us < rate_min_interval_us() || interval_us > RATE_MAX_INTERVAL_US)
+    {
+        return -ERANGE;
+    }
+
+    /* O período que a aquisição produz, não o pedido: a taxa de saída
+     * mostrada e os orçamentos partem dele. */
+    cfg->interval_us = acq_interval_snap((uint32_t)interval_us);
+    if (cfg->interval_us > RATE_MAX_INTERVAL_US)
+    {
+        return -ERANGE;
+    }
+    cfg->extra_bits = extra_bits;
+
+    return 0;
+}
+
+/* Trabalho por bloco em unidades de amostra: a entrada (separação dos canais
+ * e CIC) percorre todas as amostragens; a cadeia de filtros só as decimadas. */
+static uint32_t block_work(const struct rate_config *cfg)
+{
+    return ACQ_BLOCK_LEN + MAX(ACQ_BLOCK_LEN >> rate_osr_log2(cfg), 1U);
+}
+
+int rate_estimate_exec_us(const struct rate_config *cfg, uint32_t *exec_us)
+{
+    struct rt_stats st;
+
+    rt_stats_snapshot(&st);
+    if (st.iterations == 0U)
+    {
+        return -EAGAIN;
+    }
+
+    /* Pior caso medido, escalado pela razão de trabalho por bloco. */
+    *exec_us = (uint32_t)k_cyc_to_us_ceil64((uint64_t)st.max_exec_cyc * block_work(cfg) /
+                                            block_work(&current));
+
+    return 0;
+}
+
+int rate_estimate_load(const struct rate_config *cfg, uint32_t *load_pct)
+{
+    uint32_t exec_us;
+    int err = rate_estimate_exec_us(cfg, &exec_us);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    uint64_t block_us = (uint64_t)cfg->interval_us * ACQ_BLOCK_LEN;
+
+    *load_pct = (uint32_t)((uint64_t)exec_us * 100U / block_us);
+
+    return 0;
+}
+
+int rate_request(const struct rate_config *cfg, bool check_budget)
+{
+    if (atomic_get(&has_pending))
+    {
+        return -EBUSY;
+    }
+
+    if (check_budget)
+    {
+        uint32_t load_pct;
+
+        if (rate_estimate_load(cfg, &load_pct) == 0 && load_pct > RATE_CPU_BUDGET_PCT)
+        {
+            return -EOVERFLOW;
+        }
+    }
+
+    pending = *cfg;
+    pending.interval_us = acq_interval_snap(cfg->interval_us); // o que rate_sync() vai ver no bloco
+    atomic_set(&has_pending, 1);
+    acq_set_interval(cfg->interval_us); // a aquisição troca no início do próximo bloco
+
+    return 0;
+}
+
+void rate_sync(const struct acq_block *block)
+{
+    if (!atomic_get(&has_pending) || block->interval_us != pending.interval_us)
+    {
+        return;
+    }
+
+    current = pending;
+    pipeline_set_oversampling(rate_osr_log2(&current), current.extra_bits);
+    rt_stats_reset();
+    atomic_clear(&has_pending);
+}
@@ -0,0 +1,79 @@
+/*
+ * Controle da taxa de amostragem.
+ *
+ * O usuário pede uma taxa de saída e quantos bits extras de resolução
+ * quer. O controlador escolhe a taxa de aquisição (saída * 4^bits) e o
+ * decimador CIC de entrada dos pipelines; cada fator 4 de sobreamostragem
+ * rende um bit efetivo. O STM32F4 não tem sobreamostragem no ADC, então
+ * toda a decimação é feita no CIC.
+ *
+ * Uma configuração só é aceita se o tempo de execução medido pelo rt_stats,
+ * escalado para a nova carga por bloco, couber em RATE_CPU_BUDGET_PCT do
+ * novo período de bloco. A troca é aplicada pela tarefa de tempo real no
+ * primeiro bloco adquirido com o novo período (rate_sync()).
+ *
+ * Os períodos são ajustados ao que a aquisição produz
+ * (acq_interval_snap()): exatos com o disparo pelo TIM8, múltiplos do
+ * tick do kernel com o temporizador do driver (100 us a 10 kHz, então
+ * 8 kHz viram 5 kHz).
+ */
+
+#ifndef RATE_H_
+#define RATE_H_
+
+#include <stdint.h>
+#include "acquisition.h"
+
+#define RATE_MIN_INTERVAL_US 10       // 100 kHz de aquisição, se a cadência permitir (rate_min_interval_us())
+#define RATE_MAX_INTERVAL_US 1000000  // 1 Hz
+#define RATE_MAX_EXTRA_BITS 3         // sobreamostragem de até 64x
+#define RATE_CPU_BUDGET_PCT 70
+
+struct rate_config
+{
+    uint32_t interval_us; // período de aquisição
+    uint8_t extra_bits;   // bits efetivos ganhos com a sobreamostragem
+};
+
+/* Fator de sobreamostragem (decimação do CIC) em log2. */
+static inline uint8_t rate_osr_log2(const struct rate_config *cfg)
+{
+    return (uint8_t)(2U * cfg->extra_bits);
+}
+
+/* Taxa de saída dos pipelines (antes da decimação de cada canal), em mHz. */
+uint64_t rate_output_mhz(const struct rate_config *cfg);
+
+/* Menor período aceito: RATE_MIN_INTERVAL_US ou a resolução da cadência
+ * da aquisição, o que for maior. */
+uint32_t rate_min_interval_us(void);
+
+/* Configura o estado inicial, antes do início da aquisição. */
+void rate_init(uint32_t interval_us);
+
+/* Configuração em uso pela tarefa de tempo real. */
+struct rate_config rate_current(void);
+
+/* Calcula a configuração para 'out_hz' com 'extra_bits', com o período que
+ * a aquisição produz. Retorna -ERANGE se a taxa de aquisição resultante
+ * estiver fora dos limites. */
+int rate_plan(uint32_t out_hz, uint8_t extra_bits, struct rate_config *cfg);
+
+/* Estima o pior tempo de execução por bloco da tarefa de tempo real com
+ * 'cfg'. Retorna -EAGAIN se ainda não há medida. */
+int rate_estimate_exec_us(const struct rate_config *cfg, uint32_t *exec_us);
+
+/* Estima a ocupação da CPU com 'cfg' em porcentagem. Retorna -EAGAIN se
+ * ainda não há medida da tarefa de tempo real. */
+int rate_estimate_load(const struct rate_config *cfg, uint32_t *load_pct);
+
+/* Pede a troca para 'cfg'. Com 'check_budget' a troca é recusada com
+ * -EOVERFLOW se a estimativa passar do orçamento. Retorna -EBUSY se a troca
+ * anterior ainda não foi aplicada. */
+int rate_request(const struct rate_config *cfg, bool check_budget);
+
+/* Aplica a troca pendente se 'block' já foi adquirido com o novo período.
+ * Chamada pela tarefa de tempo real antes de processar o bloco. */
+void rate_sync(const struct acq_block *block);
+
+#endif /* RATE_H_ */
@@ -0,0 +1,13 @@
+/*
+ * Destino do DAC no replay offline (CONFIG_APP_REPLAY): as escritas vão
+ * para o arquivo de saída em vez do hardware.
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <stdint.h>
+
+void replay_dac_write(uint8_t dac_channel, uint32_t value);
+
+#endif /* REPLAY_H_ */
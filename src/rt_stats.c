@@ -0,0 +1,204 @@
+#include "rt_stats.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+static struct rt_stats stats;
+static atomic_t stats_seq;        // ímpar enquanto a tarefa medida atualiza 'stats'
+static atomic_t reset_requested = ATOMIC_INIT(1);
+static atomic_t overrun_policy = ATOMIC_INIT(RT_OVERRUN_SKIP);
+static uint32_t last_release_cyc;
+
+static inline void stats_write_begin(void)
+{
+    atomic_inc(&stats_seq);
+}
+
+static inline void stats_write_end(void)
+{
+    atomic_inc(&stats_seq);
+}
+
+bool rt_stats_record(uint32_t period_us, uint32_t release_cyc,
+                     uint32_t start_cyc, uint32_t end_cyc)
+{
+    uint32_t period_cyc = (uint32_t)MIN(k_us_to_cyc_ceil64(period_us), UINT32_MAX);
+    uint32_t latency = start_cyc - release_cyc;
+    uint32_t exec = end_cyc - start_cyc;
+    uint32_t response = end_cyc - release_cyc;
+    bool missed = period_cyc > 0U && response > period_cyc;
+
+    stats_write_begin();
+
+    /* Mudança de período invalida o histograma, que é relativo ao período. */
+    if (atomic_clear(&reset_requested) != 0 || period_us != stats.period_us)
+    {
+        memset(&stats, 0, sizeof(stats));
+        stats.period_us = period_us;
+    }
+    else
+    {
+        uint32_t interval = release_cyc - last_release_cyc;
+        uint32_t jitter = interval > period_cyc ? interval - period_cyc : period_cyc - interval;
+
+        stats.max_jitter_cyc = MAX(stats.max_jitter_cyc, jitter);
+    }
+    last_release_cyc = release_cyc;
+
+    stats.iterations++;
+    stats.max_latency_cyc = MAX(stats.max_latency_cyc, latency);
+    stats.max_exec_cyc = MAX(stats.max_exec_cyc, exec);
+    stats.max_response_cyc = MAX(stats.max_response_cyc, response);
+    stats.sum_exec_cyc += exec;
+    if (missed)
+    {
+        stats.deadline_misses++;
+    }
+
+    if (period_cyc > 0U)
+    {
+        uint64_t bucket = ((uint64_t)response * RT_HIST_BUCKETS_PER_PERIOD) / period_cyc;
+
+        stats.hist[MIN(bucket, RT_HIST_BUCKETS - 1)]++;
+    }
+
+    stats_write_end();
+
+    return missed;
+}
+
+void rt_stats_count_skipped(uint32_t blocks)
+{
+    stats_write_begin();
+    stats.skipped_blocks += blocks;
+    stats_write_end();
+}
+
+void rt_stats_count_degrade(void)
+{
+    stats_write_begin();
+    stats.degrades++;
+    stats_write_end();
+}
+
+void rt_stats_snapshot(struct rt_stats *out)
+{
+    atomic_val_t seq;
+
+    /* A tarefa medida tem prioridade maior que o leitor; se ela atualizar
+     * durante a cópia, a cópia é refeita. */
+    do
+    {
+        seq = atomic_get(&stats_seq);
+        memcpy(out, &stats, sizeof(*out));
+    } while ((seq & 1) != 0 || seq != atomic_get(&stats_seq));
+}
+
+void rt_stats_reset(void)
+{
+    atomic_set(&reset_requested, 1);
+}
+
+uint32_t rt_stats_percentile_us(const struct rt_stats *st, uint32_t per_mille)
+{
+    uint32_t total = 0U;
+    uint32_t count = 0U;
+
+    for (size_t b = 0U; b < RT_HIST_BUCKETS; b++)
+    {
+        total += st->hist[b];
+    }
+
+    uint32_t target = (uint32_t)DIV_ROUND_UP((uint64_t)total * per_mille, 1000U);
+
+    for (size_t b = 0U; b < RT_HIST_BUCKETS; b++)
+    {
+        count += st->hist[b];
+        if (count >= target && count > 0U)
+        {
+            /* Limite superior do intervalo do histograma. */
+            return (uint32_t)(((uint64_t)(b + 1U) * st->period_us) / RT_HIST_BUCKETS_PER_PERIOD);
+        }
+    }
+
+    return 0U;
+}
+
+enum rt_overrun_policy rt_overrun_policy_get(void)
+{
+    return (enum rt_overrun_policy)atomic_get(&overrun_policy);
+}
+
+void rt_overrun_policy_set(enum rt_overrun_policy policy)
+{
+    atomic_set(&overrun_policy, policy);
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static const char *const policy_names[] = {"skip", "catchup", "degrade"};
+
+static int cmd_rt_stats_show(const struct shell *shell, size_t argc, char **argv)
+{
+    struct rt_stats st;
+
+    rt_stats_snapshot(&st);
+
+    shell_print(shell, "=== filter_task: prazo e jitter ===");
+    shell_print(shell, "Período (bloco): %u us", st.period_us);
+    shell_print(shell, "Iterações: %u", st.iterations);
+    shell_print(shell, "Prazos perdidos: %u", st.deadline_misses);
+    shell_print(shell, "Política de overrun: %s (blocos descartados: %u, degradações: %u)",
+                policy_names[rt_overrun_policy_get()], st.skipped_blocks, st.degrades);
+
+    if (st.iterations == 0U)
+    {
+        return 0;
+    }
+
+    shell_print(shell, "Latência de liberação máx: %u us", k_cyc_to_us_floor32(st.max_latency_cyc));
+    shell_print(shell, "Jitter do período máx: %u us", k_cyc_to_us_floor32(st.max_jitter_cyc));
+    shell_print(shell, "Execução média/máx: %u / %u us",
+                (uint32_t)k_cyc_to_us_floor64(st.sum_exec_cyc / st.iterations),
+                k_cyc_to_us_floor32(st.max_exec_cyc));
+    shell_print(shell, "Resposta máx: %u us", k_cyc_to_us_floor32(st.max_response_cyc));
+    shell_print(shell, "Resposta p50/p90/p99/p99.9: <=%u / <=%u / <=%u / <=%u us",
+                rt_stats_percentile_us(&st, 500), rt_stats_percentile_us(&st, 900),
+                rt_stats_percentile_us(&st, 990), rt_stats_percentile_us(&st, 999));
+
+    return 0;
+}
+
+static int cmd_rt_stats_reset(const struct shell *shell, size_t argc, char **argv)
+{
+    rt_stats_reset();
+    shell_print(shell, "Estatísticas zeradas no próximo período.");
+    return 0;
+}
+
+static int cmd_rt_stats_policy(const struct shell *shell, size_t argc, char **argv)
+{
+    for (size_t i = 0U; i < ARRAY_SIZE(policy_names); i++)
+    {
+        if (strcmp(argv[1], policy_names[i]) == 0)
+        {
+            rt_overrun_policy_set((enum rt_overrun_policy)i);
+            return 0;
+        }
+    }
+
+    shell_print(shell, "Política inválida. Use skip, catchup ou degrade.");
+    return -EINVAL;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_rt_stats,
+    SHELL_CMD(reset, NULL, "Zera as estatísticas", cmd_rt_stats_reset),
+    SHELL_CMD_ARG(policy, NULL, "Política de overrun: policy <skip|catchup|degrade>",
+                  cmd_rt_stats_policy, 2, 0),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(rt_stats, &sub_rt_stats, "Prazo, jitter e latência da tarefa de tempo real",
+                   cmd_rt_stats_show);
@@ -0,0 +1,64 @@
+/*
+ * Monitor de prazo e jitter da tarefa de tempo real hard.
+ *
+ * A cada período (um bloco da aquisição) a tarefa registra o instante de
+ * liberação (fim do bloco no ADC), o início e o fim do processamento. O
+ * monitor guarda piores casos, um histograma do tempo de resposta e as
+ * perdas de prazo. A escrita é feita só pela tarefa medida e nunca espera:
+ * o leitor (shell) copia os dados com um contador de sequência e repete a
+ * cópia se ela coincidir com uma atualização.
+ */
+
+#ifndef RT_STATS_H_
+#define RT_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RT_HIST_BUCKETS 32
+#define RT_HIST_BUCKETS_PER_PERIOD 16 // histograma cobre até 2 períodos
+
+enum rt_overrun_policy
+{
+    RT_OVERRUN_SKIP,     // descarta blocos atrasados e volta ao relógio de amostragem
+    RT_OVERRUN_CATCH_UP, // processa todos os blocos atrasados
+    RT_OVERRUN_DEGRADE,  // dobra o período de amostragem
+};
+
+struct rt_stats
+{
+    uint32_t period_us;
+    uint32_t iterations;
+    uint32_t deadline_misses;
+    uint32_t skipped_blocks;
+    uint32_t degrades;
+    uint32_t max_latency_cyc;  // liberação -> início do processamento
+    uint32_t max_exec_cyc;     // início -> fim do processamento
+    uint32_t max_response_cyc; // liberação -> fim
+    uint32_t max_jitter_cyc;   // desvio do intervalo entre liberações
+    uint64_t sum_exec_cyc;
+    uint32_t hist[RT_HIST_BUCKETS]; // tempo de resposta em frações do período
+};
+
+/* Registra uma iteração. Chamada apenas pela tarefa medida. Retorna true se
+ * o prazo (um período) foi perdido. */
+bool rt_stats_record(uint32_t period_us, uint32_t release_cyc,
+                     uint32_t start_cyc, uint32_t end_cyc);
+
+/* Conta blocos descartados ou degradações feitas pela política de overrun. */
+void rt_stats_count_skipped(uint32_t blocks);
+void rt_stats_count_degrade(void);
+
+/* Cópia consistente das estatísticas, sem bloquear a tarefa medida. */
+void rt_stats_snapshot(struct rt_stats *out);
+
+/* Pede a limpeza; aplicada pela tarefa medida na próxima iteração. */
+void rt_stats_reset(void);
+
+/* Percentil (0-1000, em milésimos) do tempo de resposta, em microssegundos. */
+uint32_t rt_stats_percentile_us(const struct rt_stats *st, uint32_t per_mille);
+
+enum rt_overrun_policy rt_overrun_policy_get(void);
+void rt_overrun_policy_set(enum rt_overrun_policy policy);
+
+#endif /* RT_STATS_H_ */
@@ -0,0 +1,318 @@
+#include "rtlog.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(rtlog, LOG_LEVEL_INF);
+
+#define RTLOG_STACK_SIZE 1024
+#define RTLOG_PRIORITY 12 // abaixo da telemetria e do espectro
+#define RTLOG_LINE_LEN 96
+#define RTLOG_BENCH_DEFAULT 1000
+#define RTLOG_BENCH_MAX 100000
+
+/* ISRs e threads sem anel próprio. */
+RTLOG_RING_DEFINE(shared, CONFIG_APP_RTLOG_RING_LEN);
+
+static struct rtlog_ring *rings; // anéis das threads, lidos pela thread de saída
+static struct k_spinlock rings_lock;
+static uint32_t interval_cyc;
+static atomic_t suppressed_total;
+
+void rtlog_attach(struct rtlog_ring *ring)
+{
+    k_spinlock_key_t key = k_spin_lock(&rings_lock);
+
+    ring->next = rings;
+    __atomic_store_n(&rings, ring, __ATOMIC_RELEASE);
+    k_spin_unlock(&rings_lock, key);
+
+    k_thread_custom_data_set(ring);
+}
+
+void rtlog_write(struct rtlog_site *site, int32_t arg0, int32_t arg1)
+{
+    const uint32_t now = k_cycle_get_32();
+
+    if (!site->unlimited && site->logged && now - site->last < interval_cyc)
+    {
+        (void)atomic_inc(&site->suppressed);
+        (void)atomic_inc(&suppressed_total);
+        return;
+    }
+
+    struct rtlog_ring *ring = k_is_in_isr() ? NULL : k_thread_custom_data_get();
+    const bool is_shared = ring == NULL;
+    unsigned int key = 0U;
+
+    if (is_shared)
+    {
+        ring = &shared;
+        key = irq_lock();
+    }
+
+    const uint32_t head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ring->len)
+    {
+        /* Sai na contagem do próximo registro do ponto. */
+        ring->dropped++;
+        (void)atomic_inc(&site->suppressed);
+    }
+    else
+    {
+        struct rtlog_record *rec = &ring->records[head & (ring->len - 1U)];
+
+        site->logged = true;
+        site->last = now;
+        rec->site = site;
+        rec->cycles = now;
+        rec->suppressed = (uint32_t)atomic_clear(&site->suppressed);
+        rec->args[0] = arg0;
+        rec->args[1] = arg1;
+        __atomic_store_n(&ring->head, head + 1U, __ATOMIC_RELEASE);
+    }
+
+    if (is_shared)
+    {
+        irq_unlock(key);
+    }
+}
+
+/* --- THREAD DE SAÍDA --- */
+
+static void emit(const struct rtlog_ring *ring, const struct rtlog_record *rec)
+{
+    char line[RTLOG_LINE_LEN];
+    char extra[32] = "";
+    const uint32_t age_us = k_cyc_to_us_floor32(k_cycle_get_32() - rec->cycles);
+
+    snprintk(line, sizeof(line), rec->site->fmt, rec->args[0], rec->args[1]);
+    if (rec->suppressed > 0U)
+    {
+        snprintk(extra, sizeof(extra), " (+%u suprimidas)", rec->suppressed);
+    }
+
+    switch (rec->site->level)
+    {
+    case RTLOG_LEVEL_ERR:
+        LOG_ERR("%s: %s%s, há %u us", ring->name, line, extra, age_us);
+        break;
+    case RTLOG_LEVEL_WRN:
+        LOG_WRN("%s: %s%s, há %u us", ring->name, line, extra, age_us);
+        break;
+    default:
+        LOG_INF("%s: %s%s, há %u us", ring->name, line, extra, age_us);
+        break;
+    }
+}
+
+static void drain(struct rtlog_ring *ring)
+{
+    uint32_t tail = ring->tail;
+
+    while (tail != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+    {
+        const struct rtlog_record rec = ring->records[tail & (ring->len - 1U)];
+
+        /* Libera a posição antes de formatar: o produtor não espera o log. */
+        __atomic_store_n(&ring->tail, ++tail, __ATOMIC_RELEASE);
+        emit(ring, &rec);
+    }
+}
+
+static void rtlog_task(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    while (1)
+    {
+        k_sleep(K_MSEC(CONFIG_APP_RTLOG_FLUSH_MS));
+
+        drain(&shared);
+        for (struct rtlog_ring *ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL;
+             ring = ring->next)
+        {
+            drain(ring);
+        }
+    }
+}
+
+K_THREAD_DEFINE(rtlog_tid, RTLOG_STACK_SIZE, rtlog_task, NULL, NULL, NULL, RTLOG_PRIORITY, 0, 0);
+
+static int rtlog_init(void)
+{
+    interval_cyc = k_ms_to_cyc_ceil32(CONFIG_APP_RTLOG_INTERVAL_MS);
+    return 0;
+}
+
+SYS_INIT(rtlog_init, POST_KERNEL, 0);
+
+/* --- COMANDOS DO SHELL --- */
+
+static void print_ring(const struct shell *shell, const struct rtlog_ring *ring)
+{
+    const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    shell_print(shell, "%-16s %10u %10u %10u", ring->name, head, head - tail, ring->dropped);
+}
+
+static int cmd_rtlog_status(const struct shell *shell, size_t argc, char **argv)
+{
+    shell_print(shell, "Registros de %zu bytes, no máximo 1 por ponto a cada %d ms",
+                sizeof(struct rtlog_record), CONFIG_APP_RTLOG_INTERVAL_MS);
+    shell_print(shell, "Chamadas suprimidas pelo limite de taxa: %u",
+                (uint32_t)atomic_get(&suppressed_total));
+    shell_print(shell, "%-16s %10s %10s %10s", "anel", "gravados", "pendentes", "perdidos");
+    print_ring(shell, &shared);
+    for (struct rtlog_ring *ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL;
+         ring = ring->next)
+    {
+        print_ring(shell, ring);
+    }
+
+    return 0;
+}
+
+/* O anel do benchmark nunca é registrado: os registros não vão para o log. */
+RTLOG_RING_DEFINE(bench, CONFIG_APP_RTLOG_RING_LEN);
+
+static struct rtlog_site bench_limited = {.fmt = "bench %d %d", .level = RTLOG_LEVEL_INF};
+static struct rtlog_site bench_storm = {
+    .fmt = "bench %d %d", .level = RTLOG_LEVEL_INF, .unlimited = true};
+
+struct bench_phase
+{
+    const char *name;
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+};
+
+/* Uma chamada com as interrupções bloqueadas: mede só o custo da chamada. */
+static uint32_t timed_write(struct rtlog_site *site, int32_t arg)
+{
+    unsigned int key = irq_lock();
+    const uint32_t t0 = k_cycle_get_32();
+
+    rtlog_write(site, arg, 0);
+
+    const uint32_t t1 = k_cycle_get_32();
+
+    irq_unlock(key);
+
+    return t1 - t0;
+}
+
+static uint32_t timing_overhead(void)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int i = 0; i < 16; i++)
+    {
+        unsigned int key = irq_lock();
+        const uint32_t t0 = k_cycle_get_32();
+        const uint32_t t1 = k_cycle_get_32();
+
+        irq_unlock(key);
+        best = MIN(best, t1 - t0);
+    }
+
+    return best;
+}
+
+static void phase_add(struct bench_phase *phase, uint32_t cyc, uint32_t overhead)
+{
+    cyc = cyc > overhead ? cyc - overhead : 0U;
+    phase->min = phase->calls == 0U ? cyc : MIN(phase->min, cyc);
+    phase->max = MAX(phase->max, cyc);
+    phase->sum += cyc;
+    phase->calls++;
+}
+
+static void bench_reset(void)
+{
+    bench.head = 0U;
+    bench.tail = 0U;
+    bench.dropped = 0U;
+    bench_limited.logged = false;
+    atomic_clear(&bench_limited.suppressed);
+    atomic_clear(&bench_storm.suppressed);
+}
+
+static int cmd_rtlog_bench(const struct shell *shell, size_t argc, char **argv)
+{
+    struct bench_phase phases[] = {
+        {.name = "gravação"},
+        {.name = "anel cheio"},
+        {.name = "suprimida"},
+    };
+    uint32_t n = argc > 1 ? (uint32_t)atoi(argv[1]) : RTLOG_BENCH_DEFAULT;
+    void *saved = k_thread_custom_data_get();
+    const uint32_t overhead = timing_overhead();
+    uint32_t worst = 0U;
+
+    if (n == 0U || n > RTLOG_BENCH_MAX)
+    {
+        shell_print(shell, "Chamadas: 1 a %d", RTLOG_BENCH_MAX);
+        return -EINVAL;
+    }
+
+    k_thread_custom_data_set(&bench);
+    bench_reset();
+
+    /* Tempestade: o anel enche e continua recebendo chamadas. */
+    for (uint32_t i = 0U; i < bench.len; i++)
+    {
+        phase_add(&phases[0], timed_write(&bench_storm, (int32_t)i), overhead);
+    }
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        phase_add(&phases[1], timed_write(&bench_storm, (int32_t)i), overhead);
+    }
+
+    /* Mesmo ponto com limite de taxa: só a primeira chamada grava. */
+    bench_reset();
+    (void)timed_write(&bench_limited, 0);
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        phase_add(&phases[2], timed_write(&bench_limited, (int32_t)i), overhead);
+    }
+
+    k_thread_custom_data_set(saved);
+    bench_reset();
+
+    shell_print(shell, "Custo por chamada em ciclos (%u Hz, medição de %u ciclos descontada)",
+                sys_clock_hw_cycles_per_sec(), overhead);
+    shell_print(shell, "%-12s %8s %8s %8s %8s", "caminho", "chamadas", "mín", "média", "máx");
+    for (size_t i = 0U; i < ARRAY_SIZE(phases); i++)
+    {
+        const struct bench_phase *phase = &phases[i];
+
+        shell_print(shell, "%-12s %8u %8u %8u %8u", phase->name, phase->calls, phase->min,
+                    (uint32_t)(phase->sum / phase->calls), phase->max);
+        worst = MAX(worst, phase->max);
+    }
+    shell_print(shell, "Pior caso: %u ciclos, orçamento %d: %s", worst, RTLOG_CALL_BUDGET_CYC,
+                worst <= RTLOG_CALL_BUDGET_CYC ? "OK" : "EXCEDIDO");
+
+    return worst <= RTLOG_CALL_BUDGET_CYC ? 0 : -EIO;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_rtlog,
+    SHELL_CMD(status, NULL, "Registros gravados, pendentes e perdidos por anel", cmd_rtlog_status),
+    SHELL_CMD_ARG(bench, NULL, "Custo de uma chamada sob tempestade: bench [chamadas]",
+                  cmd_rtlog_bench, 1, 1),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(rtlog, &sub_rtlog, "Log adiado das tarefas de tempo real", cmd_rtlog_status);
@@ -0,0 +1,137 @@
+/*
+ * Log binário adiado para as tarefas de tempo real.
+ *
+ * RTLOG_ERR/RTLOG_WRN/RTLOG_INF não formatam nada: gravam um registro
+ * compacto (ponto de chamada, k_cycle_get_32() e até RTLOG_MAX_ARGS
+ * inteiros) no anel da thread e retornam. Uma thread de baixa prioridade
+ * esvazia os anéis a cada CONFIG_APP_RTLOG_FLUSH_MS, formata os registros e
+ * os entrega ao subsistema de log.
+ *
+ * Cada thread de tempo real tem o próprio anel (RTLOG_RING_DEFINE() e
+ * rtlog_attach()): um produtor e um consumidor, sem lock. ISRs e threads
+ * sem anel usam um anel compartilhado, gravado com as interrupções
+ * bloqueadas durante a cópia do registro.
+ *
+ * Cada ponto de chamada grava no máximo um registro a cada
+ * CONFIG_APP_RTLOG_INTERVAL_MS; as chamadas descartadas nesse intervalo ou
+ * com o anel cheio são contadas e saem junto com o próximo registro do
+ * ponto ("+N suprimidas"). Uma chamada não tem laços nem chamadas ao
+ * kernel além de ler o contador de ciclos: o custo é limitado por
+ * RTLOG_CALL_BUDGET_CYC, verificado por 'rtlog bench'.
+ *
+ * Os argumentos são inteiros de 32 bits; cadeias não são copiadas. O
+ * formato deve ser literal. Sem CONFIG_APP_RTLOG, as macros viram
+ * LOG_ERR/LOG_WRN/LOG_INF do módulo que as chama.
+ */
+
+#ifndef RTLOG_H_
+#define RTLOG_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_APP_RTLOG
+
+#define RTLOG_MAX_ARGS 2
+#define RTLOG_CALL_BUDGET_CYC 300 // pior caso de uma chamada, em ciclos
+
+enum rtlog_level
+{
+    RTLOG_LEVEL_ERR,
+    RTLOG_LEVEL_WRN,
+    RTLOG_LEVEL_INF,
+};
+
+/* Estado de um ponto de chamada (um por macro expandida). */
+struct rtlog_site
+{
+    const char *fmt;
+    uint8_t level;
+    bool unlimited; // sem limite de taxa (benchmark)
+    bool logged;
+    uint32_t last;      // ciclos do último registro gravado
+    atomic_t suppressed; // chamadas descartadas desde o último registro
+};
+
+struct rtlog_record
+{
+    const struct rtlog_site *site;
+    uint32_t cycles;
+    uint32_t suppressed;
+    int32_t args[RTLOG_MAX_ARGS];
+};
+
+struct rtlog_ring
+{
+    const char *name;
+    struct rtlog_record *records;
+    uint32_t len;     // potência de 2
+    uint32_t head;    // escrito só pelo produtor
+    uint32_t tail;    // escrito só pela thread de saída
+    uint32_t dropped; // registros perdidos com o anel cheio
+    struct rtlog_ring *next;
+};
+
+#define RTLOG_RING_DEFINE(_name, _len)                                                     \
+    BUILD_ASSERT(IS_POWER_OF_TWO(_len), "rtlog ring length must be a power of 2");         \
+    static struct rtlog_record _name##_records[_len];                                      \
+    static struct rtlog_ring _name = {                                                     \
+        .name = #_name,                                                                    \
+        .records = _name##_records,                                                        \
+        .len = (_len),                                                                     \
+    }
+
+/* Associa o anel à thread corrente e o entrega à thread de saída. Chamada
+ * uma vez, no início da thread. */
+void rtlog_attach(struct rtlog_ring *ring);
+
+/* Grava um registro; use as macros. */
+void rtlog_write(struct rtlog_site *site, int32_t arg0, int32_t arg1);
+
+static inline __printf_like(1, 2) void z_rtlog_check(const char *fmt, ...)
+{
+    ARG_UNUSED(fmt);
+}
+
+#define Z_RTLOG_WRITE(_site, _arg0, _arg1, ...) rtlog_write(_site, (int32_t)(_arg0), (int32_t)(_arg1))
+
+#define Z_RTLOG(_level, _fmt, ...)                                                         \
+    do                                                                                     \
+    {                                                                                      \
+        static struct rtlog_site _rtlog_site = {.fmt = _fmt, .level = _level};             \
+                                                                                           \
+        if (false)                                                                         \
+        {                                                                                  \
+            z_rtlog_check(_fmt, ##__VA_ARGS__);                                            \
+        }                                                                                  \
+        Z_RTLOG_WRITE(&_rtlog_site, ##__VA_ARGS__, 0, 0);                                  \
+    } while (false)
+
+#define RTLOG_ERR(_fmt, ...) Z_RTLOG(RTLOG_LEVEL_ERR, _fmt, ##__VA_ARGS__)
+#define RTLOG_WRN(_fmt, ...) Z_RTLOG(RTLOG_LEVEL_WRN, _fmt, ##__VA_ARGS__)
+#define RTLOG_INF(_fmt, ...) Z_RTLOG(RTLOG_LEVEL_INF, _fmt, ##__VA_ARGS__)
+
+#else
+
+struct rtlog_ring
+{
+    int unused;
+};
+
+#define RTLOG_RING_DEFINE(_name, _len) static struct rtlog_ring _name
+
+static inline void rtlog_attach(struct rtlog_ring *ring)
+{
+    ARG_UNUSED(ring);
+}
+
+#define RTLOG_ERR(...) LOG_ERR(__VA_ARGS__)
+#define RTLOG_WRN(...) LOG_WRN(__VA_ARGS__)
+#define RTLOG_INF(...) LOG_INF(__VA_ARGS__)
+
+#endif /* CONFIG_APP_RTLOG */
+
+#endif /* RTLOG_H_ */
@@ -0,0 +1,611 @@
+#include "siggen.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(siggen, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+
+/* Backend por DMA: DAC com dmas/dma-names = "siggen" em zephyr,user (STM32F4). */
+#if DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, dmas) && \
+    DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, siggen_dac_channel_id) && \
+    defined(CONFIG_SOC_SERIES_STM32F4X)
+#define HAS_SIGGEN_DMA 1
+#else
+#define HAS_SIGGEN_DMA 0
+#endif
+
+#if HAS_SIGGEN_DMA
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+#include <zephyr/drivers/dac.h>
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/dma/dma_stm32.h>
+#include <stm32_ll_bus.h>
+#include <stm32_ll_dac.h>
+#include <stm32_ll_tim.h>
+#endif
+
+#define SINE_TABLE_LEN 256 // indexada pelos 8 bits mais altos da fase
+
+static int16_t sine_q15[SINE_TABLE_LEN];
+static struct siggen_config current;  // protegido por lock
+static uint32_t start_cyc;             // instante em que 'current' começou
+static struct k_spinlock lock;
+
+/* Seno por polinômio (sem libm), suficiente para uma tabela de 16 bits. */
+static float sin_poly(float x)
+{
+    const float pi = 3.14159265f;
+
+    /* Reduz para [-pi/2, pi/2] usando sin(pi - x) = sin(x). */
+    if (x > pi / 2.0f)
+    {
+        x = pi - x;
+    }
+    else if (x < -pi / 2.0f)
+    {
+        x = -pi - x;
+    }
+
+    float x2 = x * x;
+
+    return x * (1.0f - x2 / 6.0f * (1.0f - x2 / 20.0f * (1.0f - x2 / 42.0f *
+                (1.0f - x2 / 72.0f))));
+}
+
+static void init_sine_table(void)
+{
+    if (sine_q15[SINE_TABLE_LEN / 4] != 0)
+    {
+        return;
+    }
+
+    for (size_t i = 0U; i < SINE_TABLE_LEN; i++)
+    {
+        float x = 2.0f * 3.14159265f * (float)i / SINE_TABLE_LEN;
+
+        sine_q15[i] = (int16_t)(32767.0f * sin_poly(x > 3.14159265f ? x - 2.0f * 3.14159265f : x));
+    }
+}
+
+/* Código do DAC para a fase 'phase' (2^32 = um período). */
+static uint16_t wave_code(const struct siggen_config *cfg, uint32_t phase)
+{
+    int32_t value;
+    const int32_t amp = cfg->amplitude;
+
+    switch (cfg->wave)
+    {
+    case SIGGEN_SINE:
+    case SIGGEN_CHIRP:
+        value = cfg->offset + ((amp * sine_q15[phase >> 24]) >> 15);
+        break;
+    case SIGGEN_SQUARE:
+        value = cfg->offset + (phase < 0x80000000U ? amp : -amp);
+        break;
+    case SIGGEN_RAMP:
+        value = cfg->offset - amp + (int32_t)(((int64_t)2 * amp * (phase >> 16)) >> 16);
+        break;
+    case SIGGEN_DC:
+    default:
+        value = cfg->offset;
+        break;
+    }
+
+    return (uint16_t)CLAMP(value, 0, SIGGEN_MAX_CODE);
+}
+
+/* Amostras por período das formas periódicas: a tabela inteira, ou menos
+ * para frequências em que a taxa do DAC passaria de SIGGEN_MAX_RATE_HZ. */
+static uint32_t period_len(uint32_t freq_hz)
+{
+    return MIN(SIGGEN_BUF_LEN, SIGGEN_MAX_RATE_HZ / freq_hz);
+}
+
+static int validate(const struct siggen_config *cfg)
+{
+    if (cfg->offset > SIGGEN_MAX_CODE || cfg->amplitude > SIGGEN_MAX_CODE)
+    {
+        return -EINVAL;
+    }
+
+    switch (cfg->wave)
+    {
+    case SIGGEN_SINE:
+    case SIGGEN_SQUARE:
+    case SIGGEN_RAMP:
+        if (cfg->freq_hz == 0U || period_len(cfg->freq_hz) < SIGGEN_MIN_PERIOD_LEN)
+        {
+            return -EINVAL;
+        }
+        break;
+    case SIGGEN_CHIRP:
+        if (cfg->freq_hz == 0U || cfg->freq_end_hz == 0U || cfg->sweep_ms == 0U ||
+            MAX(cfg->freq_hz, cfg->freq_end_hz) >
+                SIGGEN_CHIRP_RATE_HZ / SIGGEN_MIN_PERIOD_LEN)
+        {
+            return -EINVAL;
+        }
+        break;
+    case SIGGEN_OFF:
+    case SIGGEN_DC:
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+#if HAS_SIGGEN_DMA
+
+#define SIGGEN_DAC_CHANNEL DT_PROP(ZEPHYR_USER_NODE, siggen_dac_channel_id)
+#define SIGGEN_LL_CHANNEL (SIGGEN_DAC_CHANNEL == 1 ? LL_DAC_CHANNEL_1 : LL_DAC_CHANNEL_2)
+#define SIGGEN_DMA_STREAM DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, siggen, channel)
+#define SIGGEN_DMA_SLOT DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, siggen, slot)
+#define SIGGEN_DMA_CONFIG DT_DMAS_CELL_BY_NAME(ZEPHYR_USER_NODE, siggen, channel_config)
+
+static const struct device *const dac_dev = DEVICE_DT_GET(DT_PHANDLE(ZEPHYR_USER_NODE, dac));
+static const struct device *const dma_dev =
+    DEVICE_DT_GET(DT_DMAS_CTLR_BY_NAME(ZEPHYR_USER_NODE, siggen));
+
+static uint16_t dma_buf[SIGGEN_BUF_LEN] __aligned(4);
+static bool hw_ready;
+static bool dma_running;
+static atomic_t half_refills;
+static struct siggen_config dma_wave; // forma em curso no DMA (lida nas interrupções)
+
+/* Acumulador de fase do chirp (DDS), usado só nas interrupções do DMA. */
+static struct
+{
+    uint32_t phase;
+    uint32_t inc;      // incremento de fase por amostra
+    int32_t inc_step;  // variação do incremento por amostra
+    uint32_t inc_start;
+    uint32_t left;     // amostras até recomeçar a varredura
+    uint32_t sweep_len;
+} dds;
+
+static uint32_t phase_inc(uint32_t freq_hz, uint32_t rate_hz)
+{
+    return (uint32_t)(((uint64_t)freq_hz << 32) / rate_hz);
+}
+
+static void chirp_fill(uint16_t *buf, size_t n)
+{
+    for (size_t i = 0U; i < n; i++)
+    {
+        if (dds.left-- == 0U)
+        {
+            dds.left = dds.sweep_len - 1U;
+            dds.inc = dds.inc_start;
+        }
+        buf[i] = wave_code(&dma_wave, dds.phase);
+        dds.phase += dds.inc;
+        dds.inc += dds.inc_step;
+    }
+}
+
+/* Meia transferência (DMA_STATUS_BLOCK) ou transferência completa: a metade
+ * que acabou de sair é recalculada enquanto o DMA envia a outra. */
+static void dma_half_done(const struct device *dev, void *user_data, uint32_t channel,
+                          int status)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+    ARG_UNUSED(channel);
+
+    atomic_inc(&half_refills);
+
+    if (dma_wave.wave != SIGGEN_CHIRP || status < 0)
+    {
+        return;
+    }
+
+    chirp_fill(status == DMA_STATUS_BLOCK ? &dma_buf[0] : &dma_buf[SIGGEN_BUF_LEN / 2U],
+               SIGGEN_BUF_LEN / 2U);
+}
+
+/* TIM6 dispara o DAC a 'rate_hz'. Retorna a taxa obtida. */
+static uint32_t timer_start(uint32_t rate_hz)
+{
+    const struct device *const clk = DEVICE_DT_GET(STM32_CLOCK_CONTROL_NODE);
+    struct stm32_pclken pclken = {
+        .bus = STM32_CLOCK_BUS_APB1,
+        .enr = LL_APB1_GRP1_PERIPH_TIM6,
+    };
+    uint32_t bus_hz = 0U;
+
+    (void)clock_control_on(clk, (clock_control_subsys_t)&pclken);
+    (void)clock_control_get_rate(clk, (clock_control_subsys_t)&pclken, &bus_hz);
+
+    /* Com prescaler de APB1 diferente de 1 o clock dos timers é o dobro. */
+    uint32_t tim_hz = STM32_APB1_PRESCALER > 1 ? 2U * bus_hz : bus_hz;
+    uint32_t ticks = MAX(tim_hz / rate_hz, 1U);
+    uint32_t psc = (ticks - 1U) / 65536U;
+    uint32_t arr = ticks / (psc + 1U) - 1U;
+
+    LL_TIM_DisableCounter(TIM6);
+    LL_TIM_SetPrescaler(TIM6, psc);
+    LL_TIM_SetAutoReload(TIM6, arr);
+    LL_TIM_SetTriggerOutput(TIM6, LL_TIM_TRGO_UPDATE);
+    LL_TIM_GenerateEvent_UPDATE(TIM6);
+    LL_TIM_EnableCounter(TIM6);
+
+    return tim_hz / ((psc + 1U) * (arr + 1U));
+}
+
+static void hw_stop(void)
+{
+    if (dma_running)
+    {
+        (void)dma_stop(dma_dev, SIGGEN_DMA_STREAM);
+        dma_running = false;
+    }
+    LL_TIM_DisableCounter(TIM6);
+
+    /* Sem gatilho a escrita em DHR vai direto para a saída. */
+    LL_DAC_Disable(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_DisableDMAReq(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_DisableTrigger(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_Enable(DAC, SIGGEN_LL_CHANNEL);
+}
+
+static int hw_init(void)
+{
+    const struct dac_channel_cfg cfg = {
+        .channel_id = SIGGEN_DAC_CHANNEL,
+        .resolution = 12,
+        .buffered = true,
+    };
+
+    if (hw_ready)
+    {
+        return 0;
+    }
+
+    if (!device_is_ready(dac_dev) || !device_is_ready(dma_dev))
+    {
+        LOG_ERR("DAC or DMA for the signal generator not ready");
+        return -ENODEV;
+    }
+
+    int err = dac_channel_setup(dac_dev, &cfg);
+
+    if (err == 0)
+    {
+        hw_ready = true;
+    }
+
+    return err;
+}
+
+static int hw_start(const struct siggen_config *cfg)
+{
+    int err = hw_init();
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    hw_stop();
+    dma_wave = *cfg;
+
+    if (cfg->wave == SIGGEN_DC || cfg->wave == SIGGEN_OFF)
+    {
+        return dac_write_value(dac_dev, SIGGEN_DAC_CHANNEL, cfg->offset);
+    }
+
+    uint32_t len;
+    uint32_t rate_hz;
+
+    if (cfg->wave == SIGGEN_CHIRP)
+    {
+        /* Varredura linear de freq_hz a freq_end_hz em sweep_ms, recomeçando. */
+        len = SIGGEN_BUF_LEN;
+        rate_hz = SIGGEN_CHIRP_RATE_HZ;
+        dds.sweep_len = MAX((uint32_t)((uint64_t)rate_hz * cfg->sweep_ms / 1000U), 1U);
+        dds.inc_start = phase_inc(cfg->freq_hz, rate_hz);
+        dds.inc_step = (int32_t)(((int64_t)phase_inc(cfg->freq_end_hz, rate_hz) -
+                                  dds.inc_start) / (int64_t)dds.sweep_len);
+        dds.inc = dds.inc_start;
+        dds.phase = 0U;
+        dds.left = dds.sweep_len;
+        chirp_fill(dma_buf, len);
+    }
+    else
+    {
+        /* Um período na tabela; o DMA circular repete sem a CPU. */
+        len = period_len(cfg->freq_hz);
+        rate_hz = cfg->freq_hz * len;
+        for (uint32_t i = 0U; i < len; i++)
+        {
+            dma_buf[i] = wave_code(cfg, (uint32_t)(((uint64_t)i << 32) / len));
+        }
+    }
+
+    struct dma_block_config block = {
+        .source_address = (uint32_t)dma_buf,
+        .dest_address = LL_DAC_DMA_GetRegAddr(DAC, SIGGEN_LL_CHANNEL,
+                                              LL_DAC_DMA_REG_DATA_12BITS_RIGHT_ALIGNED),
+        .block_size = len * sizeof(dma_buf[0]),
+        .source_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+        .dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+        .source_reload_en = 1,
+        .dest_reload_en = 1,
+    };
+    struct dma_config dma_cfg = {
+        .dma_slot = SIGGEN_DMA_SLOT,
+        .channel_direction = MEMORY_TO_PERIPHERAL,
+        .channel_priority = STM32_DMA_CONFIG_PRIORITY(SIGGEN_DMA_CONFIG),
+        .source_data_size = sizeof(dma_buf[0]),
+        .dest_data_size = sizeof(dma_buf[0]),
+        .source_burst_length = 1,
+        .dest_burst_length = 1,
+        .cyclic = 1,
+        .block_count = 1,
+        .head_block = &block,
+        .dma_callback = dma_half_done,
+    };
+
+    err = dma_config(dma_dev, SIGGEN_DMA_STREAM, &dma_cfg);
+    if (err == 0)
+    {
+        err = dma_start(dma_dev, SIGGEN_DMA_STREAM);
+    }
+    if (err < 0)
+    {
+        LOG_ERR("Could not start generator DMA (%d)", err);
+        return err;
+    }
+    dma_running = true;
+
+    LL_DAC_Disable(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_SetTriggerSource(DAC, SIGGEN_LL_CHANNEL, LL_DAC_TRIG_EXT_TIM6_TRGO);
+    LL_DAC_EnableTrigger(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_EnableDMAReq(DAC, SIGGEN_LL_CHANNEL);
+    LL_DAC_Enable(DAC, SIGGEN_LL_CHANNEL);
+
+    uint32_t actual_hz = timer_start(rate_hz);
+
+    if (actual_hz != rate_hz)
+    {
+        LOG_INF("DAC update rate %u Hz (asked %u Hz)", actual_hz, rate_hz);
+    }
+
+    return 0;
+}
+
+#endif /* HAS_SIGGEN_DMA */
+
+int siggen_start(const struct siggen_config *cfg)
+{
+    int err = validate(cfg);
+
+    if (err < 0)
+    {
+        return err;
+    }
+
+    init_sine_table();
+
+    /* Lido antes da escrita no DAC: a latência medida inclui a escrita. */
+    const uint32_t now = k_cycle_get_32();
+
+#if HAS_SIGGEN_DMA
+    err = hw_start(cfg);
+    if (err < 0)
+    {
+        return err;
+    }
+#elif !defined(CONFIG_ADC_EMUL)
+    return -ENOTSUP;
+#endif
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    current = *cfg;
+    start_cyc = now;
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+void siggen_stop(void)
+{
+    const struct siggen_config off = {.wave = SIGGEN_OFF};
+
+    (void)siggen_start(&off);
+}
+
+uint32_t siggen_step(uint16_t code)
+{
+    const struct siggen_config dc = {.wave = SIGGEN_DC, .offset = MIN(code, SIGGEN_MAX_CODE)};
+
+    (void)siggen_start(&dc);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t when = start_cyc;
+
+    k_spin_unlock(&lock, key);
+
+    return when;
+}
+
+struct siggen_config siggen_current(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct siggen_config cfg = current;
+
+    k_spin_unlock(&lock, key);
+
+    return cfg;
+}
+
+uint16_t siggen_emul_code(uint32_t cycles)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct siggen_config cfg = current;
+    uint32_t elapsed = cycles - start_cyc;
+
+    k_spin_unlock(&lock, key);
+
+    const uint32_t cyc_hz = sys_clock_hw_cycles_per_sec();
+    uint32_t phase;
+
+    switch (cfg.wave)
+    {
+    case SIGGEN_SINE:
+    case SIGGEN_SQUARE:
+    case SIGGEN_RAMP:
+    {
+        uint32_t period_cyc = MAX(cyc_hz / cfg.freq_hz, 1U);
+
+        phase = (uint32_t)(((uint64_t)(elapsed % period_cyc) << 32) / period_cyc);
+        break;
+    }
+    case SIGGEN_CHIRP:
+    {
+        /* Fase de uma varredura linear: f0 t + (f1 - f0) t^2 / (2 T). */
+        uint32_t sweep_cyc = (uint32_t)((uint64_t)cyc_hz * cfg.sweep_ms / 1000U);
+        float t = (float)(elapsed % MAX(sweep_cyc, 1U)) / (float)cyc_hz;
+        float sweep_s = (float)cfg.sweep_ms / 1000.0f;
+        float cycles_done = (float)cfg.freq_hz * t +
+                            ((float)cfg.freq_end_hz - (float)cfg.freq_hz) * t * t /
+                                (2.0f * sweep_s);
+
+        phase = (uint32_t)((cycles_done - (float)(uint32_t)cycles_done) * 4294967296.0f);
+        break;
+    }
+    case SIGGEN_OFF:
+        return SIGGEN_MAX_CODE / 2U;
+    default:
+        phase = 0U;
+        break;
+    }
+
+    return wave_code(&cfg, phase);
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static const char *const wave_names[] = {"off", "dc", "sine", "square", "ramp", "chirp"};
+
+static int report(const struct shell *shell, int err)
+{
+    if (err == -ENOTSUP)
+    {
+        shell_print(shell, "Sem backend: é preciso DAC com DMA (dmas 'siggen' em zephyr,user) "
+                    "ou o emulador de ADC.");
+    }
+    else if (err < 0)
+    {
+        shell_print(shell, "Parâmetros inválidos (%d). Periódicas até %d Hz, chirp até %d Hz, "
+                    "códigos até %d.", err, SIGGEN_MAX_RATE_HZ / SIGGEN_MIN_PERIOD_LEN,
+                    SIGGEN_CHIRP_RATE_HZ / SIGGEN_MIN_PERIOD_LEN, SIGGEN_MAX_CODE);
+    }
+    return err;
+}
+
+static int cmd_gen_periodic(const struct shell *shell, size_t argc, char **argv)
+{
+    struct siggen_config cfg = {
+        .freq_hz = (uint32_t)atoi(argv[1]),
+        .amplitude = argc > 2 ? (uint16_t)atoi(argv[2]) : SIGGEN_MAX_CODE / 4U,
+        .offset = argc > 3 ? (uint16_t)atoi(argv[3]) : SIGGEN_MAX_CODE / 2U,
+    };
+
+    if (strcmp(argv[0], "sine") == 0)
+    {
+        cfg.wave = SIGGEN_SINE;
+    }
+    else if (strcmp(argv[0], "square") == 0)
+    {
+        cfg.wave = SIGGEN_SQUARE;
+    }
+    else
+    {
+        cfg.wave = SIGGEN_RAMP;
+    }
+
+    return report(shell, siggen_start(&cfg));
+}
+
+static int cmd_gen_chirp(const struct shell *shell, size_t argc, char **argv)
+{
+    struct siggen_config cfg = {
+        .wave = SIGGEN_CHIRP,
+        .freq_hz = (uint32_t)atoi(argv[1]),
+        .freq_end_hz = (uint32_t)atoi(argv[2]),
+        .sweep_ms = (uint32_t)atoi(argv[3]),
+        .amplitude = argc > 4 ? (uint16_t)atoi(argv[4]) : SIGGEN_MAX_CODE / 4U,
+        .offset = SIGGEN_MAX_CODE / 2U,
+    };
+
+    return report(shell, siggen_start(&cfg));
+}
+
+static int cmd_gen_dc(const struct shell *shell, size_t argc, char **argv)
+{
+    const struct siggen_config cfg = {.wave = SIGGEN_DC, .offset = (uint16_t)atoi(argv[1])};
+
+    return report(shell, siggen_start(&cfg));
+}
+
+static int cmd_gen_off(const struct shell *shell, size_t argc, char **argv)
+{
+    siggen_stop();
+    return 0;
+}
+
+static int cmd_gen_status(const struct shell *shell, size_t argc, char **argv)
+{
+    struct siggen_config cfg = siggen_current();
+
+    shell_print(shell, "Gerador: %s", wave_names[cfg.wave]);
+    switch (cfg.wave)
+    {
+    case SIGGEN_SINE:
+    case SIGGEN_SQUARE:
+    case SIGGEN_RAMP:
+        shell_print(shell, "%u Hz, %u amostras por período, amplitude %u, nível %u",
+                    cfg.freq_hz, period_len(cfg.freq_hz), cfg.amplitude, cfg.offset);
+        break;
+    case SIGGEN_CHIRP:
+        shell_print(shell, "%u -> %u Hz em %u ms, amplitude %u", cfg.freq_hz, cfg.freq_end_hz,
+                    cfg.sweep_ms, cfg.amplitude);
+        break;
+    case SIGGEN_DC:
+        shell_print(shell, "Nível %u", cfg.offset);
+        break;
+    default:
+        break;
+    }
+#if HAS_SIGGEN_DMA
+    shell_print(shell, "Interrupções do DMA (meias transferências): %u",
+                (uint32_t)atomic_get(&half_refills));
+#elif defined(CONFIG_ADC_EMUL)
+    shell_print(shell, "Saída ligada ao canal 0 do ADC emulado");
+#endif
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_gen,
+    SHELL_CMD_ARG(sine, NULL, "sine <hz> [amplitude] [nível]", cmd_gen_periodic, 2, 2),
+    SHELL_CMD_ARG(square, NULL, "square <hz> [amplitude] [nível]", cmd_gen_periodic, 2, 2),
+    SHELL_CMD_ARG(ramp, NULL, "ramp <hz> [amplitude] [nível]", cmd_gen_periodic, 2, 2),
+    SHELL_CMD_ARG(chirp, NULL, "chirp <hz_ini> <hz_fim> <ms> [amplitude]", cmd_gen_chirp, 4, 1),
+    SHELL_CMD_ARG(dc, NULL, "dc <código>", cmd_gen_dc, 2, 0),
+    SHELL_CMD(off, NULL, "Desliga o gerador", cmd_gen_off),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(gen, &sub_gen, "Gerador de sinais no DAC (DMA)", cmd_gen_status);
@@ -0,0 +1,66 @@
+/*
+ * Gerador de sinais no segundo canal do DAC.
+ *
+ * As formas periódicas (senoide, quadrada, rampa) são pré-calculadas numa
+ * tabela com um período e enviadas ao DAC por DMA circular, disparado pelo
+ * TIM6 (TRGO a cada atualização): a CPU não faz nada por amostra. O chirp
+ * usa o mesmo buffer como buffer duplo: nas interrupções de meia
+ * transferência e de transferência completa a metade que acabou de sair é
+ * recalculada por um acumulador de fase (DDS), uma vez a cada
+ * SIGGEN_BUF_LEN / 2 amostras.
+ *
+ * No native_sim não há DAC: o emulador do ADC lê o valor do gerador no
+ * instante de cada conversão (siggen_emul_code()), o que equivale a ligar
+ * a saída do gerador ao canal 0 de io-channels.
+ */
+
+#ifndef SIGGEN_H_
+#define SIGGEN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIGGEN_BUF_LEN 256        // amostras no buffer de DMA (duas metades)
+#define SIGGEN_MIN_PERIOD_LEN 8   // amostras mínimas por período
+#define SIGGEN_MAX_RATE_HZ 1000000 // taxa máxima de atualização do DAC
+#define SIGGEN_CHIRP_RATE_HZ 200000 // taxa de atualização do chirp
+#define SIGGEN_MAX_CODE 4095      // DAC de 12 bits
+
+enum siggen_wave
+{
+    SIGGEN_OFF,
+    SIGGEN_DC,
+    SIGGEN_SINE,
+    SIGGEN_SQUARE,
+    SIGGEN_RAMP,
+    SIGGEN_CHIRP,
+};
+
+struct siggen_config
+{
+    enum siggen_wave wave;
+    uint32_t freq_hz;     // frequência (inicial, no chirp)
+    uint32_t freq_end_hz; // frequência final do chirp
+    uint32_t sweep_ms;    // duração de uma varredura do chirp
+    uint16_t amplitude;   // pico, em códigos do DAC
+    uint16_t offset;      // nível médio (ou o nível em SIGGEN_DC)
+};
+
+/* Liga o gerador com 'cfg'. Retorna -EINVAL para parâmetros fora dos
+ * limites e -ENOTSUP se não houver backend (DAC com DMA ou emulador). */
+int siggen_start(const struct siggen_config *cfg);
+
+void siggen_stop(void);
+
+/* Troca a saída para o nível 'code' e retorna k_cycle_get_32() do momento
+ * da escrita, usado como referência de latência. */
+uint32_t siggen_step(uint16_t code);
+
+/* Configuração em uso (wave == SIGGEN_OFF se desligado). */
+struct siggen_config siggen_current(void);
+
+/* Valor do gerador no instante 'cycles' (k_cycle_get_32()). Usado pelo
+ * emulador do ADC no native_sim. */
+uint16_t siggen_emul_code(uint32_t cycles);
+
+#endif /* SIGGEN_H_ */
@@ -0,0 +1,276 @@
+#include "spectrum.h"
+#include "block_bus.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPECTRUM_STACK_SIZE 1024
+#define SPECTRUM_PRIORITY 11 // abaixo da telemetria; só usa tempo ocioso
+
+/* Blocos recebidos do barramento; cada um tem uma referência da análise. */
+BLOCK_SUBSCRIBER_DEFINE(spectrum_sub, ACQ_MAX_LENT);
+K_MUTEX_DEFINE(spectrum_lock);
+
+static atomic_t restart;   // nova configuração: descarta o quadro em montagem
+static uint32_t gaps;      // quadros descartados por bloco faltando
+
+static volatile uint8_t requested_channel;
+static volatile uint16_t requested_size = SPECTRUM_DEFAULT_SIZE;
+
+static int32_t frame[FFT_MAX_SIZE];
+static uint32_t work_mag[FFT_MAX_SIZE / 2 + 1];
+static struct spectrum_result result; // protegido por spectrum_lock
+
+/* Energia dos bins de 'center' - 2 a 'center' + 2 (lóbulo principal da Hann). */
+static uint64_t lobe_power(const uint32_t *mag, uint16_t center, uint16_t last)
+{
+    uint64_t power = 0U;
+
+    for (uint16_t k = MAX(center, 3U) - 2U; k <= MIN(center + 2U, last); k++)
+    {
+        power += (uint64_t)mag[k] * mag[k];
+    }
+
+    return power;
+}
+
+static void analyze(uint8_t channel, uint16_t size, uint32_t interval_us)
+{
+    uint32_t start = k_cycle_get_32();
+    const uint16_t last = size / 2U;
+    int64_t sum = 0;
+
+    for (uint16_t i = 0U; i < size; i++)
+    {
+        sum += frame[i];
+    }
+
+    const int32_t mean = (int32_t)(sum / size);
+
+    for (uint16_t i = 0U; i < size; i++)
+    {
+        frame[i] = (int32_t)(((int64_t)(frame[i] - mean) * fft_hann_q15(i, size)) >> 15);
+    }
+
+    fft_real_magnitude(frame, size, work_mag);
+
+    uint16_t peak = 1U;
+    for (uint16_t k = 2U; k < last; k++)
+    {
+        if (work_mag[k] > work_mag[peak])
+        {
+            peak = k;
+        }
+    }
+
+    /* Interpolação parabólica da posição do pico, em milésimos de bin. */
+    int64_t left = work_mag[peak - 1U];
+    int64_t center = work_mag[peak];
+    int64_t right = work_mag[peak + 1U];
+    int64_t den = 2 * center - left - right;
+    int64_t bin_milli = (int64_t)peak * 1000 + (den > 0 ? (500 * (right - left)) / den : 0);
+
+    uint64_t harmonics = 0U;
+    for (uint16_t h = 2U; h <= SPECTRUM_HARMONICS && (uint32_t)peak * h + 2U <= last; h++)
+    {
+        harmonics += lobe_power(work_mag, peak * h, last);
+    }
+    uint32_t fundamental = fft_isqrt64(lobe_power(work_mag, peak, last));
+
+    k_mutex_lock(&spectrum_lock, K_FOREVER);
+    result.frames++;
+    result.size = size;
+    result.channel = channel;
+    result.interval_us = interval_us;
+    result.peak_bin = peak;
+    result.peak_mhz = (uint64_t)MAX(bin_milli, 0) * 1000000U / ((uint64_t)interval_us * size);
+    result.peak_amplitude = work_mag[peak] * 4U / size;
+    result.thd_bp = fundamental > 0U ?
+                    (uint32_t)((uint64_t)fft_isqrt64(harmonics) * 10000U / fundamental) : 0U;
+    memcpy(result.mag, work_mag, (last + 1U) * sizeof(work_mag[0]));
+    result.exec_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    k_mutex_unlock(&spectrum_lock);
+}
+
+static void spectrum_task(void *arg1, void *arg2, void *arg3)
+{
+    uint16_t fill = 0U;
+    uint16_t size = SPECTRUM_DEFAULT_SIZE;
+    uint8_t channel = 0U;
+    uint32_t expected_seq = 0U;
+    uint32_t interval_us = 0U;
+
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    (void)block_bus_subscribe(&spectrum_sub);
+
+    while (1)
+    {
+        struct acq_block *block;
+
+        (void)block_bus_get(&spectrum_sub, &block, K_FOREVER);
+
+        if (atomic_cas(&restart, 1, 0))
+        {
+            size = requested_size;
+            channel = requested_channel;
+            fill = 0U;
+        }
+
+        /* Um quadro precisa de blocos consecutivos com o mesmo período. */
+        if (fill > 0U && (block->seq != expected_seq || block->interval_us != interval_us))
+        {
+            gaps++;
+            fill = 0U;
+        }
+        expected_seq = block->seq + 1U;
+        interval_us = block->interval_us;
+
+        for (size_t n = 0U; n < ACQ_BLOCK_LEN && fill < size; n++)
+        {
+            frame[fill++] = acq_sample(block, n, channel);
+        }
+
+        acq_release_block(block);
+
+        if (fill == size)
+        {
+            analyze(channel, size, interval_us);
+            fill = 0U;
+        }
+    }
+}
+
+K_THREAD_DEFINE(spectrum_tid, SPECTRUM_STACK_SIZE, spectrum_task, NULL, NULL, NULL,
+                SPECTRUM_PRIORITY, 0, 0);
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_spectrum_start(const struct shell *shell, size_t argc, char **argv)
+{
+    int channel = argc > 1 ? atoi(argv[1]) : 0;
+    int size = argc > 2 ? atoi(argv[2]) : SPECTRUM_DEFAULT_SIZE;
+
+    if (channel < 0 || channel >= ACQ_NUM_CHANNELS)
+    {
+        shell_print(shell, "Canal inválido. Digite um valor entre 0 e %d", ACQ_NUM_CHANNELS - 1);
+        return -EINVAL;
+    }
+
+    if (size > UINT16_MAX || !fft_size_valid((uint16_t)size))
+    {
+        shell_print(shell, "Tamanho inválido. Use potência de 2 entre %d e %d.",
+                    FFT_MIN_SIZE, FFT_MAX_SIZE);
+        return -EINVAL;
+    }
+
+    requested_channel = (uint8_t)channel;
+    requested_size = (uint16_t)size;
+    atomic_set(&restart, 1);
+
+    k_mutex_lock(&spectrum_lock, K_FOREVER);
+    result.frames = 0U;
+    k_mutex_unlock(&spectrum_lock);
+
+    block_bus_set_active(&spectrum_sub, true);
+    shell_print(shell, "Análise espectral do canal %d com FFT de %d pontos.", channel, size);
+    return 0;
+}
+
+static int cmd_spectrum_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    block_bus_set_active(&spectrum_sub, false);
+    return 0;
+}
+
+static int cmd_spectrum_show(const struct shell *shell, size_t argc, char **argv)
+{
+    struct spectrum_result r;
+
+    /* Copia só o resumo; os bins ficam para 'spectrum bins'. */
+    k_mutex_lock(&spectrum_lock, K_FOREVER);
+    memcpy(&r, &result, offsetof(struct spectrum_result, mag));
+    k_mutex_unlock(&spectrum_lock);
+
+    shell_print(shell, "Análise espectral: %s",
+                atomic_get(&spectrum_sub.active) ? "ligada" : "desligada");
+    shell_print(shell, "Blocos perdidos: %u, quadros interrompidos: %u",
+                (uint32_t)atomic_get(&spectrum_sub.dropped), gaps);
+
+    if (r.frames == 0U)
+    {
+        shell_print(shell, "Nenhum espectro calculado ainda.");
+        return 0;
+    }
+
+    uint32_t fs_mhz = 1000000000U / r.interval_us;
+    uint32_t res_mhz = fs_mhz / r.size;
+
+    shell_print(shell, "Canal %u, FFT de %u pontos, %u espectros, última em %u us",
+                r.channel, r.size, r.frames, r.exec_us);
+    shell_print(shell, "Amostragem: %u.%03u Hz, resolução: %u.%03u Hz",
+                fs_mhz / 1000U, fs_mhz % 1000U, res_mhz / 1000U, res_mhz % 1000U);
+    shell_print(shell, "Pico: %u.%03u Hz (bin %u), amplitude %u",
+                (uint32_t)(r.peak_mhz / 1000U), (uint32_t)(r.peak_mhz % 1000U),
+                r.peak_bin, r.peak_amplitude);
+    shell_print(shell, "THD (até a %da harmônica): %u.%02u%%", SPECTRUM_HARMONICS,
+                r.thd_bp / 100U, r.thd_bp % 100U);
+
+    return 0;
+}
+
+static int cmd_spectrum_bins(const struct shell *shell, size_t argc, char **argv)
+{
+    static uint32_t mag[FFT_MAX_SIZE / 2 + 1];
+    uint16_t size;
+    uint32_t interval_us;
+
+    k_mutex_lock(&spectrum_lock, K_FOREVER);
+    size = result.size;
+    interval_us = result.interval_us;
+    if (result.frames > 0U)
+    {
+        memcpy(mag, result.mag, (size / 2U + 1U) * sizeof(mag[0]));
+    }
+    k_mutex_unlock(&spectrum_lock);
+
+    if (size == 0U)
+    {
+        shell_print(shell, "Nenhum espectro calculado ainda.");
+        return 0;
+    }
+
+    int first = argc > 1 ? atoi(argv[1]) : 0;
+    int last = argc > 2 ? atoi(argv[2]) : size / 2;
+
+    first = CLAMP(first, 0, size / 2);
+    last = CLAMP(last, first, size / 2);
+
+    shell_print(shell, " bin |  freq (Hz)  | amplitude");
+    for (int k = first; k <= last; k++)
+    {
+        uint64_t mhz = (uint64_t)k * 1000000000U / ((uint64_t)interval_us * size);
+
+        shell_print(shell, "%4d | %7u.%03u | %u", k, (uint32_t)(mhz / 1000U),
+                    (uint32_t)(mhz % 1000U), mag[k] * 4U / size);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_spectrum,
+    SHELL_CMD_ARG(start, NULL, "Liga a análise: start [canal] [pontos]", cmd_spectrum_start, 1, 2),
+    SHELL_CMD(stop, NULL, "Desliga a análise", cmd_spectrum_stop),
+    SHELL_CMD(show, NULL, "Pico, amplitude e THD do último espectro", cmd_spectrum_show),
+    SHELL_CMD_ARG(bins, NULL, "Amplitude por bin: bins [primeiro] [último]", cmd_spectrum_bins, 1, 2),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(spectrum, &sub_spectrum, "Análise espectral (FFT) de um canal do ADC",
+                   cmd_spectrum_show);
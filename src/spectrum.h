@@ -0,0 +1,34 @@
+/*
+ * Estágio de análise espectral de um canal do ADC.
+ *
+ * A análise é um assinante do barramento de blocos (block_bus.h): uma
+ * thread de baixa prioridade lê as amostras direto do buffer de aquisição,
+ * aplica a janela de Hann, calcula a FFT real em ponto fixo e publica o
+ * pico, os módulos por bin e a THD. Se a análise estiver atrasada os blocos
+ * excedentes são descartados, então o caminho ADC->DAC nunca espera por ela.
+ */
+
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+#include "acquisition.h"
+#include "fft.h"
+
+#define SPECTRUM_DEFAULT_SIZE 256
+#define SPECTRUM_HARMONICS 5 // harmônicas somadas na THD (2a até 5a)
+
+struct spectrum_result
+{
+    uint32_t frames;       // espectros calculados desde o start
+    uint16_t size;         // pontos da FFT
+    uint8_t channel;
+    uint32_t interval_us;  // período de amostragem do quadro
+    uint16_t peak_bin;
+    uint64_t peak_mhz;     // frequência do pico interpolada, em mHz
+    uint32_t peak_amplitude; // amplitude do pico em contagens do ADC
+    uint32_t thd_bp;       // THD em centésimos de por cento
+    uint32_t exec_us;      // tempo da última análise
+    uint32_t mag[FFT_MAX_SIZE / 2 + 1];
+};
+
+#endif /* SPECTRUM_H_ */
@@ -0,0 +1,249 @@
+#include "telemetry.h"
+#include "block_bus.h"
+#include "pipeline.h"
+#include "trace.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(telemetry, LOG_LEVEL_INF);
+
+#define ZEPHYR_USER_NODE DT_PATH(zephyr_user)
+#define HAS_TELEMETRY_UART DT_NODE_HAS_PROP(ZEPHYR_USER_NODE, telemetry_uart)
+
+#define TELEMETRY_STACK_SIZE 1024
+#define TELEMETRY_PRIORITY 10 // abaixo das tarefas de tempo real e do LED
+#define TELEMETRY_HEADER_SIZE 22
+#define TELEMETRY_FRAME_MAX (TELEMETRY_HEADER_SIZE + 4 * ACQ_BLOCK_LEN + 2)
+#define TELEMETRY_TX_TIMEOUT K_MSEC(100)
+
+BUILD_ASSERT(ACQ_BLOCK_LEN <= UINT8_MAX);
+
+#if HAS_TELEMETRY_UART
+BLOCK_SUBSCRIBER_DEFINE(telemetry_sub, ACQ_MAX_LENT);
+#endif
+
+static atomic_t streaming;
+static atomic_t dropped;     // quadros não enviados (host ausente ou UART lenta)
+static uint32_t bus_dropped_base; // descartes do barramento antes do start
+static uint32_t frames_sent;
+static uint32_t bytes_sent;
+static uint32_t frame_seq;
+
+#if HAS_TELEMETRY_UART
+static const struct device *const telemetry_uart =
+    DEVICE_DT_GET(DT_PHANDLE(ZEPHYR_USER_NODE, telemetry_uart));
+
+static uint8_t frame_buf[TELEMETRY_FRAME_MAX];
+static volatile size_t tx_pos;
+static volatile size_t tx_len;
+K_SEM_DEFINE(tx_done, 0, 1);
+#endif /* HAS_TELEMETRY_UART */
+
+/* Descartes vistos pelo host: quadros não enviados, blocos perdidos na fila
+ * da telemetria e blocos não publicados desde o start. */
+static uint32_t total_dropped(void)
+{
+    uint32_t count = (uint32_t)atomic_get(&dropped);
+
+#if HAS_TELEMETRY_UART
+    count += (uint32_t)atomic_get(&telemetry_sub.dropped) + block_bus_dropped() - bus_dropped_base;
+#endif
+
+    return count;
+}
+
+bool telemetry_is_streaming(void)
+{
+    return atomic_get(&streaming) != 0;
+}
+
+#if HAS_TELEMETRY_UART
+/* Interrupção da UART: envia o quadro em frame_buf aos pedaços. */
+static void telemetry_uart_isr(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    while (uart_irq_update(dev) && uart_irq_tx_ready(dev))
+    {
+        if (tx_pos >= tx_len)
+        {
+            uart_irq_tx_disable(dev);
+            trace_sem_give(&tx_done);
+            break;
+        }
+
+        int sent = uart_fifo_fill(dev, &frame_buf[tx_pos], tx_len - tx_pos);
+
+        if (sent <= 0)
+        {
+            break;
+        }
+        tx_pos += sent;
+    }
+}
+
+/* Instante do bloco em us desde o boot, em 64 bits. O contador de ciclos
+ * de 32 bits dá a volta em ~25 s a 168 MHz; o tempo de atividade em ticks
+ * (64 bits, mesma origem) dá os bits altos, e os ciclos do bloco, a
+ * precisão. Vale enquanto o bloco tiver menos de meia volta de idade. */
+static uint64_t block_time_us(const struct acq_block *block)
+{
+    const uint64_t now_cyc = k_ticks_to_cyc_floor64(k_uptime_ticks());
+    const int32_t delta = (int32_t)(block->timestamp - (uint32_t)now_cyc);
+
+    return k_cyc_to_us_floor64(now_cyc + delta);
+}
+
+/* Monta o quadro de um canal lendo as amostras direto do bloco publicado. */
+static size_t build_frame(const struct acq_block *block, size_t channel)
+{
+    uint8_t *p = frame_buf;
+    const uint8_t n_out = block->n_out[channel];
+
+    *p++ = 0xA5;
+    *p++ = 0x5A;
+    *p++ = TELEMETRY_FRAME_VERSION;
+    *p++ = (uint8_t)channel;
+    sys_put_le32(frame_seq++, p);
+    p += 4;
+    sys_put_le64(block_time_us(block), p);
+    p += 8;
+    sys_put_le32(total_dropped(), p);
+    p += 4;
+    *p++ = ACQ_BLOCK_LEN;
+    *p++ = n_out;
+    for (size_t n = 0U; n < ACQ_BLOCK_LEN; n++, p += 2)
+    {
+        sys_put_le16((uint16_t)acq_sample(block, n, channel), p);
+    }
+    for (size_t n = 0U; n < n_out; n++, p += 2)
+    {
+        sys_put_le16((uint16_t)(int16_t)CLAMP(block->out[channel][n], INT16_MIN, INT16_MAX), p);
+    }
+
+    uint16_t crc = crc16_itu_t(0xFFFF, &frame_buf[2], p - &frame_buf[2]);
+
+    sys_put_le16(crc, p);
+    p += 2;
+
+    return p - frame_buf;
+}
+
+static bool host_connected(void)
+{
+    uint32_t dtr = 0U;
+
+    (void)uart_line_ctrl_get(telemetry_uart, UART_LINE_CTRL_DTR, &dtr);
+
+    return dtr != 0U;
+}
+
+static void telemetry_task(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    if (!device_is_ready(telemetry_uart))
+    {
+        LOG_ERR("Telemetry UART %s not ready", telemetry_uart->name);
+        return;
+    }
+
+    uart_irq_callback_user_data_set(telemetry_uart, telemetry_uart_isr, NULL);
+    (void)block_bus_subscribe(&telemetry_sub);
+
+    while (1)
+    {
+        struct acq_block *block;
+
+        (void)block_bus_get(&telemetry_sub, &block, K_FOREVER);
+
+        for (size_t channel = 0U; channel < ACQ_NUM_CHANNELS; channel++)
+        {
+            if (pipelines[channel].sink != PIPELINE_SINK_TELEMETRY)
+            {
+                continue;
+            }
+
+            if (!host_connected())
+            {
+                atomic_inc(&dropped);
+                continue;
+            }
+
+            tx_len = build_frame(block, channel);
+            tx_pos = 0U;
+            k_sem_reset(&tx_done);
+            uart_irq_tx_enable(telemetry_uart);
+
+            if (k_sem_take(&tx_done, TELEMETRY_TX_TIMEOUT) != 0)
+            {
+                uart_irq_tx_disable(telemetry_uart);
+                atomic_inc(&dropped);
+                continue;
+            }
+
+            frames_sent++;
+            bytes_sent += tx_len;
+        }
+
+        acq_release_block(block);
+    }
+}
+
+K_THREAD_DEFINE(telemetry_tid, TELEMETRY_STACK_SIZE, telemetry_task, NULL, NULL, NULL,
+                TELEMETRY_PRIORITY, 0, 0);
+#endif /* HAS_TELEMETRY_UART */
+
+/* --- COMANDOS DO SHELL --- */
+
+static int cmd_telemetry_start(const struct shell *shell, size_t argc, char **argv)
+{
+#if !HAS_TELEMETRY_UART
+    shell_print(shell, "Sem UART de telemetria (telemetry-uart em zephyr,user).");
+    return -ENODEV;
+#endif
+
+    bus_dropped_base = block_bus_dropped();
+    atomic_set(&streaming, 1);
+#if HAS_TELEMETRY_UART
+    block_bus_set_active(&telemetry_sub, true);
+#endif
+    shell_print(shell, "Telemetria ligada para canais com saída 'telemetry' (pipeline sink).");
+    return 0;
+}
+
+static int cmd_telemetry_stop(const struct shell *shell, size_t argc, char **argv)
+{
+#if HAS_TELEMETRY_UART
+    block_bus_set_active(&telemetry_sub, false);
+#endif
+    atomic_set(&streaming, 0);
+    return 0;
+}
+
+static int cmd_telemetry_status(const struct shell *shell, size_t argc, char **argv)
+{
+    shell_print(shell, "Telemetria: %s", telemetry_is_streaming() ? "ligada" : "desligada");
+    shell_print(shell, "Quadros enviados: %u (%u bytes)", frames_sent, bytes_sent);
+    shell_print(shell, "Blocos ou quadros descartados: %u", total_dropped());
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_telemetry,
+    SHELL_CMD(start, NULL, "Liga o stream binário", cmd_telemetry_start),
+    SHELL_CMD(stop, NULL, "Desliga o stream binário", cmd_telemetry_stop),
+    SHELL_CMD(status, NULL, "Quadros enviados e descartados", cmd_telemetry_status),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(telemetry, &sub_telemetry, "Stream binário de amostras pelo USB", cmd_telemetry_status);
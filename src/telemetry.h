@@ -0,0 +1,35 @@
+/*
+ * Stream binário de telemetria pela porta USB CDC ACM.
+ *
+ * A telemetria é um assinante do barramento de blocos (block_bus.h): uma
+ * thread de baixa prioridade recebe cada bloco publicado pela tarefa de
+ * tempo real e, para cada canal com saída 'telemetry', envia as amostras
+ * brutas e filtradas lidas direto do bloco, sem cópia intermediária. Se a
+ * fila do assinante estiver cheia o bloco é descartado e contado. Quadro:
+ *
+ *   off  tam  campo
+ *   0    2    sincronismo 0xA5 0x5A
+ *   2    1    versão (TELEMETRY_FRAME_VERSION)
+ *   3    1    canal (índice em io-channels)
+ *   4    4    número de sequência do quadro
+ *   8    8    instante do bloco em us desde o boot (monotônico)
+ *   16   4    blocos ou quadros descartados desde o start
+ *   20   1    n_raw, amostras brutas
+ *   21   1    n_out, amostras filtradas
+ *   22   2*n_raw  amostras brutas (int16), sem a correção de calib.h
+ *   ..   2*n_out  amostras filtradas (int16)
+ *   ..   2    CRC-16/CCITT-FALSE dos bytes 2 até o fim do payload
+ *
+ * Todos os campos são little-endian. scripts/telemetry_rx.py decodifica o stream.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TELEMETRY_FRAME_VERSION 2 // 2: instante em 64 bits
+bool telemetry_is_streaming(void);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,125 @@
+#include "thread_info.h"
+
+#include <zephyr/kernel_structs.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+static uint32_t max_lock_cycles;
+
+/* Executado com o lock de k_thread_foreach preso: apenas cópias de tamanho fixo. */
+static void snapshot_callback(const struct k_thread *thread, void *user_data)
+{
+    struct thread_info_snapshot *snap = user_data;
+    k_tid_t tid = (k_tid_t)thread;
+
+    if (snap->count >= THREAD_INFO_MAX)
+    {
+        snap->truncated = true;
+        return;
+    }
+
+    struct thread_info *info = &snap->threads[snap->count++];
+    const char *name = k_thread_name_get(tid);
+    k_thread_runtime_stats_t stats;
+
+    info->tid = tid;
+    strncpy(info->name, name != NULL ? name : "", sizeof(info->name) - 1);
+    info->name[sizeof(info->name) - 1] = '\0';
+    info->state = thread->base.thread_state;
+    info->running = tid == k_current_get();
+    info->priority = thread->base.prio;
+
+    if (k_thread_runtime_stats_get(tid, &stats) == 0)
+    {
+        info->cycles = stats.execution_cycles;
+    }
+}
+
+void thread_info_snapshot(struct thread_info_snapshot *snap, bool with_stack)
+{
+    memset(snap, 0, sizeof(*snap));
+
+    uint32_t start = k_cycle_get_32();
+    k_thread_foreach(snapshot_callback, snap);
+    snap->lock_cycles = k_cycle_get_32() - start;
+
+    max_lock_cycles = MAX(max_lock_cycles, snap->lock_cycles);
+
+    if (!with_stack)
+    {
+        return;
+    }
+
+    /* A varredura da pilha percorre a região inteira, por isso é feita
+     * fora do lock. As threads da aplicação são estáticas e não terminam. */
+    for (uint8_t i = 0; i < snap->count; i++)
+    {
+        struct thread_info *info = &snap->threads[i];
+
+#ifdef CONFIG_THREAD_STACK_INFO
+        info->stack_size = info->tid->stack_info.size;
+#endif
+#ifdef CONFIG_INIT_STACKS
+        if (k_thread_stack_space_get(info->tid, &info->stack_unused) != 0)
+        {
+            info->stack_unused = 0;
+        }
+#endif
+    }
+}
+
+const struct thread_info *thread_info_find(const struct thread_info_snapshot *snap,
+                                           const char *name)
+{
+    for (uint8_t i = 0; i < snap->count; i++)
+    {
+        if (strcmp(snap->threads[i].name, name) == 0)
+        {
+            return &snap->threads[i];
+        }
+    }
+
+    return NULL;
+}
+
+const char *thread_info_state_str(const struct thread_info *info, char *buf, size_t size)
+{
+    static const struct
+    {
+        uint8_t bit;
+        const char *name;
+    } names[] = {
+        {_THREAD_DUMMY, "dummy"},       {_THREAD_PENDING, "pending"},
+        {_THREAD_SLEEPING, "sleeping"}, {_THREAD_DEAD, "dead"},
+        {_THREAD_SUSPENDED, "suspended"}, {_THREAD_ABORTING, "aborting"},
+        {_THREAD_QUEUED, "queued"},
+    };
+    size_t len = 0;
+
+    buf[0] = '\0';
+
+    if (info->running)
+    {
+        return strncpy(buf, "running", size);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        if ((info->state & names[i].bit) != 0U && len < size)
+        {
+            len += snprintk(buf + len, size - len, "%s%s", len > 0 ? "+" : "", names[i].name);
+        }
+    }
+
+    if (len == 0)
+    {
+        strncpy(buf, "ready", size);
+    }
+
+    return buf;
+}
+
+uint32_t thread_info_max_lock_cycles(void)
+{
+    return max_lock_cycles;
+}
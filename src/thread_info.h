@@ -0,0 +1,53 @@
+/*
+ * Introspecção de threads sem segurar o escalonador durante a impressão.
+ *
+ * thread_info_snapshot() copia, sob o lock de k_thread_foreach(), apenas os
+ * campos compactos de cada thread (nome, estado, prioridade, ciclos). O
+ * cálculo da pilha livre e toda a formatação acontecem depois, fora do lock.
+ * O tempo em que o lock ficou preso é medido a cada captura.
+ */
+
+#ifndef THREAD_INFO_H_
+#define THREAD_INFO_H_
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+#define THREAD_INFO_MAX 16
+#define THREAD_INFO_NAME_LEN 16
+
+struct thread_info
+{
+    k_tid_t tid;
+    char name[THREAD_INFO_NAME_LEN];
+    uint8_t state; // cópia de thread->base.thread_state
+    bool running;  // era a thread corrente no momento da captura
+    int8_t priority;
+    uint64_t cycles;
+    size_t stack_size;
+    size_t stack_unused; // pilha nunca usada (high-water mark = size - unused)
+};
+
+struct thread_info_snapshot
+{
+    uint8_t count;
+    bool truncated; // havia mais de THREAD_INFO_MAX threads
+    uint32_t lock_cycles; // duração do k_thread_foreach desta captura
+    struct thread_info threads[THREAD_INFO_MAX];
+};
+
+/* Captura todas as threads. Com 'with_stack', também varre as pilhas (fora
+ * do lock) para obter o pico de uso. Seguro apenas em contexto de thread. */
+void thread_info_snapshot(struct thread_info_snapshot *snap, bool with_stack);
+
+/* Procura uma thread pelo nome em uma captura. */
+const struct thread_info *thread_info_find(const struct thread_info_snapshot *snap,
+                                           const char *name);
+
+/* Formata o estado de uma thread capturada. */
+const char *thread_info_state_str(const struct thread_info *info, char *buf, size_t size);
+
+/* Maior tempo de lock observado em uma captura, em ciclos. */
+uint32_t thread_info_max_lock_cycles(void);
+
+#endif /* THREAD_INFO_H_ */
@@ -0,0 +1,276 @@
+#include "trace.h"
+#include "thread_info.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/base64.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#ifdef CONFIG_CPU_CORTEX_M
+#include <cmsis_core.h>
+#endif
+
+#define TRACE_LEN CONFIG_APP_TRACE_RING_LEN
+#define TRACE_MASK (TRACE_LEN - 1U)
+#define TRACE_RECORD_SIZE 8
+#define TRACE_DUMP_CHUNK 96 // registros por linha do dump (1024 caracteres base64)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(TRACE_LEN), "CONFIG_APP_TRACE_RING_LEN must be a power of 2");
+
+struct trace_record
+{
+    uint32_t cycles;
+    uint8_t event;
+    uint8_t aux;
+    uint16_t id;
+};
+
+enum trace_mode
+{
+    TRACE_MODE_RING,
+    TRACE_MODE_ONCE,
+    TRACE_MODE_MISS,
+};
+
+static const char *const mode_names[] = {"ring", "once", "miss"};
+
+static const char *const mark_names[TRACE_MARK_COUNT] = {
+    [TRACE_MARK_BLOCK_START] = "block_start",
+    [TRACE_MARK_PIPELINE_DONE] = "pipeline_done",
+    [TRACE_MARK_PUBLISHED] = "published",
+    [TRACE_MARK_BLOCK_END] = "block_end",
+    [TRACE_MARK_DEADLINE_MISS] = "deadline_miss",
+};
+
+static struct trace_record ring[TRACE_LEN];
+static atomic_t head;    // registros reservados desde o início
+static atomic_t enabled;
+static atomic_t triggered; // congelado por prazo perdido (modo 'miss')
+static enum trace_mode mode;
+
+/* Tag de 16 bits de um objeto do kernel; o dump traz a tabela das threads. */
+static inline uint16_t obj_tag(const void *obj)
+{
+    return (uint16_t)((uintptr_t)obj >> 2);
+}
+
+static inline uint16_t current_exception(void)
+{
+#ifdef CONFIG_CPU_CORTEX_M
+    return (uint16_t)__get_IPSR(); // IRQ n é a exceção n + 16
+#else
+    return 0U;
+#endif
+}
+
+static inline void record(uint8_t event, uint16_t id, uint8_t aux)
+{
+    if (!atomic_get(&enabled))
+    {
+        return;
+    }
+
+    const uint32_t now = k_cycle_get_32();
+    const uint32_t idx = (uint32_t)atomic_inc(&head);
+
+    if (mode == TRACE_MODE_ONCE && idx >= TRACE_LEN)
+    {
+        atomic_clear(&enabled);
+        return;
+    }
+
+    struct trace_record *rec = &ring[idx & TRACE_MASK];
+
+    rec->cycles = now;
+    rec->event = event;
+    rec->aux = aux;
+    rec->id = id;
+}
+
+/* --- GANCHOS DE CONFIG_TRACING_USER (irqs bloqueadas pelo kernel) --- */
+
+void sys_trace_thread_switched_in_user(void)
+{
+    record(TRACE_SWITCH_IN, obj_tag(k_current_get()), 0U);
+}
+
+void sys_trace_thread_switched_out_user(void)
+{
+    record(TRACE_SWITCH_OUT, obj_tag(k_current_get()), 0U);
+}
+
+void sys_trace_thread_sched_ready_user(struct k_thread *thread)
+{
+    record(TRACE_READY, obj_tag(thread), 0U);
+}
+
+void sys_trace_thread_pend_user(struct k_thread *thread)
+{
+    record(TRACE_PEND, obj_tag(thread), 0U);
+}
+
+void sys_trace_isr_enter_user(int nested_interrupts)
+{
+    record(TRACE_ISR_ENTER, current_exception(), (uint8_t)nested_interrupts);
+}
+
+void sys_trace_isr_exit_user(int nested_interrupts)
+{
+    record(TRACE_ISR_EXIT, current_exception(), (uint8_t)nested_interrupts);
+}
+
+/* --- MARCAS DA APLICAÇÃO --- */
+
+void trace_mark(enum trace_mark mark, uint8_t arg)
+{
+    record(TRACE_MARK, (uint16_t)mark, arg);
+
+    if (mark == TRACE_MARK_DEADLINE_MISS && mode == TRACE_MODE_MISS &&
+        atomic_cas(&enabled, 1, 0))
+    {
+        atomic_set(&triggered, 1);
+    }
+}
+
+void trace_sem_give(struct k_sem *sem)
+{
+    record(TRACE_SEM_GIVE, obj_tag(sem), k_is_in_isr() ? 1U : 0U);
+    k_sem_give(sem);
+}
+
+/* --- COMANDOS DO SHELL --- */
+
+static uint32_t recorded(void)
+{
+    return MIN((uint32_t)atomic_get(&head), TRACE_LEN);
+}
+
+static uint32_t lost(void)
+{
+    uint32_t total = (uint32_t)atomic_get(&head);
+
+    return total > TRACE_LEN ? total - TRACE_LEN : 0U;
+}
+
+static int cmd_trace_start(const struct shell *shell, size_t argc, char **argv)
+{
+    enum trace_mode new_mode = TRACE_MODE_RING;
+
+    if (argc > 1)
+    {
+        size_t i;
+
+        for (i = 0U; i < ARRAY_SIZE(mode_names); i++)
+        {
+            if (strcmp(argv[1], mode_names[i]) == 0)
+            {
+                break;
+            }
+        }
+        if (i == ARRAY_SIZE(mode_names))
+        {
+            shell_print(shell, "Modo inválido. Use: ring, once ou miss");
+            return -EINVAL;
+        }
+        new_mode = (enum trace_mode)i;
+    }
+
+    atomic_clear(&enabled);
+    mode = new_mode;
+    atomic_clear(&head);
+    atomic_clear(&triggered);
+    atomic_set(&enabled, 1);
+
+    shell_print(shell, "Trace iniciado (modo %s, %d registros).", mode_names[mode], TRACE_LEN);
+    return 0;
+}
+
+static int cmd_trace_stop(const struct shell *shell, size_t argc, char **argv)
+{
+    atomic_clear(&enabled);
+    shell_print(shell, "Trace parado: %u registros, %u perdidos.", recorded(), lost());
+    return 0;
+}
+
+static int cmd_trace_status(const struct shell *shell, size_t argc, char **argv)
+{
+    const char *state = atomic_get(&enabled) ? "gravando" :
+                        atomic_get(&triggered) ? "congelado (prazo perdido)" : "parado";
+
+    shell_print(shell, "Trace: %s, modo %s", state, mode_names[mode]);
+    shell_print(shell, "Registros: %u de %d (%d bytes cada), perdidos: %u", recorded(),
+                TRACE_LEN, TRACE_RECORD_SIZE, lost());
+    return 0;
+}
+
+static int cmd_trace_dump(const struct shell *shell, size_t argc, char **argv)
+{
+    static struct thread_info_snapshot threads;
+    static uint8_t chunk[TRACE_DUMP_CHUNK * TRACE_RECORD_SIZE];
+    static uint8_t line[sizeof(chunk) / 3U * 4U + 1U];
+    uint16_t crc = 0xFFFF;
+
+    if (atomic_get(&enabled))
+    {
+        shell_print(shell, "Pare o trace antes do dump ('trace stop').");
+        return -EBUSY;
+    }
+
+    /* Um gravador interrompido entre a reserva e a escrita termina antes. */
+    k_sleep(K_MSEC(1));
+
+    const uint32_t count = recorded();
+    const uint32_t first = mode == TRACE_MODE_ONCE ? 0U : (uint32_t)atomic_get(&head) - count;
+
+    thread_info_snapshot(&threads, false);
+
+    shell_print(shell, "trace: begin registros=%u perdidos=%u ciclos_hz=%u modo=%s", count,
+                lost(), sys_clock_hw_cycles_per_sec(), mode_names[mode]);
+    for (uint8_t i = 0U; i < threads.count; i++)
+    {
+        shell_print(shell, "trace: thread %04x %s", obj_tag(threads.threads[i].tid),
+                    threads.threads[i].name);
+    }
+    for (size_t i = 0U; i < TRACE_MARK_COUNT; i++)
+    {
+        shell_print(shell, "trace: mark %u %s", (uint32_t)i, mark_names[i]);
+    }
+
+    for (uint32_t done = 0U; done < count;)
+    {
+        uint32_t n = MIN(count - done, TRACE_DUMP_CHUNK);
+        size_t olen;
+
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            const struct trace_record *rec = &ring[(first + done + i) & TRACE_MASK];
+            uint8_t *out = &chunk[TRACE_RECORD_SIZE * i];
+
+            sys_put_le32(rec->cycles, out);
+            out[4] = rec->event;
+            out[5] = rec->aux;
+            sys_put_le16(rec->id, &out[6]);
+        }
+
+        crc = crc16_itu_t(crc, chunk, TRACE_RECORD_SIZE * n);
+        (void)base64_encode(line, sizeof(line), &olen, chunk, TRACE_RECORD_SIZE * n);
+        shell_print(shell, "%s", (char *)line);
+        done += n;
+    }
+
+    shell_print(shell, "trace: end crc=%04x", crc);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_trace,
+    SHELL_CMD_ARG(start, NULL, "Inicia: start [ring|once|miss]", cmd_trace_start, 1, 1),
+    SHELL_CMD(stop, NULL, "Para a gravação", cmd_trace_stop),
+    SHELL_CMD(status, NULL, "Estado e ocupação do anel", cmd_trace_status),
+    SHELL_CMD(dump, NULL, "Envia o anel em base64 (scripts/trace_rx.py)", cmd_trace_dump),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(trace, &sub_trace, "Trace do escalonador em RAM", cmd_trace_status);
@@ -0,0 +1,81 @@
+/*
+ * Trace do escalonador em um anel na RAM.
+ *
+ * Os ganchos de CONFIG_TRACING_USER gravam trocas de contexto, threads
+ * que ficam prontas ou bloqueiam e entrada/saída de interrupções. Os
+ * módulos da aplicação acrescentam marcas de estágio do pipeline
+ * (trace_mark()) e as liberações de semáforo (trace_sem_give()). Cada
+ * registro tem 8 bytes: k_cycle_get_32(), tipo, um byte auxiliar e um id
+ * de 16 bits (tag da thread ou do semáforo, número da IRQ ou da marca).
+ *
+ * A gravação reserva a posição com um atomic_inc() e escreve o registro,
+ * sem lock. Com o trace parado cada gancho custa uma leitura e um desvio,
+ * então o módulo pode ficar compilado nos builds de produção.
+ *
+ * Modos: 'ring' sobrescreve os registros mais antigos até 'trace stop';
+ * 'once' para quando o anel enche; 'miss' roda como 'ring' e congela no
+ * primeiro prazo perdido da filter_task, guardando o que rodou antes.
+ * 'trace dump' envia o anel em base64:
+ *
+ *   trace: begin registros=<n> perdidos=<p> ciclos_hz=<f> modo=<m>
+ *   trace: thread <tag> <nome>      (uma linha por thread)
+ *   trace: mark <id> <nome>         (uma linha por marca)
+ *   <linhas base64 com os registros, 8 bytes little-endian cada>
+ *   trace: end crc=<CRC-16/CCITT-FALSE dos bytes, em hexa>
+ *
+ * scripts/trace_rx.py transforma o dump numa linha do tempo e no tempo de
+ * execução e latência (pronta -> rodando) de cada thread.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+enum trace_event
+{
+    TRACE_SWITCH_IN = 1, // id: thread que passa a rodar
+    TRACE_SWITCH_OUT,    // id: thread que deixa a CPU
+    TRACE_READY,         // id: thread que ficou pronta
+    TRACE_PEND,          // id: thread que bloqueou
+    TRACE_ISR_ENTER,     // id: IRQ, aux: aninhamento
+    TRACE_ISR_EXIT,
+    TRACE_SEM_GIVE,      // id: tag do semáforo, aux: 1 se em ISR
+    TRACE_MARK,          // id: enum trace_mark, aux: argumento da marca
+};
+
+enum trace_mark
+{
+    TRACE_MARK_BLOCK_START,   // filter_task começou um bloco (aux: seq)
+    TRACE_MARK_PIPELINE_DONE, // pipelines processados
+    TRACE_MARK_PUBLISHED,     // bloco publicado no barramento
+    TRACE_MARK_BLOCK_END,     // fim do job
+    TRACE_MARK_DEADLINE_MISS, // prazo perdido (congela no modo 'miss')
+    TRACE_MARK_COUNT,
+};
+
+#ifdef CONFIG_APP_TRACE
+
+/* Marca de estágio da aplicação. Pode ser chamada de ISR. */
+void trace_mark(enum trace_mark mark, uint8_t arg);
+
+/* k_sem_give() com registro no trace. */
+void trace_sem_give(struct k_sem *sem);
+
+#else
+
+static inline void trace_mark(enum trace_mark mark, uint8_t arg)
+{
+    ARG_UNUSED(mark);
+    ARG_UNUSED(arg);
+}
+
+static inline void trace_sem_give(struct k_sem *sem)
+{
+    k_sem_give(sem);
+}
+
+#endif /* CONFIG_APP_TRACE */
+
+#endif /* TRACE_H_ */
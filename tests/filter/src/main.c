@@ -0,0 +1,287 @@
+/*
+ * Testes do motor de filtros (filter.h): a média móvel contra a soma
+ * refeita a cada amostra, respostas ao impulso e ao degrau do FIR e do
+ * biquad, e a troca de bancos de coeficientes.
+ */
+
+#include <zephyr/ztest.h>
+#include <errno.h>
+#include <string.h>
+
+#include "filter.h"
+
+#define TEST_LEN 200
+#define TEST_AMPLITUDE 1000
+
+static struct filter_chain chain;
+
+/* Arredondamento do filtro em float (metade para longe do zero), sem libm. */
+static int32_t round_ref(double value)
+{
+    return (int32_t)(value >= 0.0 ? value + 0.5 : value - 0.5);
+}
+
+/* Entrada pseudoaleatória reprodutível em [-2048, 2047]. */
+static void fill_noise(int32_t *buf, size_t n)
+{
+    uint32_t state = 12345U;
+
+    for (size_t i = 0U; i < n; i++)
+    {
+        state = state * 1103515245U + 12345U;
+        buf[i] = (int32_t)((state >> 16) & 0xFFFU) - 2048;
+    }
+}
+
+static void fill_impulse(int32_t *buf, size_t n)
+{
+    memset(buf, 0, n * sizeof(buf[0]));
+    buf[0] = TEST_AMPLITUDE;
+}
+
+static void fill_step(int32_t *buf, size_t n)
+{
+    for (size_t i = 0U; i < n; i++)
+    {
+        buf[i] = TEST_AMPLITUDE;
+    }
+}
+
+/* Filtra 'n' amostras em blocos de tamanhos variados, como a tarefa de
+ * tempo real com decimação. */
+static void process_in_blocks(int32_t *buf, size_t n)
+{
+    static const size_t sizes[] = {1, 32, 7, 13};
+    size_t done = 0U;
+
+    for (size_t k = 0U; done < n; k++)
+    {
+        size_t len = MIN(sizes[k % ARRAY_SIZE(sizes)], n - done);
+
+        filter_chain_process(&chain, &buf[done], len);
+        done += len;
+    }
+}
+
+static void config_fir(struct filter_config *cfg, const float *coeffs, uint16_t taps)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_stages = 1;
+    cfg->stages[0].type = FILTER_STAGE_FIR;
+    cfg->stages[0].len = taps;
+    memcpy(cfg->stages[0].coeffs, coeffs, taps * sizeof(coeffs[0]));
+}
+
+static void config_biquad(struct filter_config *cfg, const float *coeffs, uint16_t sections)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_stages = 1;
+    cfg->stages[0].type = FILTER_STAGE_BIQUAD;
+    cfg->stages[0].len = sections;
+    memcpy(cfg->stages[0].coeffs, coeffs,
+           sections * FILTER_BIQUAD_COEFFS * sizeof(coeffs[0]));
+}
+
+ZTEST(filter, test_mavg_matches_resum)
+{
+    static const uint16_t windows[] = {1, 2, 7, 30, FILTER_MAX_TAPS};
+    int32_t in[TEST_LEN];
+    int32_t out[TEST_LEN];
+    struct filter_config cfg;
+
+    fill_noise(in, ARRAY_SIZE(in));
+
+    for (size_t w = 0U; w < ARRAY_SIZE(windows); w++)
+    {
+        const int32_t len = windows[w];
+
+        filter_config_mavg(&cfg, windows[w]);
+        zassert_ok(filter_chain_init(&chain, &cfg));
+        memcpy(out, in, sizeof(out));
+        process_in_blocks(out, ARRAY_SIZE(out));
+
+        /* Soma refeita sobre a janela, com zeros antes da primeira amostra. */
+        for (int32_t n = 0; n < TEST_LEN; n++)
+        {
+            int32_t sum = 0;
+
+            for (int32_t k = MAX(n - len + 1, 0); k <= n; k++)
+            {
+                sum += in[k];
+            }
+            zassert_equal(out[n], sum / len, "janela %d, amostra %d: %d != %d", len, n,
+                          out[n], sum / len);
+        }
+    }
+}
+
+ZTEST(filter, test_fir_impulse_and_step)
+{
+    static const float coeffs[] = {0.5f, 0.25f, -0.125f, 1.0f, 0.0625f};
+    const uint16_t taps = ARRAY_SIZE(coeffs);
+    int32_t buf[TEST_LEN];
+    struct filter_config cfg;
+    float acc = 0.0f;
+
+    config_fir(&cfg, coeffs, taps);
+
+    /* Impulso: a saída são os próprios coeficientes, depois zero. */
+    zassert_ok(filter_chain_init(&chain, &cfg));
+    fill_impulse(buf, ARRAY_SIZE(buf));
+    process_in_blocks(buf, ARRAY_SIZE(buf));
+    for (size_t n = 0U; n < ARRAY_SIZE(buf); n++)
+    {
+        int32_t expected = n < taps ? round_ref(TEST_AMPLITUDE * coeffs[n]) : 0;
+
+        zassert_equal(buf[n], expected, "impulso, amostra %d: %d != %d", (int)n, buf[n],
+                      expected);
+    }
+
+    /* Degrau: a soma acumulada dos coeficientes, estável depois de 'taps'. */
+    zassert_ok(filter_chain_init(&chain, &cfg));
+    fill_step(buf, ARRAY_SIZE(buf));
+    process_in_blocks(buf, ARRAY_SIZE(buf));
+    for (size_t n = 0U; n < ARRAY_SIZE(buf); n++)
+    {
+        if (n < taps)
+        {
+            acc += coeffs[n];
+        }
+
+        int32_t expected = round_ref(TEST_AMPLITUDE * acc);
+
+        zassert_equal(buf[n], expected, "degrau, amostra %d: %d != %d", (int)n, buf[n],
+                      expected);
+    }
+}
+
+/* Referência em double na forma direta I, seção por seção. */
+static void biquad_reference(const float *coeffs, uint16_t sections, const int32_t *in,
+                             double *out, size_t n)
+{
+    double x1[FILTER_MAX_BIQUADS] = {0};
+    double x2[FILTER_MAX_BIQUADS] = {0};
+    double y1[FILTER_MAX_BIQUADS] = {0};
+    double y2[FILTER_MAX_BIQUADS] = {0};
+
+    for (size_t i = 0U; i < n; i++)
+    {
+        double x = in[i];
+
+        for (uint16_t s = 0U; s < sections; s++)
+        {
+            const float *c = &coeffs[s * FILTER_BIQUAD_COEFFS];
+            double y = c[0] * x + c[1] * x1[s] + c[2] * x2[s] - c[3] * y1[s] - c[4] * y2[s];
+
+            x2[s] = x1[s];
+            x1[s] = x;
+            y2[s] = y1[s];
+            y1[s] = y;
+            x = y;
+        }
+        out[i] = x;
+    }
+}
+
+ZTEST(filter, test_biquad_impulse_and_step)
+{
+    /* Passa-baixas de segunda ordem (ganho DC 1) seguido de um polo simples
+     * (ganho DC 1): b0, b1, b2, a1, a2. */
+    static const float coeffs[] = {
+        0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f,
+        0.5f,    0.0f,    0.0f,    -0.5f,    0.0f,
+    };
+    const uint16_t sections = ARRAY_SIZE(coeffs) / FILTER_BIQUAD_COEFFS;
+    int32_t in[TEST_LEN];
+    int32_t buf[TEST_LEN];
+    double ref[TEST_LEN];
+    struct filter_config cfg;
+
+    config_biquad(&cfg, coeffs, sections);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 0)
+        {
+            fill_impulse(in, ARRAY_SIZE(in));
+        }
+        else
+        {
+            fill_step(in, ARRAY_SIZE(in));
+        }
+
+        zassert_ok(filter_chain_init(&chain, &cfg));
+        memcpy(buf, in, sizeof(buf));
+        process_in_blocks(buf, ARRAY_SIZE(buf));
+        biquad_reference(coeffs, sections, in, ref, ARRAY_SIZE(in));
+
+        /* Float contra double: até uma unidade de arredondamento. */
+        for (size_t n = 0U; n < ARRAY_SIZE(buf); n++)
+        {
+            zassert_within(buf[n], round_ref(ref[n]), 1, "%s, amostra %d: %d, ref %f",
+                           pass == 0 ? "impulso" : "degrau", (int)n, buf[n], ref[n]);
+        }
+    }
+
+    /* O degrau acomoda no ganho DC das duas seções. */
+    zassert_within(buf[TEST_LEN - 1], TEST_AMPLITUDE, 2);
+}
+
+ZTEST(filter, test_bank_swap_only_at_sync)
+{
+    static const float half[] = {0.5f};
+    struct filter_config identity;
+    struct filter_config halved;
+    int32_t buf[4] = {10, 20, 30, 40};
+
+    filter_config_mavg(&identity, 1);
+    config_fir(&halved, half, ARRAY_SIZE(half));
+    zassert_ok(filter_chain_init(&chain, &identity));
+
+    zassert_ok(filter_chain_load(&chain, &halved));
+
+    /* Carregada mas não sincronizada: o banco ativo continua o antigo. */
+    zassert_equal(filter_chain_config(&chain)->stages[0].type, FILTER_STAGE_MAVG);
+    filter_chain_process(&chain, buf, ARRAY_SIZE(buf));
+    zassert_equal(buf[0], 10);
+    zassert_equal(buf[3], 40);
+
+    zassert_true(filter_chain_sync(&chain));
+    zassert_equal(filter_chain_config(&chain)->stages[0].type, FILTER_STAGE_FIR);
+    filter_chain_process(&chain, buf, ARRAY_SIZE(buf));
+    zassert_equal(buf[0], 5);
+    zassert_equal(buf[3], 20);
+
+    /* Sem nada pendente a sincronização não troca de novo. */
+    zassert_false(filter_chain_sync(&chain));
+    zassert_equal(filter_chain_config(&chain)->stages[0].type, FILTER_STAGE_FIR);
+}
+
+ZTEST(filter, test_load_busy_while_pending)
+{
+    struct filter_config cfg;
+    struct filter_config invalid;
+
+    filter_config_mavg(&cfg, 4);
+    zassert_ok(filter_chain_init(&chain, &cfg));
+
+    filter_config_mavg(&cfg, 8);
+    zassert_ok(filter_chain_load(&chain, &cfg));
+
+    /* A segunda carga não pode sobrescrever o banco que a sync vai ativar. */
+    filter_config_mavg(&cfg, 16);
+    zassert_equal(filter_chain_load(&chain, &cfg), -EBUSY);
+
+    zassert_true(filter_chain_sync(&chain));
+    zassert_equal(filter_chain_config(&chain)->stages[0].len, 8);
+    zassert_ok(filter_chain_load(&chain, &cfg));
+
+    /* Configuração inválida é recusada antes do teste de pendência. */
+    filter_config_mavg(&invalid, FILTER_MAX_TAPS + 1);
+    zassert_equal(filter_chain_load(&chain, &invalid), -EINVAL);
+
+    zassert_true(filter_chain_sync(&chain));
+    zassert_equal(filter_chain_config(&chain)->stages[0].len, 16);
+}
+
+ZTEST_SUITE(filter, NULL, NULL, NULL, NULL, NULL);